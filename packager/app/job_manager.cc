@@ -6,7 +6,10 @@
 
 #include "packager/app/job_manager.h"
 
+#include <algorithm>
+
 #include "packager/app/libcrypto_threading.h"
+#include "packager/base/logging.h"
 #include "packager/media/chunking/sync_point_queue.h"
 #include "packager/media/origin/origin_handler.h"
 
@@ -14,7 +17,7 @@ namespace shaka {
 namespace media {
 
 Job::Job(const std::string& name, std::shared_ptr<OriginHandler> work)
-    : SimpleThread(name),
+    : name_(name),
       work_(std::move(work)),
       wait_(base::WaitableEvent::ResetPolicy::MANUAL,
             base::WaitableEvent::InitialState::NOT_SIGNALED) {
@@ -22,23 +25,47 @@ Job::Job(const std::string& name, std::shared_ptr<OriginHandler> work)
 }
 
 void Job::Cancel() {
+  cancelled_ = true;
   work_->Cancel();
 }
 
 void Job::Run() {
-  status_ = work_->Run();
+  if (cancelled_)
+    status_ = Status(error::CANCELLED, name_ + " is cancelled.");
+  else
+    status_ = work_->Run();
   wait_.Signal();
 }
 
-JobManager::JobManager(std::unique_ptr<SyncPointQueue> sync_points)
-    : sync_points_(std::move(sync_points)) {}
+JobManager::JobManager(std::unique_ptr<SyncPointQueue> sync_points,
+                       size_t max_parallel_jobs)
+    : max_parallel_jobs_(max_parallel_jobs),
+      range_completed_(&lock_),
+      sync_points_(std::move(sync_points)) {}
+
+JobManager::~JobManager() {
+  DCHECK(workers_.empty());
+}
 
 void JobManager::Add(const std::string& name,
                      std::shared_ptr<OriginHandler> handler) {
   // Stores Job entries for delayed construction of Job objects, to avoid
   // setting up SimpleThread until we know all workers can be initialized
   // successfully.
-  job_entries_.push_back({name, std::move(handler)});
+  job_entries_.push_back({name, std::move(handler), nullptr, 0});
+}
+
+void JobManager::AddRanges(
+    const std::string& name,
+    const std::vector<std::shared_ptr<OriginHandler>>& handlers,
+    size_t max_ranges_in_flight) {
+  DCHECK_GT(max_ranges_in_flight, 0u);
+  range_groups_.emplace_back(new RangeGroup);
+  RangeGroup* range_group = range_groups_.back().get();
+  range_group->max_ranges_in_flight = max_ranges_in_flight;
+  range_group->completed.resize(handlers.size(), false);
+  for (size_t i = 0; i < handlers.size(); ++i)
+    job_entries_.push_back({name, handlers[i], range_group, i});
 }
 
 Status JobManager::InitializeJobs() {
@@ -63,15 +90,25 @@ Status JobManager::RunJobs() {
   std::vector<Job*> active_jobs;
   std::vector<base::WaitableEvent*> active_waits;
 
-  // Start every job and add it to the active jobs list so that we can wait
+  // Queue every job and add it to the active jobs list so that we can wait
   // on each one.
-  for (auto& job : jobs_) {
-    job->Start();
+  for (size_t i = 0; i < jobs_.size(); ++i) {
+    Job* job = jobs_[i].get();
+    queued_jobs_.push_back(
+        {job, job_entries_[i].range_group, job_entries_[i].range_index});
 
-    active_jobs.push_back(job.get());
+    active_jobs.push_back(job);
     active_waits.push_back(job->wait());
   }
 
+  const size_t num_workers = GetNumWorkerThreads();
+  VLOG(1) << "Running " << jobs_.size() << " jobs on " << num_workers
+          << " worker threads.";
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(new base::DelegateSimpleThread(this, "JobWorker"));
+    workers_.back()->Start();
+  }
+
   // Wait for all jobs to complete or an error occurs.
   Status status;
   while (status.ok() && active_jobs.size()) {
@@ -81,7 +118,6 @@ Status JobManager::RunJobs() {
         base::WaitableEvent::WaitMany(active_waits.data(), active_waits.size());
     Job* job = active_jobs[done];
 
-    job->Join();
     status.Update(job->status());
 
     // Remove the job and the wait from our tracking.
@@ -91,15 +127,13 @@ Status JobManager::RunJobs() {
 
   // If the main loop has exited and there are still jobs running,
   // we need to cancel them and clean-up.
-  if (sync_points_)
-    sync_points_->Cancel();
-  for (auto& job : active_jobs) {
-    job->Cancel();
-  }
+  if (!active_jobs.empty())
+    CancelJobs();
 
-  for (auto& job : active_jobs) {
-    job->Join();
-  }
+  // Cancelled jobs that are still queued complete without running.
+  for (auto& worker : workers_)
+    worker->Join();
+  workers_.clear();
 
   return status;
 }
@@ -107,10 +141,71 @@ Status JobManager::RunJobs() {
 void JobManager::CancelJobs() {
   if (sync_points_)
     sync_points_->Cancel();
+  // Cancel the queued jobs first, so that they do not start on the worker
+  // threads of the running jobs being cancelled.
+  {
+    base::AutoLock auto_lock(lock_);
+    for (const QueuedJob& queued_job : queued_jobs_)
+      queued_job.job->Cancel();
+  }
   for (auto& job : jobs_) {
     job->Cancel();
   }
 }
 
+void JobManager::Run() {
+  base::AutoLock auto_lock(lock_);
+  while (!queued_jobs_.empty()) {
+    auto iter =
+        std::find_if(queued_jobs_.begin(), queued_jobs_.end(), &CanStart);
+    if (iter == queued_jobs_.end()) {
+      // The queued jobs are ranges waiting for the running ranges to complete.
+      range_completed_.Wait();
+      continue;
+    }
+    const QueuedJob queued_job = *iter;
+    queued_jobs_.erase(iter);
+    {
+      base::AutoUnlock auto_unlock(lock_);
+      queued_job.job->Run();
+    }
+
+    RangeGroup* range_group = queued_job.range_group;
+    if (range_group) {
+      range_group->completed[queued_job.range_index] = true;
+      while (range_group->num_leading_completed <
+                 range_group->completed.size() &&
+             range_group->completed[range_group->num_leading_completed]) {
+        ++range_group->num_leading_completed;
+      }
+      range_completed_.Broadcast();
+    }
+  }
+}
+
+bool JobManager::CanStart(const QueuedJob& queued_job) {
+  const RangeGroup* range_group = queued_job.range_group;
+  return !range_group ||
+         queued_job.range_index < range_group->num_leading_completed +
+                                      range_group->max_ranges_in_flight;
+}
+
+size_t JobManager::GetNumWorkerThreads() const {
+  // Jobs wait for each other to align the cue points, so they all have to run
+  // in parallel.
+  if (sync_points_)
+    return jobs_.size();
+  // Only |max_ranges_in_flight| ranges of a range group run at a time.
+  size_t num_jobs = jobs_.size();
+  for (const auto& range_group : range_groups_) {
+    num_jobs -= range_group->completed.size();
+    num_jobs += std::min(range_group->completed.size(),
+                         range_group->max_ranges_in_flight);
+  }
+  if (max_parallel_jobs_ == 0)
+    return num_jobs;
+  return std::min(num_jobs, max_parallel_jobs_);
+}
+
 }  // namespace media
 }  // namespace shaka
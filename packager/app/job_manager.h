@@ -7,9 +7,14 @@
 #ifndef PACKAGER_APP_JOB_MANAGER_H_
 #define PACKAGER_APP_JOB_MANAGER_H_
 
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <vector>
 
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+#include "packager/base/synchronization/waitable_event.h"
 #include "packager/base/threading/simple_thread.h"
 #include "packager/status.h"
 
@@ -20,11 +25,15 @@ class OriginHandler;
 class SyncPointQueue;
 
 // A job is a single line of work that is expected to run in parallel with
-// other jobs.
-class Job : public base::SimpleThread {
+// other jobs. Jobs are run by the worker threads of JobManager.
+class Job {
  public:
   Job(const std::string& name, std::shared_ptr<OriginHandler> work);
 
+  // Run the job on the calling thread. The job is not run if it has been
+  // cancelled already.
+  void Run();
+
   // Request that the job stops executing. This is only a request and
   // will not block. If you want to wait for the job to complete, use
   // |wait|.
@@ -38,13 +47,15 @@ class Job : public base::SimpleThread {
   // WaitableEvent you can wait on.
   base::WaitableEvent* wait() { return &wait_; }
 
+  const std::string& name() const { return name_; }
+
  private:
   Job(const Job&) = delete;
   Job& operator=(const Job&) = delete;
 
-  void Run() override;
-
+  std::string name_;
   std::shared_ptr<OriginHandler> work_;
+  std::atomic<bool> cancelled_{false};
   Status status_;
 
   base::WaitableEvent wait_;
@@ -52,19 +63,35 @@ class Job : public base::SimpleThread {
 
 // Similar to a thread pool, JobManager manages multiple jobs that are expected
 // to run in parallel. It can be used to register, run, and stop a batch of
-// jobs.
-class JobManager {
+// jobs. By default, every job runs on its own worker thread. The number of
+// worker threads can be limited, in which case the remaining jobs are queued
+// and run in the order they were added as the running jobs complete. The jobs
+// processing the ranges of an input are also limited to a window of ranges.
+class JobManager : public base::DelegateSimpleThread::Delegate {
  public:
   // @param sync_points is an optional SyncPointQueue used to synchronize and
   //        align cue points. JobManager cancels @a sync_points when any job
   //        fails or is cancelled. It can be NULL.
-  explicit JobManager(std::unique_ptr<SyncPointQueue> sync_points);
+  // @param max_parallel_jobs is the maximum number of jobs to run at once. 0
+  //        runs every job at once. It is ignored if @a sync_points is not
+  //        NULL, as the jobs then wait for each other to align the cue points.
+  JobManager(std::unique_ptr<SyncPointQueue> sync_points,
+             size_t max_parallel_jobs);
+  ~JobManager() override;
 
   // Create a new job entry by specifying the origin handler at the top of the
   // chain and a name for the thread. This will only register the job. To start
   // the job, you need to call |RunJobs|.
   void Add(const std::string& name, std::shared_ptr<OriginHandler> handler);
 
+  // Create new job entries for the consecutive ranges of an input, in order.
+  // A range is only started once the ranges at least |max_ranges_in_flight|
+  // before it have completed, so that at most |max_ranges_in_flight| ranges
+  // of the input are running or waiting for the preceding ranges at a time.
+  void AddRanges(const std::string& name,
+                 const std::vector<std::shared_ptr<OriginHandler>>& handlers,
+                 size_t max_ranges_in_flight);
+
   // Initialize all registered jobs. If any job fails to initialize, this will
   // return the error and it will not be safe to call |RunJobs| as not all jobs
   // will be properly initialized.
@@ -85,13 +112,51 @@ class JobManager {
   JobManager(const JobManager&) = delete;
   JobManager& operator=(const JobManager&) = delete;
 
+  // base::DelegateSimpleThread::Delegate implementation. Runs the queued jobs
+  // on a worker thread until there are none left.
+  void Run() override;
+
+  // @return The number of worker threads to run the jobs on.
+  size_t GetNumWorkerThreads() const;
+
+  // The jobs added with |AddRanges|.
+  struct RangeGroup {
+    size_t max_ranges_in_flight = 0;
+    // Whether each range has completed.
+    std::vector<bool> completed;
+    // The number of leading ranges that have completed.
+    size_t num_leading_completed = 0;
+  };
   struct JobEntry {
     std::string name;
     std::shared_ptr<OriginHandler> worker;
+    // Set if the job processes the range at |range_index| of |range_group|.
+    RangeGroup* range_group;
+    size_t range_index;
   };
+  struct QueuedJob {
+    Job* job;
+    RangeGroup* range_group;
+    size_t range_index;
+  };
+
+  // @return true if |queued_job| can start without exceeding the window of its
+  //         range group.
+  static bool CanStart(const QueuedJob& queued_job);
   // Stores Job entries for delayed construction of Job object.
   std::vector<JobEntry> job_entries_;
+  std::vector<std::unique_ptr<RangeGroup>> range_groups_;
   std::vector<std::unique_ptr<Job>> jobs_;
+  std::vector<std::unique_ptr<base::DelegateSimpleThread>> workers_;
+
+  const size_t max_parallel_jobs_;
+
+  base::Lock lock_;
+  // The jobs waiting for a worker thread, or for preceding ranges to complete.
+  std::deque<QueuedJob> queued_jobs_;
+  // Signaled when a range completes.
+  base::ConditionVariable range_completed_;
+
   // Stored in JobManager so JobManager can cancel |sync_points| when any job
   // fails or is cancelled.
   std::unique_ptr<SyncPointQueue> sync_points_;
@@ -0,0 +1,254 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/app/job_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "packager/base/synchronization/waitable_event.h"
+#include "packager/base/time/time.h"
+#include "packager/media/chunking/sync_point_queue.h"
+#include "packager/media/origin/origin_handler.h"
+#include "packager/media/public/ad_cue_generator_params.h"
+#include "packager/status_test_util.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kUnlimited = 0;
+// Long enough for a job that should not start to have started otherwise.
+const int64_t kNotStartedWaitMs = 50;
+
+// An origin handler that runs until it is released or cancelled, and that
+// counts the handlers running at once.
+class FakeOriginHandler : public OriginHandler {
+ public:
+  FakeOriginHandler(const Status& status, std::atomic<int>* num_running,
+                    std::atomic<int>* max_running)
+      : status_(status),
+        num_running_(num_running),
+        max_running_(max_running),
+        started_(base::WaitableEvent::ResetPolicy::MANUAL,
+                 base::WaitableEvent::InitialState::NOT_SIGNALED),
+        released_(base::WaitableEvent::ResetPolicy::MANUAL,
+                  base::WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  Status Run() override {
+    const int num_running = ++*num_running_;
+    int max_running = *max_running_;
+    while (num_running > max_running &&
+           !max_running_->compare_exchange_weak(max_running, num_running)) {
+    }
+    started_.Signal();
+    released_.Wait();
+    --*num_running_;
+    return cancelled_ ? Status(error::CANCELLED, "Cancelled.") : status_;
+  }
+
+  void Cancel() override {
+    cancelled_ = true;
+    released_.Signal();
+  }
+
+  void Release() { released_.Signal(); }
+
+  void WaitForStart() { started_.Wait(); }
+  bool HasStarted() { return started_.IsSignaled(); }
+  bool StartsWithinWait() {
+    return started_.TimedWait(
+        base::TimeDelta::FromMilliseconds(kNotStartedWaitMs));
+  }
+
+ private:
+  Status InitializeInternal() override { return Status::OK; }
+
+  const Status status_;
+  std::atomic<int>* const num_running_;
+  std::atomic<int>* const max_running_;
+  std::atomic<bool> cancelled_{false};
+  base::WaitableEvent started_;
+  base::WaitableEvent released_;
+};
+
+}  // namespace
+
+class JobManagerTest : public ::testing::Test {
+ protected:
+  void SetUpJobs(size_t max_parallel_jobs,
+                 const std::vector<Status>& statuses,
+                 std::unique_ptr<SyncPointQueue> sync_points = nullptr) {
+    job_manager_.reset(
+        new JobManager(std::move(sync_points), max_parallel_jobs));
+    for (const Status& status : statuses)
+      job_manager_->Add("FakeJob", AddHandler(status));
+    ASSERT_OK(job_manager_->InitializeJobs());
+  }
+
+  void SetUpRanges(size_t max_ranges_in_flight, size_t num_ranges) {
+    job_manager_.reset(new JobManager(nullptr, kUnlimited));
+    std::vector<std::shared_ptr<OriginHandler>> ranges;
+    for (size_t i = 0; i < num_ranges; ++i)
+      ranges.push_back(AddHandler(Status::OK));
+    job_manager_->AddRanges("FakeRangeJob", ranges, max_ranges_in_flight);
+    ASSERT_OK(job_manager_->InitializeJobs());
+  }
+
+  void StartRunningJobs() {
+    run_thread_ = std::thread([this]() { status_ = job_manager_->RunJobs(); });
+  }
+
+  Status WaitForJobs() {
+    run_thread_.join();
+    return status_;
+  }
+
+  FakeOriginHandler* Handler(size_t index) { return handlers_[index].get(); }
+
+  std::shared_ptr<FakeOriginHandler> AddHandler(const Status& status) {
+    handlers_.push_back(std::make_shared<FakeOriginHandler>(
+        status, &num_running_, &max_running_));
+    return handlers_.back();
+  }
+
+  std::atomic<int> num_running_{0};
+  std::atomic<int> max_running_{0};
+  std::unique_ptr<JobManager> job_manager_;
+  std::vector<std::shared_ptr<FakeOriginHandler>> handlers_;
+
+ private:
+  std::thread run_thread_;
+  Status status_;
+};
+
+TEST_F(JobManagerTest, RunsEveryJobInParallelIfUnlimited) {
+  SetUpJobs(kUnlimited, std::vector<Status>(4, Status::OK));
+  StartRunningJobs();
+
+  // Every job starts before any of them completes.
+  for (auto& handler : handlers_)
+    handler->WaitForStart();
+  for (auto& handler : handlers_)
+    handler->Release();
+
+  ASSERT_OK(WaitForJobs());
+  EXPECT_EQ(4, max_running_);
+}
+
+TEST_F(JobManagerTest, LimitsParallelJobs) {
+  SetUpJobs(2, std::vector<Status>(4, Status::OK));
+  StartRunningJobs();
+
+  Handler(0)->WaitForStart();
+  Handler(1)->WaitForStart();
+  EXPECT_FALSE(Handler(2)->StartsWithinWait());
+  EXPECT_FALSE(Handler(3)->HasStarted());
+
+  // The queued jobs start in order as the running jobs complete.
+  Handler(1)->Release();
+  Handler(2)->WaitForStart();
+  EXPECT_FALSE(Handler(3)->StartsWithinWait());
+  Handler(0)->Release();
+  Handler(3)->WaitForStart();
+  Handler(2)->Release();
+  Handler(3)->Release();
+
+  ASSERT_OK(WaitForJobs());
+  EXPECT_EQ(2, max_running_);
+}
+
+TEST_F(JobManagerTest, IgnoresLimitWithSyncPoints) {
+  SetUpJobs(1, std::vector<Status>(3, Status::OK),
+            std::unique_ptr<SyncPointQueue>(
+                new SyncPointQueue(AdCueGeneratorParams())));
+  StartRunningJobs();
+
+  // The jobs wait for each other to align the cue points, so they all run.
+  for (auto& handler : handlers_)
+    handler->WaitForStart();
+  for (auto& handler : handlers_)
+    handler->Release();
+
+  ASSERT_OK(WaitForJobs());
+  EXPECT_EQ(3, max_running_);
+}
+
+TEST_F(JobManagerTest, CancelJobsCancelsQueuedJobs) {
+  SetUpJobs(1, std::vector<Status>(3, Status::OK));
+  StartRunningJobs();
+
+  Handler(0)->WaitForStart();
+  job_manager_->CancelJobs();
+
+  EXPECT_EQ(error::CANCELLED, WaitForJobs().error_code());
+  // The queued jobs complete without running.
+  EXPECT_FALSE(Handler(1)->HasStarted());
+  EXPECT_FALSE(Handler(2)->HasStarted());
+  EXPECT_EQ(1, max_running_);
+}
+
+TEST_F(JobManagerTest, QueuedJobErrorStopsOtherJobs) {
+  const Status kError(error::PARSER_FAILURE, "Queued job failed.");
+  SetUpJobs(2, {Status::OK, Status::OK, kError, Status::OK});
+  StartRunningJobs();
+
+  Handler(0)->WaitForStart();
+  Handler(1)->WaitForStart();
+  // Job 2 starts once job 1 completes, and fails.
+  Handler(1)->Release();
+  Handler(2)->WaitForStart();
+  Handler(2)->Release();
+
+  // The error is returned without waiting for job 0 to be released, which is
+  // cancelled, as is job 3, whether it started or not.
+  EXPECT_EQ(kError, WaitForJobs());
+  EXPECT_EQ(0, num_running_);
+}
+
+TEST_F(JobManagerTest, LimitsRangesInFlight) {
+  SetUpRanges(2, 5);
+  StartRunningJobs();
+
+  Handler(0)->WaitForStart();
+  Handler(1)->WaitForStart();
+  EXPECT_FALSE(Handler(2)->StartsWithinWait());
+
+  // Range 2 waits for range 0, even if range 1 has completed.
+  Handler(1)->Release();
+  EXPECT_FALSE(Handler(2)->StartsWithinWait());
+  Handler(0)->Release();
+  Handler(2)->WaitForStart();
+  Handler(3)->WaitForStart();
+  EXPECT_FALSE(Handler(4)->StartsWithinWait());
+
+  Handler(2)->Release();
+  Handler(4)->WaitForStart();
+  Handler(3)->Release();
+  Handler(4)->Release();
+
+  ASSERT_OK(WaitForJobs());
+  EXPECT_EQ(2, max_running_);
+}
+
+TEST_F(JobManagerTest, CancelJobsCancelsWaitingRanges) {
+  SetUpRanges(1, 3);
+  StartRunningJobs();
+
+  Handler(0)->WaitForStart();
+  job_manager_->CancelJobs();
+
+  EXPECT_EQ(error::CANCELLED, WaitForJobs().error_code());
+  EXPECT_FALSE(Handler(1)->HasStarted());
+  EXPECT_FALSE(Handler(2)->HasStarted());
+}
+
+}  // namespace media
+}  // namespace shaka
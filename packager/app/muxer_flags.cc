@@ -46,6 +46,32 @@ DEFINE_string(temp_dir,
 DEFINE_bool(mp4_include_pssh_in_stream,
             true,
             "MP4 only: include pssh in the encrypted stream.");
+DEFINE_int32(pipeline_queue_size,
+             0,
+             "If positive, each output stream is muxed on its own thread, "
+             "separate from demuxing, chunking and encryption, with at most "
+             "this number of stream data queued in between. Improves "
+             "throughput of high bitrate streams and of inputs with multiple "
+             "outputs on multi-core machines.");
+DEFINE_double(vod_range_duration,
+              0,
+              "If positive, audio and video streams of local non-fragmented "
+              "MP4 inputs are split into ranges of about this duration in "
+              "seconds, at segment boundaries, which are demuxed, chunked and "
+              "encrypted in parallel before being muxed in order. The output "
+              "is the same as without ranges. At most as many ranges of an "
+              "input as there are processors are run at a time, and those "
+              "waiting for the preceding ones are held in memory. "
+              "Not supported with ad cues, key rotation, 'cbc1' or 16-byte "
+              "'cenc' / 'cens' ivs, in which case the inputs are not split.");
+DEFINE_int32(max_parallel_jobs,
+             0,
+             "Maximum number of jobs, i.e. inputs or input ranges being "
+             "packaged, to run in parallel. The other jobs wait until a "
+             "running job completes. Specify 0 to run every job in parallel. "
+             "Live inputs never complete, so this should not be less than the "
+             "number of live inputs. Ignored if ad cues are specified, as the "
+             "jobs then wait for each other to align the cue points.");
 DEFINE_int32(transport_stream_timestamp_offset_ms,
              100,
              "A positive value, in milliseconds, by which output timestamps "
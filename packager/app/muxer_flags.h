@@ -19,6 +19,9 @@ DECLARE_bool(fragment_sap_aligned);
 DECLARE_bool(generate_sidx_in_media_segments);
 DECLARE_string(temp_dir);
 DECLARE_bool(mp4_include_pssh_in_stream);
+DECLARE_int32(pipeline_queue_size);
+DECLARE_double(vod_range_duration);
+DECLARE_int32(max_parallel_jobs);
 DECLARE_int32(transport_stream_timestamp_offset_ms);
 
 #endif  // APP_MUXER_FLAGS_H_
@@ -311,6 +311,21 @@ base::Optional<PackagingParams> GetPackagingParams() {
   PackagingParams packaging_params;
 
   packaging_params.temp_dir = FLAGS_temp_dir;
+  if (FLAGS_pipeline_queue_size < 0) {
+    LOG(ERROR) << "--pipeline_queue_size should not be negative.";
+    return base::nullopt;
+  }
+  packaging_params.pipeline_queue_size = FLAGS_pipeline_queue_size;
+  if (FLAGS_vod_range_duration < 0) {
+    LOG(ERROR) << "--vod_range_duration should not be negative.";
+    return base::nullopt;
+  }
+  packaging_params.vod_range_duration_in_seconds = FLAGS_vod_range_duration;
+  if (FLAGS_max_parallel_jobs < 0) {
+    LOG(ERROR) << "--max_parallel_jobs should not be negative.";
+    return base::nullopt;
+  }
+  packaging_params.max_parallel_jobs = FLAGS_max_parallel_jobs;
 
   AdCueGeneratorParams& ad_cue_generator_params =
       packaging_params.ad_cue_generator_params;
@@ -702,6 +702,13 @@ class PackagerFunctionalTest(PackagerAppTest):
         self._GetStreams(['audio', 'video']), self._GetFlags(output_dash=True))
     self._CheckTestResults('audio-video')
 
+  def testAudioVideoWithVodRanges(self):
+    # The ranges are packaged in parallel, with the same output.
+    self.assertPackageSuccess(
+        self._GetStreams(['audio', 'video']),
+        self._GetFlags(output_dash=True) + ['--vod_range_duration=1'])
+    self._CheckTestResults('audio-video')
+
   def testAudioVideoWithAccessibilitiesAndRoles(self):
     streams = [
         self._GetStream(
@@ -729,6 +736,19 @@ class PackagerFunctionalTest(PackagerAppTest):
     self.assertPackageSuccess(streams, self._GetFlags(output_dash=True))
     self._CheckTestResults('audio-video-with-trick-play')
 
+  def testAudioVideoWithTrickPlayAndPipelineQueue(self):
+    # The outputs are muxed on their own threads, with the same output.
+    streams = [
+        self._GetStream('audio'),
+        self._GetStream('video'),
+        self._GetStream('video', trick_play_factor=1),
+    ]
+
+    self.assertPackageSuccess(
+        streams,
+        self._GetFlags(output_dash=True) + ['--pipeline_queue_size=4'])
+    self._CheckTestResults('audio-video-with-trick-play')
+
   def testAudioVideoWithTwoTrickPlay(self):
     streams = [
         self._GetStream('audio'),
@@ -1000,6 +1020,14 @@ class PackagerFunctionalTest(PackagerAppTest):
         self._GetFlags(encryption=True, output_dash=True))
     self._CheckTestResults('encryption', verify_decryption=True)
 
+  def testEncryptionWithVodRanges(self):
+    # The ranges are encrypted in parallel, with the same output.
+    self.assertPackageSuccess(
+        self._GetStreams(['audio', 'video']),
+        self._GetFlags(encryption=True, output_dash=True) +
+        ['--vod_range_duration=1'])
+    self._CheckTestResults('encryption', verify_decryption=True)
+
   def testEncryptionWithMultiDrms(self):
     self.assertPackageSuccess(
         self._GetStreams(['audio', 'video']),
@@ -0,0 +1,315 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/app/vod_range_planner.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "packager/base/bind.h"
+#include "packager/base/logging.h"
+#include "packager/base/strings/string_number_conversions.h"
+#include "packager/file/file.h"
+#include "packager/file/file_closer.h"
+#include "packager/media/base/container_names.h"
+#include "packager/media/base/stream_info.h"
+#include "packager/media/formats/mp4/mp4_media_parser.h"
+#include "packager/media/public/chunking_params.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+using SampleTiming = mp4::MP4MediaParser::SampleTiming;
+
+const size_t kReadSize = 0x10000;
+const int64_t kNoDts = std::numeric_limits<int64_t>::max();
+
+// Reads the stream info and the timing of the samples of a local
+// non-fragmented MP4 file, without reading the samples.
+class SampleTimingReader {
+ public:
+  SampleTimingReader() = default;
+
+  bool Read(const std::string& file_name) {
+    if (!File::IsLocalRegularFile(file_name.c_str()))
+      return false;
+    std::unique_ptr<File, FileCloser> file(File::Open(file_name.c_str(), "r"));
+    if (!file) {
+      LOG(ERROR) << "Cannot open file for reading " << file_name;
+      return false;
+    }
+    std::vector<uint8_t> buffer(kReadSize);
+    int64_t bytes_read = file->Read(buffer.data(), buffer.size());
+    if (bytes_read <= 0 ||
+        DetermineContainer(buffer.data(), bytes_read) != CONTAINER_MOV) {
+      return false;
+    }
+
+    mp4::MP4MediaParser parser;
+    parser.Init(base::Bind(&SampleTimingReader::ParserInitEvent,
+                           base::Unretained(this)),
+                base::Bind(&SampleTimingReader::NewSampleEvent,
+                           base::Unretained(this)),
+                nullptr);
+    // Handle trailing 'moov'.
+    parser.LoadMoov(file_name);
+    while (true) {
+      if (!parser.Parse(buffer.data(), bytes_read))
+        return false;
+      if (initialized_)
+        break;
+      bytes_read = file->Read(buffer.data(), buffer.size());
+      if (bytes_read <= 0)
+        return false;
+    }
+    return parser.GetSampleTimings(&sample_timings_);
+  }
+
+  const std::vector<std::shared_ptr<StreamInfo>>& stream_infos() const {
+    return stream_infos_;
+  }
+
+  const std::vector<SampleTiming>& GetSampleTimings(uint32_t track_id) {
+    return sample_timings_[track_id];
+  }
+
+ private:
+  SampleTimingReader(const SampleTimingReader&) = delete;
+  SampleTimingReader& operator=(const SampleTimingReader&) = delete;
+
+  void ParserInitEvent(
+      const std::vector<std::shared_ptr<StreamInfo>>& stream_infos) {
+    stream_infos_ = stream_infos;
+    initialized_ = true;
+  }
+
+  // The samples parsed before the sample tables are read are not needed.
+  bool NewSampleEvent(uint32_t track_id,
+                      std::shared_ptr<MediaSample> sample) {
+    return true;
+  }
+
+  bool initialized_ = false;
+  std::vector<std::shared_ptr<StreamInfo>> stream_infos_;
+  std::map<uint32_t, std::vector<SampleTiming>> sample_timings_;
+};
+
+// Maps the stream selectors to the stream info of their streams, the same way
+// as Demuxer does.
+bool GetSelectedStreams(
+    const std::vector<std::shared_ptr<StreamInfo>>& stream_infos,
+    const std::vector<std::string>& stream_selectors,
+    std::map<std::string, std::shared_ptr<StreamInfo>>* selected_streams) {
+  auto is_selected = [&stream_selectors](const std::string& stream_selector) {
+    return std::find(stream_selectors.begin(), stream_selectors.end(),
+                     stream_selector) != stream_selectors.end();
+  };
+  bool video_selected = is_selected("video");
+  bool audio_selected = is_selected("audio");
+  bool text_selected = is_selected("text");
+  for (size_t i = 0; i < stream_infos.size(); ++i) {
+    const std::shared_ptr<StreamInfo>& stream_info = stream_infos[i];
+    std::string stream_selector = base::SizeTToString(i);
+    if (video_selected && stream_info->stream_type() == kStreamVideo) {
+      stream_selector = "video";
+      video_selected = false;
+    } else if (audio_selected && stream_info->stream_type() == kStreamAudio) {
+      stream_selector = "audio";
+      audio_selected = false;
+    } else if (text_selected && stream_info->stream_type() == kStreamText) {
+      stream_selector = "text";
+      text_selected = false;
+    }
+    if (is_selected(stream_selector))
+      (*selected_streams)[stream_selector] = stream_info;
+  }
+  return selected_streams->size() == stream_selectors.size();
+}
+
+// A segment of a stream, as chunked by ChunkingHandler.
+struct Segment {
+  // The index of the sample starting the segment.
+  size_t first_sample = 0;
+  size_t num_samples = 0;
+  int64_t duration = 0;
+  // Whether the segment can start a range, i.e. whether its samples can be
+  // told apart from the samples of the previous segment by decoding timestamp.
+  bool can_start_range = false;
+  // The encryption state at the start of the segment.
+  EncryptionRangeStart encryption_range_start;
+};
+
+// Splits the samples into segments the same way as ChunkingHandler does, and
+// tracks the encryption state the same way as EncryptionHandler does.
+bool GetSegments(const std::vector<SampleTiming>& sample_timings,
+                 uint32_t time_scale,
+                 const ChunkingParams& chunking_params,
+                 double clear_lead_in_seconds,
+                 std::vector<Segment>* segments) {
+  const int64_t segment_duration =
+      chunking_params.segment_duration_in_seconds * time_scale;
+  if (segment_duration <= 0)
+    return false;
+
+  int64_t current_segment_index = -1;
+  int64_t segment_start_time = 0;
+  int64_t max_segment_time = 0;
+  for (size_t i = 0; i < sample_timings.size(); ++i) {
+    const SampleTiming& sample = sample_timings[i];
+    // The samples of a range are selected by decoding timestamp.
+    if (i > 0 && sample.dts < sample_timings[i - 1].dts)
+      return false;
+
+    if (sample.is_key_frame || !chunking_params.segment_sap_aligned) {
+      const int64_t segment_index =
+          sample.pts < 0 ? 0 : sample.pts / segment_duration;
+      // See ChunkingHandler::OnMediaSample().
+      if (segments->empty() || (segment_index != current_segment_index &&
+                                segment_index != current_segment_index - 1)) {
+        current_segment_index = segment_index;
+        if (!segments->empty())
+          segments->back().duration = max_segment_time - segment_start_time;
+        Segment segment;
+        segment.first_sample = i;
+        segment.can_start_range =
+            i > 0 && sample_timings[i - 1].dts < sample.dts;
+        segments->push_back(segment);
+        segment_start_time = sample.pts;
+        max_segment_time = sample.pts + sample.duration;
+      }
+    }
+    // The samples before the first segment are discarded.
+    if (segments->empty())
+      continue;
+    segments->back().num_samples++;
+    segment_start_time = std::min(segment_start_time, sample.pts);
+    max_segment_time =
+        std::max(max_segment_time, sample.pts + sample.duration);
+  }
+  if (!segments->empty())
+    segments->back().duration = max_segment_time - segment_start_time;
+
+  // See EncryptionHandler::Process(). The samples are encrypted once the clear
+  // lead, which is consumed by whole segments, is over.
+  EncryptionRangeStart encryption_state;
+  encryption_state.remaining_clear_lead =
+      static_cast<int64_t>(clear_lead_in_seconds * time_scale);
+  for (Segment& segment : *segments) {
+    segment.encryption_range_start = encryption_state;
+    if (encryption_state.remaining_clear_lead > 0)
+      encryption_state.remaining_clear_lead -= segment.duration;
+    else
+      encryption_state.num_encrypted_samples += segment.num_samples;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool PlanVodRanges(const std::string& input,
+                   const std::vector<std::string>& stream_selectors,
+                   const ChunkingParams& chunking_params,
+                   double clear_lead_in_seconds,
+                   double range_duration_in_seconds,
+                   std::map<std::string, StreamRanges>* stream_ranges) {
+  DCHECK(stream_ranges);
+  if (range_duration_in_seconds <= 0 || stream_selectors.empty())
+    return false;
+
+  SampleTimingReader reader;
+  if (!reader.Read(input))
+    return false;
+  std::map<std::string, std::shared_ptr<StreamInfo>> selected_streams;
+  if (!GetSelectedStreams(reader.stream_infos(), stream_selectors,
+                          &selected_streams)) {
+    return false;
+  }
+
+  struct StreamPlan {
+    uint32_t time_scale = 0;
+    const std::vector<SampleTiming>* sample_timings = nullptr;
+    std::vector<Segment> segments;
+    // The indexes of the segments starting the ranges.
+    std::vector<size_t> range_starts;
+  };
+  std::map<std::string, StreamPlan> stream_plans;
+  for (const auto& pair : selected_streams) {
+    StreamPlan& stream_plan = stream_plans[pair.first];
+    stream_plan.time_scale = pair.second->time_scale();
+    stream_plan.sample_timings =
+        &reader.GetSampleTimings(pair.second->track_id());
+    if (!GetSegments(*stream_plan.sample_timings, stream_plan.time_scale,
+                     chunking_params, clear_lead_in_seconds,
+                     &stream_plan.segments)) {
+      return false;
+    }
+    stream_plan.range_starts.push_back(0);
+  }
+
+  // The k-th range of a stream starts with the first segment starting at or
+  // after k * |range_duration_in_seconds|, if any, or is empty otherwise.
+  for (size_t k = 1;; ++k) {
+    bool range_started = false;
+    for (auto& pair : stream_plans) {
+      StreamPlan& stream_plan = pair.second;
+      const int64_t range_start_time = static_cast<int64_t>(
+          k * range_duration_in_seconds * stream_plan.time_scale);
+      size_t segment_index = stream_plan.range_starts.back();
+      if (segment_index < stream_plan.segments.size())
+        ++segment_index;
+      for (; segment_index < stream_plan.segments.size(); ++segment_index) {
+        const Segment& segment = stream_plan.segments[segment_index];
+        const SampleTiming& first_sample =
+            (*stream_plan.sample_timings)[segment.first_sample];
+        if (segment.can_start_range && first_sample.pts >= range_start_time)
+          break;
+      }
+      if (segment_index < stream_plan.segments.size())
+        range_started = true;
+      stream_plan.range_starts.push_back(segment_index);
+    }
+    if (!range_started)
+      break;
+  }
+
+  const size_t num_ranges = stream_plans.begin()->second.range_starts.size() - 1;
+  if (num_ranges < 2)
+    return false;
+
+  stream_ranges->clear();
+  for (const auto& pair : stream_plans) {
+    const StreamPlan& stream_plan = pair.second;
+    auto get_start_dts = [&stream_plan](size_t segment_index) -> int64_t {
+      if (segment_index == stream_plan.segments.size())
+        return kNoDts;
+      const Segment& segment = stream_plan.segments[segment_index];
+      return (*stream_plan.sample_timings)[segment.first_sample].dts;
+    };
+
+    StreamRanges& ranges = (*stream_ranges)[pair.first];
+    ranges.track_id = selected_streams[pair.first]->track_id();
+    ranges.ranges.resize(num_ranges);
+    for (size_t k = 0; k < num_ranges; ++k) {
+      StreamRange& range = ranges.ranges[k];
+      const size_t segment_index = stream_plan.range_starts[k];
+      // The first range also includes the samples before the first segment,
+      // which are discarded by ChunkingHandler.
+      range.start_dts = k == 0 ? std::numeric_limits<int64_t>::min()
+                               : get_start_dts(segment_index);
+      range.end_dts = get_start_dts(stream_plan.range_starts[k + 1]);
+      if (segment_index < stream_plan.segments.size()) {
+        range.encryption_range_start =
+            stream_plan.segments[segment_index].encryption_range_start;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace media
+}  // namespace shaka
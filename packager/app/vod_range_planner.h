@@ -0,0 +1,69 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Splits VOD inputs into ranges of segments packaged in parallel.
+
+#ifndef PACKAGER_APP_VOD_RANGE_PLANNER_H_
+#define PACKAGER_APP_VOD_RANGE_PLANNER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "packager/media/crypto/encryption_handler.h"
+
+namespace shaka {
+
+struct ChunkingParams;
+
+namespace media {
+
+/// A range of the segments of a stream.
+struct StreamRange {
+  /// The decoding timestamps of the samples in the range are in
+  /// [start_dts, end_dts).
+  int64_t start_dts = 0;
+  int64_t end_dts = 0;
+  /// The encryption state of the stream at the start of the range.
+  EncryptionRangeStart encryption_range_start;
+};
+
+/// The ranges of a stream, in presentation order.
+struct StreamRanges {
+  /// The id of the track of the stream in the input.
+  uint32_t track_id = 0;
+  std::vector<StreamRange> ranges;
+};
+
+/// Splits the streams of a VOD input into consecutive ranges of whole
+/// segments, so that the ranges of a stream can be chunked and encrypted
+/// separately, e.g. in parallel, and merged back into the same stream as if
+/// the whole stream had been chunked and encrypted at once. The segments are
+/// determined from the sample tables, the same way as ChunkingHandler does,
+/// so only local non-fragmented MP4 inputs without cue points are supported.
+/// @param input is the path of the input file.
+/// @param stream_selectors contains the selectors of the streams to split,
+///        see StreamDescriptor::stream_selector.
+/// @param chunking_params contains the chunking parameters of the streams.
+/// @param clear_lead_in_seconds is the clear lead of the encrypted streams.
+/// @param range_duration_in_seconds is the minimum duration of the ranges,
+///        except for the last one. Ranges start at segment boundaries.
+/// @param stream_ranges receives the ranges of each stream, keyed by stream
+///        selector. All the streams get the same number of ranges, some of
+///        which may be empty.
+/// @return true if the input is split into at least two ranges, false
+///         otherwise, e.g. if the input is not supported or too short.
+bool PlanVodRanges(const std::string& input,
+                   const std::vector<std::string>& stream_selectors,
+                   const ChunkingParams& chunking_params,
+                   double clear_lead_in_seconds,
+                   double range_duration_in_seconds,
+                   std::map<std::string, StreamRanges>* stream_ranges);
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_VOD_RANGE_PLANNER_H_
@@ -208,6 +208,23 @@ bool File::Delete(const char* file_name) {
              : false;
 }
 
+int64_t File::WriteV(const IoVec* buffers, size_t num_buffers) {
+  int64_t total_bytes_written = 0;
+  for (size_t i = 0; i < num_buffers; ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>(buffers[i].data);
+    uint64_t length = buffers[i].length;
+    while (length > 0) {
+      const int64_t bytes_written = Write(data, length);
+      if (bytes_written <= 0)
+        return total_bytes_written > 0 ? total_bytes_written : -1;
+      data += bytes_written;
+      length -= bytes_written;
+      total_bytes_written += bytes_written;
+    }
+  }
+  return total_bytes_written;
+}
+
 int64_t File::GetFileSize(const char* file_name) {
   File* file = File::Open(file_name, "r");
   if (!file)
@@ -317,6 +334,30 @@ bool File::Copy(const char* from_file_name, const char* to_file_name) {
   return true;
 }
 
+int64_t File::AppendFileInKernel(const char* from_file_name,
+                                 uint64_t from_offset,
+                                 const char* to_file_name) {
+  base::StringPiece real_from_file_name;
+  base::StringPiece real_to_file_name;
+  if (GetFileTypeInfo(from_file_name, &real_from_file_name)->type !=
+          kLocalFilePrefix ||
+      GetFileTypeInfo(to_file_name, &real_to_file_name)->type !=
+          kLocalFilePrefix) {
+    return 0;
+  }
+  return LocalFile::AppendFileInKernel(real_from_file_name.data(), from_offset,
+                                       real_to_file_name.data());
+}
+
+std::shared_ptr<const uint8_t> File::MapLocalFile(const char* file_name,
+                                                 uint64_t* size) {
+  DCHECK(size);
+  base::StringPiece real_file_name;
+  if (GetFileTypeInfo(file_name, &real_file_name)->type != kLocalFilePrefix)
+    return nullptr;
+  return LocalFile::Map(real_file_name.data(), size);
+}
+
 int64_t File::CopyFile(File* source, File* destination) {
   return CopyFile(source, destination, kWholeFile);
 }
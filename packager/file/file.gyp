@@ -22,6 +22,8 @@
         'file_closer.h',
         'io_cache.cc',
         'io_cache.h',
+        'io_service.cc',
+        'io_service.h',
         'local_file.cc',
         'local_file.h',
         'memory_file.cc',
@@ -47,7 +49,9 @@
         'file_unittest.cc',
         'file_util_unittest.cc',
         'io_cache_unittest.cc',
+        'io_service_unittest.cc',
         'memory_file_unittest.cc',
+        'udp_file_unittest.cc',
         'udp_options_unittest.cc',
       ],
       'dependencies': [
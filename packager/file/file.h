@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 
+#include <memory>
 #include <string>
 
 #include "packager/base/macros.h"
@@ -22,6 +23,12 @@ extern const char* kMemoryFilePrefix;
 extern const char* kUdpFilePrefix;
 const int64_t kWholeFile = -1;
 
+/// Describes a block of data to be written with File::WriteV.
+struct IoVec {
+  const void* data;
+  uint64_t length;
+};
+
 /// Define an abstract file interface.
 class File {
  public:
@@ -36,6 +43,10 @@ class File {
   /// Open the specified file in direct-access mode (no buffering).
   /// This is a file factory method, it opens a proper file automatically
   /// based on prefix, e.g. "file://" for LocalFile.
+  /// Unlike Open(), no threaded I/O cache is set up and writes block the
+  /// calling thread. This avoids starting a thread for each file, so it is
+  /// preferred for short-lived files written at once from a complete
+  /// in-memory buffer, e.g. media segments.
   /// @param file_name contains the name of the file to be accessed.
   /// @param mode contains file access mode. Implementation dependent.
   /// @return A File pointer on success, false otherwise.
@@ -67,6 +78,15 @@ class File {
   /// @return Number of bytes written, or a value < 0 on error.
   virtual int64_t Write(const void* buffer, uint64_t length) = 0;
 
+  /// Write blocks of data in order, like writev(2). The default implementation
+  /// writes the blocks one at a time with Write().
+  /// @param buffers points to an array of @a num_buffers blocks to write.
+  /// @param num_buffers indicates number of blocks to write.
+  /// @return Number of bytes written, or a value < 0 on error. It is less than
+  ///         the total length of the blocks if an error occurs after some of
+  ///         the data has been written.
+  virtual int64_t WriteV(const IoVec* buffers, size_t num_buffers);
+
   /// @return Size of the file in bytes. A return value less than zero
   ///         indicates a problem getting the size.
   virtual int64_t Size() = 0;
@@ -142,6 +162,31 @@ class File {
   /// @return Number of bytes written, or a value < 0 on error.
   static int64_t CopyFile(File* source, File* destination, int64_t max_copy);
 
+  /// Appends the contents of a local file to another local file without
+  /// copying the data through user space, i.e. with copy_file_range() on
+  /// Linux. Filesystems supporting reflinks share the data blocks between the
+  /// two files instead of copying them.
+  /// @param from_file_name is the source file name.
+  /// @param from_offset is the offset in the source file to append from.
+  /// @param to_file_name is the destination file name. It must exist.
+  /// @return Number of bytes appended, or a value < 0 on error. Zero is
+  ///         returned, and nothing is appended, if it is not supported for
+  ///         these files, e.g. they are not local regular files or are on
+  ///         different filesystems; use CopyFile() instead in that case.
+  static int64_t AppendFileInKernel(const char* from_file_name,
+                                    uint64_t from_offset,
+                                    const char* to_file_name);
+
+  /// Maps a local file into memory for reading, so that it can be parsed in
+  /// place. The file must not be truncated while it is mapped.
+  /// @param file_name is the name of the file to be mapped.
+  /// @param size receives the size of the file on success.
+  /// @return The mapped file contents, which stay mapped as long as they are
+  ///         referenced, or nullptr if @a file_name is not a local file or
+  ///         cannot be mapped.
+  static std::shared_ptr<const uint8_t> MapLocalFile(const char* file_name,
+                                                     uint64_t* size);
+
   /// @param file_name is the name of the file to be checked.
   /// @return true if `file_name` is a local and regular file.
   static bool IsLocalRegularFile(const char* file_name);
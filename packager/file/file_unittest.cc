@@ -174,6 +174,89 @@ TEST_F(LocalFileTest, AtomicWriteRead) {
   EXPECT_EQ(data_, read_data);
 }
 
+TEST_F(LocalFileTest, AppendFileInKernel) {
+  ASSERT_TRUE(
+      File::WriteFileAtomically(local_file_name_no_prefix_.c_str(), data_));
+  FilePath from_file_path;
+  ASSERT_TRUE(base::CreateTemporaryFile(&from_file_path));
+  const std::string from_file_name = from_file_path.AsUTF8Unsafe();
+  const std::string from_data(kDataSize * 3, 'x');
+  ASSERT_TRUE(File::WriteFileAtomically(from_file_name.c_str(), from_data));
+
+  // Appending in the kernel is not supported everywhere, in which case nothing
+  // is appended.
+  const int64_t bytes_appended = File::AppendFileInKernel(
+      from_file_name.c_str(), 0, local_file_name_.c_str());
+  std::string read_data;
+  ASSERT_TRUE(File::ReadFileToString(local_file_name_.c_str(), &read_data));
+  if (bytes_appended == 0) {
+    EXPECT_EQ(data_, read_data);
+  } else {
+    EXPECT_EQ(static_cast<int64_t>(from_data.size()), bytes_appended);
+    EXPECT_EQ(data_ + from_data, read_data);
+  }
+  base::DeleteFile(from_file_path, false);
+}
+
+TEST_F(LocalFileTest, AppendFileInKernelFromOffset) {
+  ASSERT_TRUE(
+      File::WriteFileAtomically(local_file_name_no_prefix_.c_str(), data_));
+  FilePath from_file_path;
+  ASSERT_TRUE(base::CreateTemporaryFile(&from_file_path));
+  const std::string from_file_name = from_file_path.AsUTF8Unsafe();
+  const std::string from_data =
+      std::string(kDataSize, 'x') + std::string(kDataSize * 2, 'y');
+  ASSERT_TRUE(File::WriteFileAtomically(from_file_name.c_str(), from_data));
+
+  const int64_t bytes_appended = File::AppendFileInKernel(
+      from_file_name.c_str(), kDataSize, local_file_name_.c_str());
+  std::string read_data;
+  ASSERT_TRUE(File::ReadFileToString(local_file_name_.c_str(), &read_data));
+  if (bytes_appended == 0) {
+    EXPECT_EQ(data_, read_data);
+  } else {
+    EXPECT_EQ(static_cast<int64_t>(kDataSize * 2), bytes_appended);
+    EXPECT_EQ(data_ + from_data.substr(kDataSize), read_data);
+  }
+  base::DeleteFile(from_file_path, false);
+}
+
+TEST_F(LocalFileTest, AppendFileInKernelNotLocal) {
+  const char kMemoryFileName[] = "memory://file1";
+  ASSERT_TRUE(File::WriteFileAtomically(kMemoryFileName, data_));
+  EXPECT_EQ(0, File::AppendFileInKernel(kMemoryFileName, 0,
+                                        local_file_name_.c_str()));
+  File::Delete(kMemoryFileName);
+}
+
+#if defined(OS_LINUX)
+TEST_F(LocalFileTest, AppendFileInKernelNotRegularFile) {
+  ASSERT_TRUE(
+      File::WriteFileAtomically(local_file_name_no_prefix_.c_str(), data_));
+  EXPECT_EQ(0, File::AppendFileInKernel(local_file_name_.c_str(), 0,
+                                        "/dev/null"));
+}
+#endif  // defined(OS_LINUX)
+
+TEST_F(LocalFileTest, MapLocalFile) {
+  ASSERT_TRUE(
+      File::WriteFileAtomically(local_file_name_no_prefix_.c_str(), data_));
+  uint64_t size = 0;
+  std::shared_ptr<const uint8_t> mapped_file =
+      File::MapLocalFile(local_file_name_.c_str(), &size);
+  ASSERT_TRUE(mapped_file);
+  ASSERT_EQ(data_.size(), size);
+  EXPECT_EQ(data_, std::string(mapped_file.get(), mapped_file.get() + size));
+}
+
+TEST_F(LocalFileTest, MapLocalFileNotLocal) {
+  const char kMemoryFileName[] = "memory://file1";
+  ASSERT_TRUE(File::WriteFileAtomically(kMemoryFileName, data_));
+  uint64_t size = 0;
+  EXPECT_FALSE(File::MapLocalFile(kMemoryFileName, &size));
+  File::Delete(kMemoryFileName);
+}
+
 TEST_F(LocalFileTest, WriteFlushCheckSize) {
   const uint32_t kNumCycles(10);
   const uint32_t kNumWrites(10);
@@ -195,6 +278,43 @@ TEST_F(LocalFileTest, WriteFlushCheckSize) {
   }
 }
 
+class WriteVLocalFileTest : public LocalFileTest,
+                            public ::testing::WithParamInterface<bool> {};
+
+TEST_P(WriteVLocalFileTest, WriteV) {
+  // Large enough to bypass the stdio buffer in LocalFile.
+  const std::string large_data(kDataSize * 100, 'x');
+  const IoVec buffers[] = {{data_.data(), data_.size()},
+                           {nullptr, 0},
+                           {large_data.data(), large_data.size()},
+                           {data_.data(), 10}};
+  const int64_t kTotalSize = kDataSize + large_data.size() + 10;
+
+  const bool no_buffering = GetParam();
+  File* file =
+      no_buffering ? File::OpenWithNoBuffering(local_file_name_.c_str(), "w")
+                   : File::Open(local_file_name_.c_str(), "w");
+  ASSERT_TRUE(file != NULL);
+  EXPECT_EQ(kDataSize, file->Write(data_.data(), kDataSize));
+  EXPECT_EQ(kTotalSize, file->WriteV(buffers, arraysize(buffers)));
+  uint64_t position;
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(static_cast<uint64_t>(kDataSize + kTotalSize), position);
+  // Mixing vectored writes with regular writes keeps the data in order.
+  EXPECT_EQ(kDataSize, file->Write(data_.data(), kDataSize));
+  EXPECT_EQ(2 * kDataSize + kTotalSize, file->Size());
+  EXPECT_TRUE(file->Close());
+
+  std::string read_data;
+  ASSERT_TRUE(File::ReadFileToString(local_file_name_.c_str(), &read_data));
+  EXPECT_EQ(data_ + data_ + large_data + data_.substr(0, 10) + data_,
+            read_data);
+}
+
+INSTANTIATE_TEST_CASE_P(NoBuffering,
+                        WriteVLocalFileTest,
+                        ::testing::Bool());
+
 TEST_F(LocalFileTest, IsLocalReguar) {
   ASSERT_EQ(kDataSize,
             base::WriteFile(test_file_path_, data_.data(), kDataSize));
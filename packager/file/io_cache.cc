@@ -14,22 +14,28 @@
 
 namespace shaka {
 
-using base::AutoLock;
-using base::AutoUnlock;
+// The reader and the writer synchronize through |read_pos_| and |write_pos_|.
+// Blocking uses the Dekker-style pattern below, so that events are only
+// signaled when the other side is actually waiting:
+//   Waiter:   waiting = true;  if (!ready) Wait();  waiting = false;
+//   Notifier: update position; if (waiting) Signal();
+// Both sides use sequentially consistent operations on the flag and the
+// position, so either the waiter sees the update or the notifier sees the
+// waiting flag. Close() always signals both events.
 
 IoCache::IoCache(uint64_t cache_size)
     : cache_size_(cache_size),
+      circular_buffer_(cache_size),
       read_event_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
                   base::WaitableEvent::InitialState::NOT_SIGNALED),
       write_event_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
                    base::WaitableEvent::InitialState::NOT_SIGNALED),
-      // Make the buffer one byte larger than the cache so that when the
-      // condition r_ptr == w_ptr is unambiguous (buffer empty).
-      circular_buffer_(cache_size + 1),
-      end_ptr_(&circular_buffer_[0] + cache_size + 1),
-      r_ptr_(circular_buffer_.data()),
-      w_ptr_(circular_buffer_.data()),
-      closed_(false) {}
+      closed_(false),
+      reader_waiting_(false),
+      writer_waiting_(false) {
+  read_pos_.value = 0;
+  write_pos_.value = 0;
+}
 
 IoCache::~IoCache() {
   Close();
@@ -38,119 +44,165 @@ IoCache::~IoCache() {
 uint64_t IoCache::Read(void* buffer, uint64_t size) {
   DCHECK(buffer);
 
-  AutoLock lock(lock_);
-  while (!closed_ && (BytesCachedInternal() == 0)) {
-    AutoUnlock unlock(lock_);
-    write_event_.Wait();
-  }
+  size = std::min(size, WaitForData());
+  if (size == 0)
+    return 0;
 
-  size = std::min(size, BytesCachedInternal());
-  uint64_t first_chunk_size(
-      std::min(size, static_cast<uint64_t>(end_ptr_ - r_ptr_)));
-  memcpy(buffer, r_ptr_, first_chunk_size);
-  r_ptr_ += first_chunk_size;
-  DCHECK_GE(end_ptr_, r_ptr_);
-  if (r_ptr_ == end_ptr_)
-    r_ptr_ = &circular_buffer_[0];
-  uint64_t second_chunk_size(size - first_chunk_size);
-  if (second_chunk_size) {
-    memcpy(static_cast<uint8_t*>(buffer) + first_chunk_size, r_ptr_,
-           second_chunk_size);
-    r_ptr_ += second_chunk_size;
-    DCHECK_GT(end_ptr_, r_ptr_);
-  }
-  read_event_.Signal();
+  const uint64_t read_pos = read_pos_.value.load(std::memory_order_relaxed);
+  const uint64_t offset = read_pos % cache_size_;
+  const uint64_t first_chunk_size = std::min(size, cache_size_ - offset);
+  memcpy(buffer, &circular_buffer_[offset], first_chunk_size);
+  memcpy(static_cast<uint8_t*>(buffer) + first_chunk_size,
+         circular_buffer_.data(), size - first_chunk_size);
+
+  read_pos_.value.store(read_pos + size);
+  if (writer_waiting_.load())
+    read_event_.Signal();
   return size;
 }
 
 uint64_t IoCache::Write(const void* buffer, uint64_t size) {
   DCHECK(buffer);
 
-  const uint8_t* r_ptr(static_cast<const uint8_t*>(buffer));
-  uint64_t bytes_left(size);
-  while (bytes_left) {
-    AutoLock lock(lock_);
-    while (!closed_ && (BytesFreeInternal() == 0)) {
-      AutoUnlock unlock(lock_);
-      VLOG(1) << "Circular buffer is full, which can happen if data arrives "
-                 "faster than being consumed by packager. Ignore if it is not "
-                 "live packaging. Otherwise, try increasing --io_cache_size.";
-      read_event_.Wait();
-    }
-    if (closed_)
+  const IoVec io_vec = {buffer, size};
+  return WriteV(&io_vec, 1);
+}
+
+uint64_t IoCache::WriteV(const IoVec* buffers, size_t num_buffers) {
+  DCHECK(buffers);
+
+  uint64_t total_size(0);
+  size_t buffer_idx(0);
+  uint64_t buffer_offset(0);
+  while (true) {
+    // Skip empty blocks so we do not wait for room that is not needed.
+    while (buffer_idx < num_buffers && buffers[buffer_idx].length == 0)
+      ++buffer_idx;
+    if (buffer_idx == num_buffers)
+      break;
+
+    uint64_t bytes_free(WaitForRoom());
+    if (bytes_free == 0)
       return 0;
 
-    uint64_t write_size(std::min(bytes_left, BytesFreeInternal()));
-    uint64_t first_chunk_size(
-        std::min(write_size, static_cast<uint64_t>(end_ptr_ - w_ptr_)));
-    memcpy(w_ptr_, r_ptr, first_chunk_size);
-    w_ptr_ += first_chunk_size;
-    DCHECK_GE(end_ptr_, w_ptr_);
-    if (w_ptr_ == end_ptr_)
-      w_ptr_ = &circular_buffer_[0];
-    r_ptr += first_chunk_size;
-    uint64_t second_chunk_size(write_size - first_chunk_size);
-    if (second_chunk_size) {
-      memcpy(w_ptr_, r_ptr, second_chunk_size);
-      w_ptr_ += second_chunk_size;
-      DCHECK_GT(end_ptr_, w_ptr_);
-      r_ptr += second_chunk_size;
+    uint64_t write_pos = write_pos_.value.load(std::memory_order_relaxed);
+    while (bytes_free && buffer_idx < num_buffers) {
+      const IoVec& buffer = buffers[buffer_idx];
+      uint64_t write_size(std::min(buffer.length - buffer_offset, bytes_free));
+      WriteInternal(write_pos,
+                    static_cast<const uint8_t*>(buffer.data) + buffer_offset,
+                    write_size);
+      write_pos += write_size;
+      buffer_offset += write_size;
+      bytes_free -= write_size;
+      total_size += write_size;
+      if (buffer_offset == buffer.length) {
+        ++buffer_idx;
+        buffer_offset = 0;
+      }
     }
-    bytes_left -= write_size;
-    write_event_.Signal();
+    write_pos_.value.store(write_pos);
+    if (reader_waiting_.load())
+      write_event_.Signal();
   }
-  return size;
+  return total_size;
 }
 
 void IoCache::Clear() {
-  AutoLock lock(lock_);
-  r_ptr_ = w_ptr_ = circular_buffer_.data();
+  read_pos_.value.store(write_pos_.value.load());
   // Let any writers know that there is room in the cache.
-  read_event_.Signal();
+  if (writer_waiting_.load())
+    read_event_.Signal();
 }
 
 void IoCache::Close() {
-  AutoLock lock(lock_);
-  closed_ = true;
+  closed_.store(true);
   read_event_.Signal();
   write_event_.Signal();
 }
 
 void IoCache::Reopen() {
-  AutoLock lock(lock_);
-  CHECK(closed_);
-  r_ptr_ = w_ptr_ = circular_buffer_.data();
-  closed_ = false;
+  CHECK(closed());
+  read_pos_.value = 0;
+  write_pos_.value = 0;
+  reader_waiting_ = false;
+  writer_waiting_ = false;
   read_event_.Reset();
   write_event_.Reset();
+  closed_.store(false);
 }
 
 uint64_t IoCache::BytesCached() {
-  AutoLock lock(lock_);
-  return BytesCachedInternal();
+  // Load |read_pos_| first, as it never passes |write_pos_|.
+  const uint64_t read_pos = read_pos_.value.load(std::memory_order_acquire);
+  const uint64_t write_pos = write_pos_.value.load(std::memory_order_acquire);
+  return std::min(write_pos - read_pos, cache_size_);
 }
 
 uint64_t IoCache::BytesFree() {
-  AutoLock lock(lock_);
-  return BytesFreeInternal();
+  return cache_size_ - BytesCached();
 }
 
-uint64_t IoCache::BytesCachedInternal() {
-  return (r_ptr_ <= w_ptr_)
-             ? w_ptr_ - r_ptr_
-             : (end_ptr_ - r_ptr_) + (w_ptr_ - circular_buffer_.data());
+void IoCache::WaitUntilEmptyOrClosed() {
+  const uint64_t write_pos = write_pos_.value.load(std::memory_order_relaxed);
+  while (!closed() &&
+         read_pos_.value.load(std::memory_order_acquire) != write_pos) {
+    writer_waiting_.store(true);
+    if (!closed_.load() && read_pos_.value.load() != write_pos)
+      read_event_.Wait();
+    writer_waiting_.store(false);
+  }
 }
 
-uint64_t IoCache::BytesFreeInternal() {
-  return cache_size_ - BytesCachedInternal();
+uint64_t IoCache::WaitForData() {
+  const uint64_t read_pos = read_pos_.value.load(std::memory_order_relaxed);
+  while (true) {
+    // Check |closed_| first, so that the data written before closing the
+    // cache is not missed.
+    const bool closed = closed_.load(std::memory_order_acquire);
+    const uint64_t bytes_cached =
+        write_pos_.value.load(std::memory_order_acquire) - read_pos;
+    if (bytes_cached > 0 || closed)
+      return bytes_cached;
+
+    reader_waiting_.store(true);
+    if (!closed_.load() && write_pos_.value.load() == read_pos)
+      write_event_.Wait();
+    reader_waiting_.store(false);
+  }
 }
 
-void IoCache::WaitUntilEmptyOrClosed() {
-  AutoLock lock(lock_);
-  while (!closed_ && BytesCachedInternal()) {
-    AutoUnlock unlock(lock_);
-    read_event_.Wait();
+uint64_t IoCache::WaitForRoom() {
+  const uint64_t write_pos = write_pos_.value.load(std::memory_order_relaxed);
+  while (true) {
+    if (closed())
+      return 0;
+    const uint64_t bytes_free =
+        cache_size_ -
+        (write_pos - read_pos_.value.load(std::memory_order_acquire));
+    if (bytes_free > 0)
+      return bytes_free;
+
+    VLOG(1) << "Circular buffer is full, which can happen if data arrives "
+               "faster than being consumed by packager. Ignore if it is not "
+               "live packaging. Otherwise, try increasing --io_cache_size.";
+    writer_waiting_.store(true);
+    if (!closed_.load() && write_pos - read_pos_.value.load() == cache_size_)
+      read_event_.Wait();
+    writer_waiting_.store(false);
   }
 }
 
+void IoCache::WriteInternal(uint64_t write_pos,
+                            const uint8_t* data,
+                            uint64_t size) {
+  DCHECK_LE(size, cache_size_ - (write_pos - read_pos_.value.load()));
+
+  const uint64_t offset = write_pos % cache_size_;
+  const uint64_t first_chunk_size = std::min(size, cache_size_ - offset);
+  memcpy(&circular_buffer_[offset], data, first_chunk_size);
+  memcpy(circular_buffer_.data(), data + first_chunk_size,
+         size - first_chunk_size);
+}
+
 }  // namespace shaka
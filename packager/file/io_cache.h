@@ -8,14 +8,18 @@
 #define PACKAGER_FILE_IO_CACHE_H_
 
 #include <stdint.h>
+#include <atomic>
 #include <vector>
 #include "packager/base/macros.h"
-#include "packager/base/synchronization/lock.h"
 #include "packager/base/synchronization/waitable_event.h"
+#include "packager/file/file.h"
 
 namespace shaka {
 
-/// Declaration of class which implements a thread-safe circular buffer.
+/// Declaration of class which implements a thread-safe circular buffer for a
+/// single reader thread and a single writer thread. Reads and writes do not
+/// take locks; the reader or the writer only blocks, on an event, when the
+/// cache is empty or full respectively.
 class IoCache {
  public:
   explicit IoCache(uint64_t cache_size);
@@ -38,7 +42,17 @@ class IoCache {
   ///         closed.
   uint64_t Write(const void* buffer, uint64_t size);
 
-  /// Empties the cache.
+  /// Write blocks of data to the cache in order. Unlike calling Write() for
+  /// each block, the data is made available to the reader once per batch of
+  /// blocks that fits in the cache. This function may block until there is
+  /// enough room in the cache.
+  /// @param buffers points to an array of @a num_buffers blocks to write.
+  /// @param num_buffers is the number of blocks to write.
+  /// @return the total size of the blocks, or 0 if the call unblocked because
+  ///         the cache has been closed.
+  uint64_t WriteV(const IoVec* buffers, size_t num_buffers);
+
+  /// Empties the cache. Must be called on the reader thread.
   void Clear();
 
   /// Close the cache. This will call any blocking calls to unblock, and the
@@ -46,9 +60,10 @@ class IoCache {
   void Close();
 
   /// @return true if the cache is closed, false otherwise.
-  bool closed() { return closed_; }
+  bool closed() { return closed_.load(std::memory_order_acquire); }
 
-  /// Reopens the cache. Any data still in the cache will be lost.
+  /// Reopens the cache. Any data still in the cache will be lost. There must
+  /// be no concurrent calls to the cache.
   void Reopen();
 
   /// Returns the number of bytes in the cache.
@@ -59,22 +74,44 @@ class IoCache {
   /// @return the number of free bytes in the cache.
   uint64_t BytesFree();
 
-  /// Waits until the cache is empty or has been closed.
+  /// Waits until the cache is empty or has been closed. Must be called on the
+  /// writer thread.
   void WaitUntilEmptyOrClosed();
 
  private:
-  uint64_t BytesCachedInternal();
-  uint64_t BytesFreeInternal();
+  // Assumed size of a CPU cache line.
+  static const size_t kCacheLineSize = 64;
+
+  // Position padded to a cache line, so that the positions updated by the
+  // reader and by the writer are on separate cache lines.
+  struct PaddedPosition {
+    std::atomic<uint64_t> value;
+    uint8_t padding[kCacheLineSize - sizeof(std::atomic<uint64_t>)];
+  };
+
+  // Blocks the reader until there is data in the cache or it is closed.
+  // @return the number of bytes in the cache.
+  uint64_t WaitForData();
+  // Blocks the writer until there is room in the cache or it is closed.
+  // @return the number of free bytes in the cache.
+  uint64_t WaitForRoom();
+  // Copy |size| bytes to the cache at |write_pos|. There must be enough room
+  // in the cache.
+  void WriteInternal(uint64_t write_pos, const uint8_t* data, uint64_t size);
 
   const uint64_t cache_size_;
-  base::Lock lock_;
+  std::vector<uint8_t> circular_buffer_;
+  // Signaled by the reader when data is read, if the writer is waiting.
   base::WaitableEvent read_event_;
+  // Signaled by the writer when data is written, if the reader is waiting.
   base::WaitableEvent write_event_;
-  std::vector<uint8_t> circular_buffer_;
-  const uint8_t* end_ptr_;
-  uint8_t* r_ptr_;
-  uint8_t* w_ptr_;
-  bool closed_;
+  std::atomic<bool> closed_;
+  std::atomic<bool> reader_waiting_;
+  std::atomic<bool> writer_waiting_;
+  // Total number of bytes read. Only updated by the reader.
+  PaddedPosition read_pos_;
+  // Total number of bytes written. Only updated by the writer.
+  PaddedPosition write_pos_;
 
   DISALLOW_COPY_AND_ASSIGN(IoCache);
 };
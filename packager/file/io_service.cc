@@ -0,0 +1,186 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/file/io_service.h"
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <deque>
+
+#include "packager/base/logging.h"
+#include "packager/base/threading/simple_thread.h"
+#include "packager/base/time/time.h"
+
+DEFINE_int32(io_service_threads,
+             2,
+             "Number of threads running asynchronous file operations, e.g. "
+             "deleting segments outside of the live window. Specify 0 to run "
+             "them synchronously.");
+
+namespace shaka {
+
+struct IoService::Task {
+  Operation operation;
+  CompletionCallback callback;
+  base::TimeTicks submit_time;
+};
+
+// A submission queue, served by its own thread.
+class IoService::Queue : public base::SimpleThread {
+ public:
+  explicit Queue(IoService* io_service)
+      : base::SimpleThread("IoService"),
+        io_service_(io_service),
+        task_available_(&lock_) {}
+
+  ~Queue() override {
+    {
+      base::AutoLock auto_lock(lock_);
+      stopped_ = true;
+      task_available_.Signal();
+    }
+    Join();
+  }
+
+  void Push(Task task) {
+    base::AutoLock auto_lock(lock_);
+    tasks_.push_back(std::move(task));
+    task_available_.Signal();
+  }
+
+ private:
+  void Run() override {
+    while (true) {
+      Task task;
+      {
+        base::AutoLock auto_lock(lock_);
+        while (tasks_.empty() && !stopped_)
+          task_available_.Wait();
+        // The pending tasks run before the queue stops.
+        if (tasks_.empty())
+          return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      io_service_->RunTask(task);
+    }
+  }
+
+  IoService* const io_service_;
+  base::Lock lock_;
+  base::ConditionVariable task_available_;
+  std::deque<Task> tasks_;
+  bool stopped_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(Queue);
+};
+
+IoService::IoService(size_t num_queues) : idle_(&lock_) {
+  for (size_t i = 0; i < num_queues; ++i) {
+    queues_.emplace_back(new Queue(this));
+    queues_.back()->Start();
+  }
+}
+
+IoService::~IoService() {
+  Flush();
+  queues_.clear();
+}
+
+IoService* IoService::GetInstance() {
+  // Intentionally leaked, as operations may be submitted during static
+  // destruction.
+  static IoService* instance =
+      new IoService(static_cast<size_t>(std::max(FLAGS_io_service_threads, 0)));
+  return instance;
+}
+
+void IoService::Submit(const std::string& key,
+                       Operation operation,
+                       CompletionCallback callback) {
+  DCHECK(operation);
+  Task task;
+  task.operation = std::move(operation);
+  task.callback = std::move(callback);
+  task.submit_time = base::TimeTicks::Now();
+  {
+    base::AutoLock auto_lock(lock_);
+    ++stats_.num_submitted;
+    ++stats_.num_in_flight;
+  }
+
+  if (queues_.empty()) {
+    RunTask(task);
+    return;
+  }
+  const size_t queue_index = std::hash<std::string>()(key) % queues_.size();
+  queues_[queue_index]->Push(std::move(task));
+}
+
+void IoService::Flush() {
+  base::AutoLock auto_lock(lock_);
+  while (stats_.num_in_flight > 0)
+    idle_.Wait();
+}
+
+IoService::Stats IoService::GetStats() const {
+  base::AutoLock auto_lock(lock_);
+  return stats_;
+}
+
+void IoService::RunTask(const Task& task) {
+  const bool success = task.operation();
+  if (task.callback)
+    task.callback(success);
+  const double latency_in_seconds =
+      (base::TimeTicks::Now() - task.submit_time).InSecondsF();
+
+  base::AutoLock auto_lock(lock_);
+  if (!success)
+    ++stats_.num_failed;
+  stats_.total_latency_in_seconds += latency_in_seconds;
+  stats_.max_latency_in_seconds =
+      std::max(stats_.max_latency_in_seconds, latency_in_seconds);
+  DCHECK_GT(stats_.num_in_flight, 0u);
+  if (--stats_.num_in_flight == 0)
+    idle_.Broadcast();
+}
+
+IoOperationGroup::IoOperationGroup(IoService* io_service)
+    : io_service_(io_service), idle_(&lock_) {
+  DCHECK(io_service_);
+}
+
+IoOperationGroup::~IoOperationGroup() {
+  Flush();
+}
+
+void IoOperationGroup::Submit(const std::string& key,
+                              IoService::Operation operation,
+                              IoService::CompletionCallback callback) {
+  {
+    base::AutoLock auto_lock(lock_);
+    ++num_in_flight_;
+  }
+  io_service_->Submit(key, std::move(operation),
+                      [this, callback](bool success) {
+                        if (callback)
+                          callback(success);
+                        base::AutoLock auto_lock(lock_);
+                        DCHECK_GT(num_in_flight_, 0u);
+                        if (--num_in_flight_ == 0)
+                          idle_.Broadcast();
+                      });
+}
+
+void IoOperationGroup::Flush() {
+  base::AutoLock auto_lock(lock_);
+  while (num_in_flight_ > 0)
+    idle_.Wait();
+}
+
+}  // namespace shaka
@@ -0,0 +1,127 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_IO_SERVICE_H_
+#define PACKAGER_FILE_IO_SERVICE_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "packager/base/macros.h"
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+
+namespace shaka {
+
+/// Runs file operations, e.g. deleting old segments, asynchronously, so that
+/// the threads issuing them do not block on the file system. The operations
+/// are distributed over a fixed set of submission queues, each served by its
+/// own thread. The operations submitted with the same key, e.g. the name of
+/// the file they operate on, go to the same queue, so they run in submission
+/// order.
+/// This class is thread safe.
+class IoService {
+ public:
+  /// An operation. Returns true on success, false otherwise.
+  typedef std::function<bool()> Operation;
+  /// Called with the result of an operation once it has run, on the thread
+  /// which ran it.
+  typedef std::function<void(bool success)> CompletionCallback;
+
+  /// Statistics of the operations submitted so far.
+  struct Stats {
+    uint64_t num_submitted = 0;
+    /// The number of operations submitted but not completed yet.
+    uint64_t num_in_flight = 0;
+    uint64_t num_failed = 0;
+    /// The sum of the latencies of the completed operations, from submission
+    /// to completion, in seconds.
+    double total_latency_in_seconds = 0;
+    /// The longest latency of a completed operation, in seconds.
+    double max_latency_in_seconds = 0;
+  };
+
+  /// @param num_queues is the number of submission queues, and threads.
+  ///        Specify 0 to run the operations synchronously on submission.
+  explicit IoService(size_t num_queues);
+  /// Waits for the submitted operations to complete.
+  ~IoService();
+
+  /// @return the process-wide I/O service, with its number of queues set by
+  ///         --io_service_threads.
+  static IoService* GetInstance();
+
+  /// Submits an operation.
+  /// @param key identifies what the operation operates on, usually a file
+  ///        name. Operations with the same key run in submission order.
+  /// @param operation is the operation to run.
+  /// @param callback, if not null, is called with the result of the operation
+  ///        once it has run.
+  void Submit(const std::string& key,
+              Operation operation,
+              CompletionCallback callback);
+
+  /// Waits until all the operations submitted so far have completed.
+  void Flush();
+
+  /// @return the statistics of the operations submitted so far.
+  Stats GetStats() const;
+
+ private:
+  class Queue;
+  struct Task;
+
+  void RunTask(const Task& task);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  mutable base::Lock lock_;
+  // Signaled when |stats_.num_in_flight| drops to zero.
+  base::ConditionVariable idle_;
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(IoService);
+};
+
+/// Groups operations submitted to an IoService, e.g. the operations of one
+/// packager instance, so that they can be waited for without waiting for the
+/// operations submitted by other users of the service.
+/// This class is thread safe.
+class IoOperationGroup {
+ public:
+  /// @param io_service is the service which runs the operations. It must
+  ///        outlive this group.
+  explicit IoOperationGroup(IoService* io_service);
+  /// Waits for the operations submitted through this group to complete.
+  ~IoOperationGroup();
+
+  /// Submits an operation to the service, see IoService::Submit().
+  void Submit(const std::string& key,
+              IoService::Operation operation,
+              IoService::CompletionCallback callback);
+
+  /// Waits until all the operations submitted through this group so far have
+  /// completed.
+  void Flush();
+
+ private:
+  IoService* const io_service_;
+
+  base::Lock lock_;
+  // Signaled when |num_in_flight_| drops to zero.
+  base::ConditionVariable idle_;
+  uint64_t num_in_flight_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(IoOperationGroup);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_IO_SERVICE_H_
@@ -0,0 +1,118 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/file/io_service.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "packager/base/synchronization/waitable_event.h"
+
+namespace shaka {
+namespace {
+const size_t kNumQueues = 2;
+const int kNumOperations = 100;
+}  // namespace
+
+TEST(IoServiceTest, RunsOperationsWithTheSameKeyInOrder) {
+  IoService io_service(kNumQueues);
+  std::vector<int> results[2];
+  for (int i = 0; i < kNumOperations; ++i) {
+    for (int key = 0; key < 2; ++key) {
+      std::vector<int>* result = &results[key];
+      io_service.Submit(key == 0 ? "file0" : "file1", [result, i]() {
+        result->push_back(i);
+        return true;
+      }, nullptr);
+    }
+  }
+  io_service.Flush();
+
+  for (const std::vector<int>& result : results) {
+    ASSERT_EQ(static_cast<size_t>(kNumOperations), result.size());
+    for (int i = 0; i < kNumOperations; ++i)
+      EXPECT_EQ(i, result[i]);
+  }
+  const IoService::Stats stats = io_service.GetStats();
+  EXPECT_EQ(2u * kNumOperations, stats.num_submitted);
+  EXPECT_EQ(0u, stats.num_in_flight);
+  EXPECT_EQ(0u, stats.num_failed);
+  EXPECT_LE(stats.max_latency_in_seconds, stats.total_latency_in_seconds);
+}
+
+TEST(IoServiceTest, CallsCompletionCallbacks) {
+  IoService io_service(kNumQueues);
+  std::atomic<int> num_succeeded(0);
+  std::atomic<int> num_failed(0);
+  for (int i = 0; i < kNumOperations; ++i) {
+    io_service.Submit("file" + std::to_string(i), [i]() { return i % 2 == 0; },
+                      [&num_succeeded, &num_failed](bool success) {
+                        ++(success ? num_succeeded : num_failed);
+                      });
+  }
+  io_service.Flush();
+
+  EXPECT_EQ(kNumOperations / 2, num_succeeded);
+  EXPECT_EQ(kNumOperations / 2, num_failed);
+  EXPECT_EQ(static_cast<uint64_t>(kNumOperations / 2),
+            io_service.GetStats().num_failed);
+}
+
+TEST(IoServiceTest, RunsOperationsAsynchronously) {
+  IoService io_service(kNumQueues);
+  base::WaitableEvent release(base::WaitableEvent::ResetPolicy::MANUAL,
+                              base::WaitableEvent::InitialState::NOT_SIGNALED);
+  io_service.Submit("file", [&release]() {
+    release.Wait();
+    return true;
+  }, nullptr);
+  // Submit() does not wait for the blocked operation.
+  EXPECT_EQ(1u, io_service.GetStats().num_in_flight);
+
+  release.Signal();
+  io_service.Flush();
+  EXPECT_EQ(0u, io_service.GetStats().num_in_flight);
+}
+
+TEST(IoServiceTest, RunsOperationsSynchronouslyWithoutQueues) {
+  IoService io_service(0);
+  bool done = false;
+  io_service.Submit("file", [&done]() {
+    done = true;
+    return true;
+  }, nullptr);
+  EXPECT_TRUE(done);
+  EXPECT_EQ(0u, io_service.GetStats().num_in_flight);
+}
+
+TEST(IoOperationGroupTest, FlushWaitsForTheGroupOnly) {
+  IoService io_service(kNumQueues);
+  IoOperationGroup group(&io_service);
+  std::atomic<int> num_completed(0);
+  for (int i = 0; i < kNumOperations; ++i) {
+    group.Submit("file" + std::to_string(i), []() { return true; },
+                 [&num_completed](bool success) { ++num_completed; });
+  }
+  // An operation of another user of the service, which blocks. It is
+  // submitted last, so that it does not hold up the operations of the group
+  // even if it goes to the same queue.
+  base::WaitableEvent release(base::WaitableEvent::ResetPolicy::MANUAL,
+                              base::WaitableEvent::InitialState::NOT_SIGNALED);
+  io_service.Submit("blocked", [&release]() {
+    release.Wait();
+    return true;
+  }, nullptr);
+
+  group.Flush();
+  EXPECT_EQ(kNumOperations, num_completed);
+  EXPECT_EQ(1u, io_service.GetStats().num_in_flight);
+
+  release.Signal();
+  io_service.Flush();
+}
+
+}  // namespace shaka
@@ -10,11 +10,26 @@
 #if defined(OS_WIN)
 #include <windows.h>
 #else
+#include <limits.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #endif  // defined(OS_WIN)
+#if defined(OS_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // defined(OS_LINUX)
+#include <algorithm>
+#include <vector>
 #include "packager/base/files/file_path.h"
 #include "packager/base/files/file_util.h"
+#include "packager/base/files/memory_mapped_file.h"
+#include "packager/base/files/scoped_file.h"
 #include "packager/base/logging.h"
+#include "packager/base/posix/eintr_wrapper.h"
 
 namespace shaka {
 namespace {
@@ -90,6 +105,18 @@ bool CreateDirectory(const base::FilePath& full_path) {
   return true;
 }
 
+#if !defined(OS_WIN)
+// Writes smaller than this go through the stdio buffer, which is cheaper than
+// a system call per write.
+const uint64_t kMinWriteVSize = 64 * 1024;
+
+#if defined(IOV_MAX)
+const size_t kMaxIoVecs = IOV_MAX;
+#else
+const size_t kMaxIoVecs = 16;  // The minimum allowed by POSIX.
+#endif  // defined(IOV_MAX)
+#endif  // !defined(OS_WIN)
+
 }  // namespace
 
 // Always open files in binary mode.
@@ -135,6 +162,72 @@ int64_t LocalFile::Write(const void* buffer, uint64_t length) {
   return bytes_written;
 }
 
+int64_t LocalFile::WriteV(const IoVec* buffers, size_t num_buffers) {
+#if defined(OS_WIN)
+  return File::WriteV(buffers, num_buffers);
+#else
+  DCHECK(buffers != NULL);
+  DCHECK(internal_file_ != NULL);
+
+  std::vector<struct iovec> io_vecs;
+  io_vecs.reserve(num_buffers);
+  uint64_t total_length = 0;
+  for (size_t i = 0; i < num_buffers; ++i) {
+    if (buffers[i].length == 0)
+      continue;
+    io_vecs.push_back({const_cast<void*>(buffers[i].data),
+                       static_cast<size_t>(buffers[i].length)});
+    total_length += buffers[i].length;
+  }
+  if (total_length < kMinWriteVSize)
+    return File::WriteV(buffers, num_buffers);
+
+  // Bypass the stdio buffer, which has to be written out first.
+  if (fflush(internal_file_) != 0)
+    return -1;
+  const int fd = fileno(internal_file_);
+
+  int64_t total_bytes_written = 0;
+  size_t io_vec_idx = 0;
+  while (io_vec_idx < io_vecs.size()) {
+    const int num_io_vecs =
+        static_cast<int>(std::min(io_vecs.size() - io_vec_idx, kMaxIoVecs));
+    const ssize_t bytes_written =
+        HANDLE_EINTR(writev(fd, &io_vecs[io_vec_idx], num_io_vecs));
+    VLOG(2) << "WriteV " << num_io_vecs << " blocks return " << bytes_written;
+    if (bytes_written <= 0) {
+      PLOG(ERROR) << "Failed to write to " << file_name();
+      break;
+    }
+    total_bytes_written += bytes_written;
+
+    // Skip the blocks written, which may end in the middle of a block.
+    size_t bytes_left = bytes_written;
+    while (io_vec_idx < io_vecs.size() &&
+           bytes_left >= io_vecs[io_vec_idx].iov_len) {
+      bytes_left -= io_vecs[io_vec_idx].iov_len;
+      ++io_vec_idx;
+    }
+    if (bytes_left > 0) {
+      io_vecs[io_vec_idx].iov_base =
+          static_cast<uint8_t*>(io_vecs[io_vec_idx].iov_base) + bytes_left;
+      io_vecs[io_vec_idx].iov_len -= bytes_left;
+    }
+  }
+
+  // Some C libraries cache the file position, so seek the stream to where the
+  // file descriptor is for later stdio calls.
+  const off_t position = lseek(fd, 0, SEEK_CUR);
+  if (position < 0 || fseeko(internal_file_, position, SEEK_SET) < 0) {
+    PLOG(ERROR) << "Failed to sync the position of " << file_name();
+    return -1;
+  }
+  if (io_vec_idx < io_vecs.size() && total_bytes_written == 0)
+    return -1;
+  return total_bytes_written;
+#endif  // defined(OS_WIN)
+}
+
 int64_t LocalFile::Size() {
   DCHECK(internal_file_ != NULL);
 
@@ -200,4 +293,89 @@ bool LocalFile::Delete(const char* file_name) {
   return base::DeleteFile(base::FilePath::FromUTF8Unsafe(file_name), false);
 }
 
+int64_t LocalFile::AppendFileInKernel(const char* from_file_name,
+                                      uint64_t from_offset,
+                                      const char* to_file_name) {
+#if defined(OS_LINUX) && defined(__NR_copy_file_range)
+  base::ScopedFD from_fd(
+      HANDLE_EINTR(open(from_file_name, O_RDONLY | O_CLOEXEC)));
+  if (!from_fd.is_valid()) {
+    PLOG(ERROR) << "Cannot open " << from_file_name;
+    return -1;
+  }
+  base::ScopedFD to_fd(HANDLE_EINTR(open(to_file_name, O_WRONLY | O_CLOEXEC)));
+  if (!to_fd.is_valid()) {
+    PLOG(ERROR) << "Cannot open " << to_file_name << " for appending";
+    return -1;
+  }
+  // Only regular files can be appended to, e.g. not pipes or devices.
+  struct stat from_stat;
+  struct stat to_stat;
+  if (fstat(from_fd.get(), &from_stat) != 0 ||
+      fstat(to_fd.get(), &to_stat) != 0 || !S_ISREG(from_stat.st_mode) ||
+      !S_ISREG(to_stat.st_mode)) {
+    VLOG(1) << "Cannot append " << from_file_name << " to " << to_file_name
+            << " in the kernel as they are not both regular files.";
+    return 0;
+  }
+  // copy_file_range() does not accept files opened with O_APPEND, so seek to
+  // the end instead.
+  if (lseek(from_fd.get(), static_cast<off_t>(from_offset), SEEK_SET) < 0 ||
+      lseek(to_fd.get(), 0, SEEK_END) < 0) {
+    PLOG(ERROR) << "Cannot seek in " << from_file_name << " or "
+                << to_file_name;
+    return -1;
+  }
+
+  const size_t kMaxCopySize = 1 << 30;
+  int64_t bytes_copied = 0;
+  while (true) {
+    // Called through syscall() as older C libraries do not have a wrapper.
+    const ssize_t result =
+        HANDLE_EINTR(syscall(__NR_copy_file_range, from_fd.get(), nullptr,
+                             to_fd.get(), nullptr, kMaxCopySize, 0u));
+    if (result < 0) {
+      if (bytes_copied == 0 && (errno == ENOSYS || errno == EXDEV ||
+                                errno == EINVAL || errno == EOPNOTSUPP)) {
+        VLOG(1) << "copy_file_range is not supported from " << from_file_name
+                << " to " << to_file_name;
+        return 0;
+      }
+      PLOG(ERROR) << "Failed to append " << from_file_name << " to "
+                  << to_file_name;
+      return -1;
+    }
+    if (result == 0)
+      break;
+    bytes_copied += result;
+  }
+  return bytes_copied;
+#else
+  return 0;
+#endif  // defined(OS_LINUX) && defined(__NR_copy_file_range)
+}
+
+std::shared_ptr<const uint8_t> LocalFile::Map(const char* file_name,
+                                               uint64_t* size) {
+  DCHECK(size);
+  std::shared_ptr<base::MemoryMappedFile> mapped_file(
+      new base::MemoryMappedFile);
+  if (!mapped_file->Initialize(base::FilePath::FromUTF8Unsafe(file_name)) ||
+      !mapped_file->data()) {
+    LOG(ERROR) << "Cannot map " << file_name;
+    return nullptr;
+  }
+#if !defined(OS_WIN)
+  // Media files are mostly read sequentially, so let the kernel read ahead
+  // aggressively and drop the pages soon after they are read.
+  if (madvise(const_cast<uint8_t*>(mapped_file->data()),
+              mapped_file->length(), MADV_SEQUENTIAL) != 0) {
+    PLOG(WARNING) << "madvise failed on " << file_name;
+  }
+#endif  // !defined(OS_WIN)
+  *size = mapped_file->length();
+  // Share the ownership of |mapped_file| with the returned pointer.
+  return std::shared_ptr<const uint8_t>(mapped_file, mapped_file->data());
+}
+
 }  // namespace shaka
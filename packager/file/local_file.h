@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 
+#include <memory>
 #include <string>
 
 #include "packager/base/compiler_specific.h"
@@ -29,6 +30,7 @@ class LocalFile : public File {
   bool Close() override;
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t WriteV(const IoVec* buffers, size_t num_buffers) override;
   int64_t Size() override;
   bool Flush() override;
   bool Seek(uint64_t position) override;
@@ -40,6 +42,24 @@ class LocalFile : public File {
   /// @return true if successful, or false otherwise.
   static bool Delete(const char* file_name);
 
+  /// Append a local file to another local file in the kernel. See
+  /// File::AppendFileInKernel().
+  /// @param from_file_name is the path of the source file.
+  /// @param from_offset is the offset in the source file to append from.
+  /// @param to_file_name is the path of the destination file.
+  /// @return Number of bytes appended, zero if not supported, or a value < 0
+  ///         on error.
+  static int64_t AppendFileInKernel(const char* from_file_name,
+                                    uint64_t from_offset,
+                                    const char* to_file_name);
+
+  /// Map a local file into memory for reading. See File::MapLocalFile().
+  /// @param file_name is the path of the file to be mapped.
+  /// @param size receives the size of the file on success.
+  /// @return The mapped file contents, or nullptr on error.
+  static std::shared_ptr<const uint8_t> Map(const char* file_name,
+                                            uint64_t* size);
+
  protected:
   ~LocalFile() override;
 
@@ -152,6 +152,25 @@ int64_t MemoryFile::Write(const void* buffer, uint64_t length) {
   return length;
 }
 
+int64_t MemoryFile::WriteV(const IoVec* buffers, size_t num_buffers) {
+  uint64_t total_length = 0;
+  for (size_t i = 0; i < num_buffers; ++i)
+    total_length += buffers[i].length;
+
+  // Resize once instead of once per block.
+  const uint64_t size = Size();
+  if (size < position_ + total_length)
+    file_->resize(position_ + total_length);
+
+  for (size_t i = 0; i < num_buffers; ++i) {
+    if (buffers[i].length == 0)
+      continue;
+    memcpy(&(*file_)[position_], buffers[i].data, buffers[i].length);
+    position_ += buffers[i].length;
+  }
+  return total_length;
+}
+
 int64_t MemoryFile::Size() {
   DCHECK(file_);
   return file_->size();
@@ -93,6 +93,25 @@ TEST_F(MemoryFileTest, ExtendsSize) {
   EXPECT_EQ(2 * kWriteBufferSize, static_cast<int64_t>(size));
 }
 
+TEST_F(MemoryFileTest, WriteV) {
+  std::unique_ptr<File, FileCloser> file(File::Open("memory://file1", "w"));
+  ASSERT_TRUE(file);
+
+  const IoVec buffers[] = {{kWriteBuffer, kWriteBufferSize},
+                           {nullptr, 0},
+                           {kWriteBuffer, 2}};
+  ASSERT_EQ(kWriteBufferSize + 2, file->WriteV(buffers, arraysize(buffers)));
+  ASSERT_TRUE(file->Seek(1));
+  ASSERT_EQ(kWriteBufferSize, file->WriteV(buffers, 1));
+  EXPECT_EQ(kWriteBufferSize + 2, file->Size());
+
+  ASSERT_TRUE(file->Seek(0));
+  uint8_t read_buffer[kWriteBufferSize + 2];
+  ASSERT_EQ(kWriteBufferSize + 2, file->Read(read_buffer, sizeof(read_buffer)));
+  const uint8_t kExpected[] = {1, 1, 2, 3, 4, 5, 6, 7, 8, 2};
+  EXPECT_EQ(0, memcmp(kExpected, read_buffer, sizeof(kExpected)));
+}
+
 TEST_F(MemoryFileTest, ReadMissingFileFails) {
   std::unique_ptr<File, FileCloser> file(File::Open("memory://file1", "r"));
   EXPECT_FALSE(file);
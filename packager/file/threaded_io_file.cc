@@ -98,6 +98,21 @@ int64_t ThreadedIoFile::Write(const void* buffer, uint64_t length) {
   return bytes_written;
 }
 
+int64_t ThreadedIoFile::WriteV(const IoVec* buffers, size_t num_buffers) {
+  DCHECK(internal_file_);
+  DCHECK_EQ(kOutputMode, mode_);
+
+  if (internal_file_error_.load(std::memory_order_relaxed))
+    return internal_file_error_.load(std::memory_order_relaxed);
+
+  uint64_t bytes_written = cache_.WriteV(buffers, num_buffers);
+  position_ += bytes_written;
+  if (position_ > size_)
+    size_ = position_;
+
+  return bytes_written;
+}
+
 int64_t ThreadedIoFile::Size() {
   DCHECK(internal_file_);
 
@@ -30,9 +30,22 @@
 #define IP_MULTICAST_ALL      49
 #endif
 
+#if defined(__linux__)
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+
+// SO_BUSY_POLL has been supported since kernel version 3.11.
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL          46
+#endif
+#endif  // defined(__linux__)
+
 #endif  // defined(OS_WIN)
 
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 #include "packager/base/logging.h"
 #include "packager/file/udp_options.h"
@@ -53,14 +66,96 @@ int GetSocketErrorCode() {
 #endif
 }
 
+#if defined(__linux__)
+// Size of the buffer for each datagram, which is enough for any UDP payload.
+const size_t kMaxDatagramSize = 65535;
+// Size of the ancillary data for each datagram: the kernel receive timestamp
+// (SO_TIMESTAMPNS) and the drop counter of the socket (SO_RXQ_OVFL).
+const size_t kControlSize =
+    CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t));
+#endif  // defined(__linux__)
+
 }  // anonymous namespace
 
+#if defined(__linux__)
+// Datagrams received with a single recvmmsg() call, in buffers allocated once.
+class UdpFile::DatagramBatch {
+ public:
+  explicit DatagramBatch(size_t capacity)
+      : buffer_(capacity * kMaxDatagramSize),
+        control_(capacity * kControlSize),
+        iovecs_(capacity),
+        messages_(capacity) {
+    for (size_t i = 0; i < capacity; ++i) {
+      iovecs_[i].iov_base = &buffer_[i * kMaxDatagramSize];
+      iovecs_[i].iov_len = kMaxDatagramSize;
+      messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+      messages_[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+
+  // Receives up to |capacity| datagrams, blocking until at least one is
+  // available. Datagrams not yet consumed are discarded.
+  // @return the number of datagrams received, or -1 on error.
+  int Receive(SOCKET socket) {
+    for (size_t i = 0; i < messages_.size(); ++i) {
+      struct msghdr& header = messages_[i].msg_hdr;
+      header.msg_control = &control_[i * kControlSize];
+      header.msg_controllen = kControlSize;
+      header.msg_flags = 0;
+    }
+    int result;
+    do {
+      result = recvmmsg(socket, messages_.data(), messages_.size(),
+                        MSG_WAITFORONE, NULL);
+    } while (result == -1 && errno == EINTR);
+    num_datagrams_ = std::max(result, 0);
+    next_datagram_ = 0;
+    return result;
+  }
+
+  size_t num_datagrams() const { return num_datagrams_; }
+  const struct mmsghdr& message(size_t index) const {
+    DCHECK_LT(index, num_datagrams_);
+    return messages_[index];
+  }
+
+  bool HasPendingDatagram() const { return next_datagram_ < num_datagrams_; }
+  const uint8_t* pending_datagram() const {
+    return &buffer_[next_datagram_ * kMaxDatagramSize];
+  }
+  size_t pending_datagram_size() const {
+    return std::min<size_t>(messages_[next_datagram_].msg_len,
+                            kMaxDatagramSize);
+  }
+  void ConsumePendingDatagram() { ++next_datagram_; }
+
+ private:
+  DatagramBatch(const DatagramBatch&) = delete;
+  DatagramBatch& operator=(const DatagramBatch&) = delete;
+
+  std::vector<uint8_t> buffer_;
+  std::vector<uint8_t> control_;
+  std::vector<struct iovec> iovecs_;
+  std::vector<struct mmsghdr> messages_;
+  size_t num_datagrams_ = 0;
+  size_t next_datagram_ = 0;
+};
+#else
+class UdpFile::DatagramBatch {};
+#endif  // defined(__linux__)
+
 UdpFile::UdpFile(const char* file_name)
     : File(file_name), socket_(INVALID_SOCKET) {}
 
 UdpFile::~UdpFile() {}
 
 bool UdpFile::Close() {
+  const Statistics statistics = GetStatistics();
+  VLOG(1) << "Received " << statistics.datagrams << " datagrams ("
+          << statistics.bytes << " bytes) from " << file_name() << ", "
+          << statistics.overrun_datagrams << " dropped on receive buffer "
+          << "overrun, " << statistics.truncated_datagrams << " truncated.";
   if (socket_ != INVALID_SOCKET) {
     close(socket_);
     socket_ = INVALID_SOCKET;
@@ -81,15 +176,92 @@ int64_t UdpFile::Read(void* buffer, uint64_t length) {
   if (socket_ == INVALID_SOCKET)
     return -1;
 
+  if (batch_)
+    return ReadBatch(buffer, length);
+
   int64_t result;
   do {
     result =
         recvfrom(socket_, reinterpret_cast<char*>(buffer), length, 0, NULL, 0);
   } while (result == -1 && GetSocketErrorCode() == EINTR_CODE);
 
+  if (result >= 0) {
+    base::AutoLock auto_lock(statistics_lock_);
+    ++statistics_.datagrams;
+    statistics_.bytes += result;
+  }
   return result;
 }
 
+#if defined(__linux__)
+int64_t UdpFile::ReadBatch(void* buffer, uint64_t length) {
+  if (!batch_->HasPendingDatagram()) {
+    if (batch_->Receive(socket_) < 0)
+      return -1;
+
+    base::AutoLock auto_lock(statistics_lock_);
+    const uint64_t previous_overrun_datagrams = statistics_.overrun_datagrams;
+    for (size_t i = 0; i < batch_->num_datagrams(); ++i) {
+      const struct mmsghdr& message = batch_->message(i);
+      ++statistics_.datagrams;
+      statistics_.bytes += message.msg_len;
+      if (message.msg_hdr.msg_flags & MSG_TRUNC)
+        ++statistics_.truncated_datagrams;
+
+      // Const casts are needed as CMSG_NXTHDR takes non-const pointers.
+      struct msghdr* header = const_cast<struct msghdr*>(&message.msg_hdr);
+      for (struct cmsghdr* control = CMSG_FIRSTHDR(header); control;
+           control = CMSG_NXTHDR(header, control)) {
+        if (control->cmsg_level != SOL_SOCKET)
+          continue;
+        if (control->cmsg_type == SCM_TIMESTAMPNS) {
+          struct timespec receive_time;
+          memcpy(&receive_time, CMSG_DATA(control), sizeof(receive_time));
+          statistics_.last_receive_time_ns =
+              receive_time.tv_sec * 1000000000LL + receive_time.tv_nsec;
+        } else if (control->cmsg_type == SO_RXQ_OVFL) {
+          // The number of datagrams dropped since the socket was created.
+          uint32_t dropped_datagrams;
+          memcpy(&dropped_datagrams, CMSG_DATA(control),
+                 sizeof(dropped_datagrams));
+          statistics_.overrun_datagrams = dropped_datagrams;
+        }
+      }
+    }
+    if (statistics_.overrun_datagrams > previous_overrun_datagrams) {
+      LOG(WARNING) << statistics_.overrun_datagrams -
+                          previous_overrun_datagrams
+                   << " datagrams dropped on receive buffer overrun from "
+                   << file_name() << ". Consider increasing buffer_size in "
+                   << "udp options.";
+    }
+  }
+
+  // Return as many whole datagrams as fit in |buffer|.
+  uint8_t* output = reinterpret_cast<uint8_t*>(buffer);
+  uint64_t bytes_read = 0;
+  while (batch_->HasPendingDatagram()) {
+    size_t size = batch_->pending_datagram_size();
+    if (bytes_read + size > length) {
+      if (bytes_read > 0)
+        break;
+      LOG(WARNING) << "Datagram of " << size << " bytes truncated to "
+                   << length << " bytes.";
+      size = length;
+    }
+    memcpy(output + bytes_read, batch_->pending_datagram(), size);
+    bytes_read += size;
+    batch_->ConsumePendingDatagram();
+  }
+  return bytes_read;
+}
+#else
+int64_t UdpFile::ReadBatch(void* buffer, uint64_t length) {
+  NOTREACHED();
+  return -1;
+}
+#endif  // defined(__linux__)
+
 int64_t UdpFile::Write(const void* buffer, uint64_t length) {
   NOTIMPLEMENTED();
   return -1;
@@ -117,6 +289,11 @@ bool UdpFile::Tell(uint64_t* position) {
   return false;
 }
 
+UdpFile::Statistics UdpFile::GetStatistics() const {
+  base::AutoLock auto_lock(statistics_lock_);
+  return statistics_;
+}
+
 class ScopedSocket {
  public:
   explicit ScopedSocket(SOCKET sock_fd) : sock_fd_(sock_fd) {}
@@ -290,6 +467,34 @@ bool UdpFile::Open() {
     }
   }
 
+#if defined(__linux__)
+  if (options->busy_poll_us() > 0) {
+    const int busy_poll_us = options->busy_poll_us();
+    if (setsockopt(new_socket.get(), SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us,
+                   sizeof(busy_poll_us)) < 0) {
+      LOG(ERROR) << "Failed to set busy poll timeout, error = "
+                 << GetSocketErrorCode();
+      return false;
+    }
+  }
+
+  // Kernel receive timestamps and drop counters are only used for statistics,
+  // so failing to enable them is not fatal.
+  const int optval_one = 1;
+  if (setsockopt(new_socket.get(), SOL_SOCKET, SO_TIMESTAMPNS, &optval_one,
+                 sizeof(optval_one)) < 0) {
+    LOG(WARNING) << "Failed to enable receive timestamps, error = "
+                 << GetSocketErrorCode();
+  }
+  if (setsockopt(new_socket.get(), SOL_SOCKET, SO_RXQ_OVFL, &optval_one,
+                 sizeof(optval_one)) < 0) {
+    LOG(WARNING) << "Failed to enable the drop counter, error = "
+                 << GetSocketErrorCode();
+  }
+
+  batch_.reset(new DatagramBatch(options->batch_size()));
+#endif  // defined(__linux__)
+
   socket_ = new_socket.release();
   return true;
 }
@@ -9,9 +9,11 @@
 
 #include <stdint.h>
 
+#include <memory>
 #include <string>
 
 #include "packager/base/compiler_specific.h"
+#include "packager/base/synchronization/lock.h"
 #include "packager/file/file.h"
 
 #if defined(OS_WIN)
@@ -23,8 +25,26 @@ typedef int SOCKET;
 namespace shaka {
 
 /// Implements UdpFile, which receives UDP unicast and multicast streams.
+/// On Linux, datagrams are received in batches with recvmmsg() and Read()
+/// returns as many whole datagrams as fit in the buffer.
 class UdpFile : public File {
  public:
+  /// Receive statistics of the socket.
+  struct Statistics {
+    /// Number of datagrams received.
+    uint64_t datagrams = 0;
+    /// Number of bytes received.
+    uint64_t bytes = 0;
+    /// Number of datagrams truncated because they were too large.
+    uint64_t truncated_datagrams = 0;
+    /// Number of datagrams dropped by the kernel because the receive buffer
+    /// of the socket was full. Linux only.
+    uint64_t overrun_datagrams = 0;
+    /// Kernel receive time of the last datagram, in nanoseconds since the
+    /// Epoch. Linux only, 0 if not available.
+    int64_t last_receive_time_ns = 0;
+  };
+
   /// @param file_name C string containing the address of the stream to receive.
   ///        It should be of the form "<ip_address>:<port>".
   explicit UdpFile(const char* address_and_port);
@@ -40,13 +60,28 @@ class UdpFile : public File {
   bool Tell(uint64_t* position) override;
   /// @}
 
+  /// @return the receive statistics of the socket. Can be called from any
+  ///         thread. They are also logged by Close(), which is how they are
+  ///         reported for a file opened with File::Open(), as it wraps the
+  ///         UdpFile in a threaded I/O cache.
+  Statistics GetStatistics() const;
+
  protected:
   ~UdpFile() override;
 
   bool Open() override;
 
  private:
+  class DatagramBatch;
+
+  // Copies the pending datagrams received in |batch_| to |buffer|, receiving
+  // a new batch first if none is pending.
+  int64_t ReadBatch(void* buffer, uint64_t length);
+
   SOCKET socket_;
+  std::unique_ptr<DatagramBatch> batch_;
+  mutable base::Lock statistics_lock_;
+  Statistics statistics_;
 #if defined(OS_WIN)
   // For Winsock in Windows.
   bool wsa_started_ = false;
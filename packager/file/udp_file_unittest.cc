@@ -0,0 +1,154 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/file/udp_file.h"
+
+#include <gtest/gtest.h>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <string>
+#include <vector>
+
+#include "packager/base/strings/stringprintf.h"
+
+namespace shaka {
+
+// Datagrams are received in batches with recvmmsg() on Linux only.
+#if defined(__linux__)
+
+namespace {
+const char kLocalAddress[] = "127.0.0.1";
+const size_t kReadBufferSize = 65536;
+
+// @return the address of a local socket bound to a free port.
+struct sockaddr_in GetFreeLocalAddress() {
+  struct sockaddr_in address = {0};
+  address.sin_family = AF_INET;
+  address.sin_port = 0;
+  inet_pton(AF_INET, kLocalAddress, &address.sin_addr);
+  const int socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  socklen_t address_size = sizeof(address);
+  if (socket_fd < 0 ||
+      bind(socket_fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) < 0 ||
+      getsockname(socket_fd, reinterpret_cast<struct sockaddr*>(&address),
+                  &address_size) < 0) {
+    address.sin_port = 0;
+  }
+  if (socket_fd >= 0)
+    close(socket_fd);
+  return address;
+}
+}  // namespace
+
+class UdpFileTest : public testing::Test {
+ public:
+  void SetUp() override {
+    address_ = GetFreeLocalAddress();
+    ASSERT_NE(0, address_.sin_port);
+    sender_ = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sender_, 0);
+  }
+
+  void TearDown() override {
+    if (file_)
+      file_->Close();
+    if (sender_ >= 0)
+      close(sender_);
+  }
+
+ protected:
+  void OpenFile(const std::string& options) {
+    // Opened without the threaded I/O cache of File::Open(), so that the file
+    // is the UdpFile itself and each Read() is a read of the test.
+    file_ = static_cast<UdpFile*>(File::OpenWithNoBuffering(
+        base::StringPrintf("udp://%s:%d?%s", kLocalAddress,
+                           ntohs(address_.sin_port), options.c_str())
+            .c_str(),
+        "r"));
+    ASSERT_TRUE(file_);
+  }
+
+  // Sends a datagram of |size| bytes of |value|, and appends it to |sent_|.
+  void Send(size_t size, uint8_t value) {
+    const std::vector<uint8_t> datagram(size, value);
+    ASSERT_EQ(static_cast<ssize_t>(size),
+              sendto(sender_, datagram.data(), datagram.size(), 0,
+                     reinterpret_cast<const struct sockaddr*>(&address_),
+                     sizeof(address_)));
+    sent_.insert(sent_.end(), datagram.begin(), datagram.end());
+  }
+
+  // Reads once and checks that the data read is the next |size| bytes sent.
+  void ExpectRead(size_t size) {
+    std::vector<uint8_t> buffer(kReadBufferSize);
+    ASSERT_EQ(static_cast<int64_t>(size),
+              file_->Read(buffer.data(), buffer.size()));
+    ASSERT_LE(read_position_ + size, sent_.size());
+    EXPECT_EQ(std::vector<uint8_t>(sent_.begin() + read_position_,
+                                   sent_.begin() + read_position_ + size),
+              std::vector<uint8_t>(buffer.begin(), buffer.begin() + size));
+    read_position_ += size;
+  }
+
+  struct sockaddr_in address_;
+  int sender_ = -1;
+  UdpFile* file_ = nullptr;
+  std::vector<uint8_t> sent_;
+  size_t read_position_ = 0;
+};
+
+TEST_F(UdpFileTest, ReadBatch) {
+  OpenFile("batch_size=4");
+  // The datagrams are queued on the socket before the first read, so they are
+  // received in a batch of 4 and a batch of 2.
+  for (int i = 1; i <= 6; ++i)
+    Send(i * 100, i);
+
+  ExpectRead(100 + 200 + 300 + 400);
+  ExpectRead(500 + 600);
+
+  const UdpFile::Statistics statistics = file_->GetStatistics();
+  EXPECT_EQ(6u, statistics.datagrams);
+  EXPECT_EQ(2100u, statistics.bytes);
+  EXPECT_EQ(0u, statistics.truncated_datagrams);
+  EXPECT_EQ(0u, statistics.overrun_datagrams);
+  EXPECT_NE(0, statistics.last_receive_time_ns);
+}
+
+TEST_F(UdpFileTest, ReadBatchReturnsWholeDatagrams) {
+  OpenFile("batch_size=4");
+  const size_t kDatagramSize = 30000;
+  for (int i = 1; i <= 3; ++i)
+    Send(kDatagramSize, i);
+
+  // The three datagrams are received at once, but only two fit in the buffer.
+  // The third one is returned by the next read, without receiving.
+  ExpectRead(2 * kDatagramSize);
+  EXPECT_EQ(3u, file_->GetStatistics().datagrams);
+  ExpectRead(kDatagramSize);
+  EXPECT_EQ(3u, file_->GetStatistics().datagrams);
+}
+
+TEST_F(UdpFileTest, ReadBatchOfOne) {
+  OpenFile("batch_size=1");
+  Send(100, 1);
+  Send(200, 2);
+
+  ExpectRead(100);
+  ExpectRead(200);
+  EXPECT_EQ(2u, file_->GetStatistics().datagrams);
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace shaka
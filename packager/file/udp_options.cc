@@ -18,11 +18,15 @@ DEFINE_string(udp_interface_address,
 
 namespace shaka {
 
+const unsigned UdpOptions::kMaxBatchSize;
+
 namespace {
 
 enum FieldType {
   kUnknownField = 0,
+  kBatchSizeField,
   kBufferSizeField,
+  kBusyPollField,
   kInterfaceAddressField,
   kMulticastSourceField,
   kReuseField,
@@ -35,7 +39,9 @@ struct FieldNameToTypeMapping {
 };
 
 const FieldNameToTypeMapping kFieldNameTypeMappings[] = {
+    {"batch_size", kBatchSizeField},
     {"buffer_size", kBufferSizeField},
+    {"busy_poll", kBusyPollField},
     {"interface", kInterfaceAddressField},
     {"reuse", kReuseField},
     {"source", kMulticastSourceField},
@@ -89,6 +95,19 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
     }
     for (const auto& pair : pairs) {
       switch (GetFieldType(pair.first)) {
+        case kBatchSizeField:
+          if (!base::StringToUint(pair.second, &options->batch_size_) ||
+              options->batch_size_ == 0) {
+            LOG(ERROR) << "Invalid udp option for batch_size field "
+                       << pair.second;
+            return nullptr;
+          }
+          if (options->batch_size_ > kMaxBatchSize) {
+            LOG(WARNING) << "udp option batch_size " << options->batch_size_
+                         << " clamped to " << kMaxBatchSize;
+            options->batch_size_ = kMaxBatchSize;
+          }
+          break;
         case kBufferSizeField:
           if (!base::StringToInt(pair.second, &options->buffer_size_)) {
             LOG(ERROR) << "Invalid udp option for buffer_size field "
@@ -96,6 +115,13 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
             return nullptr;
           }
           break;
+        case kBusyPollField:
+          if (!base::StringToUint(pair.second, &options->busy_poll_us_)) {
+            LOG(ERROR) << "Invalid udp option for busy_poll field "
+                       << pair.second;
+            return nullptr;
+          }
+          break;
         case kInterfaceAddressField:
           options->interface_address_ = pair.second;
           break;
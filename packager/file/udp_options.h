@@ -31,6 +31,11 @@ class UdpOptions {
     return is_source_specific_multicast_;
   }
   int buffer_size() const { return buffer_size_; }
+  unsigned busy_poll_us() const { return busy_poll_us_; }
+  unsigned batch_size() const { return batch_size_; }
+
+  /// The maximum of batch_size(). Larger values are clamped to it.
+  static const unsigned kMaxBatchSize = 256;
 
  private:
   UdpOptions() = default;
@@ -52,6 +57,13 @@ class UdpOptions {
   // by the underlying operating system ('sysctl net.core.rmem_max' on Linux
   // returns the maximum receive memory size).
   int buffer_size_ = 0;
+  // Busy poll timeout in microseconds when receiving from the socket without
+  // data, see SO_BUSY_POLL. 0 to disable busy polling. Linux only.
+  unsigned busy_poll_us_ = 0;
+  // Maximum number of datagrams received in one system call with
+  // recvmmsg(). Linux only. A 64 KiB buffer is allocated for each datagram,
+  // so it is limited to kMaxBatchSize.
+  unsigned batch_size_ = 32;
 };
 
 }  // namespace shaka
@@ -122,4 +122,32 @@ TEST_F(UdpOptionsTest, BufferSize) {
   EXPECT_EQ(1234, options->buffer_size());
 }
 
+TEST_F(UdpOptionsTest, BusyPoll) {
+  auto options = UdpOptions::ParseFromString("224.1.2.30:88");
+  EXPECT_EQ(0u, options->busy_poll_us());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88?busy_poll=50");
+  EXPECT_EQ(50u, options->busy_poll_us());
+}
+
+TEST_F(UdpOptionsTest, InvalidBusyPoll) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?busy_poll=-1"));
+}
+
+TEST_F(UdpOptionsTest, BatchSize) {
+  auto options = UdpOptions::ParseFromString("224.1.2.30:88");
+  EXPECT_EQ(32u, options->batch_size());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88?batch_size=8");
+  EXPECT_EQ(8u, options->batch_size());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88?batch_size=100000");
+  EXPECT_EQ(UdpOptions::kMaxBatchSize, options->batch_size());
+}
+
+TEST_F(UdpOptionsTest, InvalidBatchSize) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?batch_size=0"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?batch_size=a"));
+}
+
 }  // namespace shaka
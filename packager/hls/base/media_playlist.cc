@@ -10,12 +10,14 @@
 
 #include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <memory>
 
 #include "packager/base/logging.h"
 #include "packager/base/strings/string_number_conversions.h"
 #include "packager/base/strings/stringprintf.h"
 #include "packager/file/file.h"
+#include "packager/file/io_service.h"
 #include "packager/hls/base/tag.h"
 #include "packager/media/base/language_utils.h"
 #include "packager/media/base/muxer_util.h"
@@ -344,7 +346,8 @@ MediaPlaylist::MediaPlaylist(const HlsParams& hls_params,
       file_name_(file_name),
       name_(name),
       group_id_(group_id),
-      media_sequence_number_(hls_params_.media_sequence_number) {
+      media_sequence_number_(hls_params_.media_sequence_number),
+      failed_deletions_(new FailedDeletions) {
         // When there's a forced media_sequence_number, start with discontinuity
         if (media_sequence_number_ > 0)
           entries_.emplace_back(new DiscontinuityEntry());
@@ -469,6 +472,14 @@ void MediaPlaylist::AddPlacementOpportunity() {
 }
 
 bool MediaPlaylist::WriteToFile(const std::string& file_path) {
+  if (!File::WriteFileAtomically(file_path.c_str(), ToString())) {
+    LOG(ERROR) << "Failed to write playlist to: " << file_path;
+    return false;
+  }
+  return true;
+}
+
+std::string MediaPlaylist::ToString() {
   if (!target_duration_set_) {
     SetTargetDuration(ceil(GetLongestSegmentDuration()));
   }
@@ -477,18 +488,14 @@ bool MediaPlaylist::WriteToFile(const std::string& file_path) {
       media_info_, target_duration_, hls_params_.playlist_type, stream_type_,
       media_sequence_number_, discontinuity_sequence_number_);
 
-  for (const auto& entry : entries_)
-    base::StringAppendF(&content, "%s\n", entry->ToString().c_str());
+  RenderNewEntries();
+  content.append(rendered_entries_, rendered_entries_offset_,
+                 std::string::npos);
 
   if (hls_params_.playlist_type == HlsPlaylistType::kVod) {
     content += "#EXT-X-ENDLIST\n";
   }
-
-  if (!File::WriteFileAtomically(file_path.c_str(), content)) {
-    LOG(ERROR) << "Failed to write playlist to: " << file_path;
-    return false;
-  }
-  return true;
+  return content;
 }
 
 uint64_t MediaPlaylist::MaxBitrate() const {
@@ -641,8 +648,11 @@ void MediaPlaylist::AdjustLastSegmentInfoEntryDuration(int64_t next_timestamp) {
           next_timestamp_seconds -
           static_cast<double>(segment_info->start_time()) / time_scale_;
       // It could be negative if timestamp messed up.
-      if (segment_duration_seconds > 0)
+      if (segment_duration_seconds > 0) {
+        DropRenderedEntries(entries_.size() - 1 -
+                            std::distance(entries_.rbegin(), iter));
         segment_info->set_duration_seconds(segment_duration_seconds);
+      }
       longest_segment_duration_seconds_ =
           std::max(longest_segment_duration_seconds_, segment_duration_seconds);
       break;
@@ -679,10 +689,27 @@ void MediaPlaylist::SlideWindow() {
   // Consecutive key entries are either fully removed or not removed at all.
   // Keep track of entry types so we know if it is consecutive key entries.
   HlsEntry::EntryType prev_entry_type = HlsEntry::EntryType::kExtInf;
+  // Size of the removed entries in |rendered_entries_|, including the key
+  // entries added back.
+  size_t removed_rendered_size = 0;
 
   std::list<std::unique_ptr<HlsEntry>>::iterator last = entries_.begin();
-  for (; last != entries_.end(); ++last) {
+  for (size_t index = 0; last != entries_.end(); ++last, ++index) {
     HlsEntry::EntryType entry_type = last->get()->type();
+    if (entry_type == HlsEntry::EntryType::kExtInf) {
+      const SegmentInfoEntry& segment_info =
+          *reinterpret_cast<SegmentInfoEntry*>(last->get());
+      // Remove the current segment only if it falls completely out of time
+      // shift buffer range.
+      const bool segment_within_time_shift_buffer =
+          current_buffer_depth_ - segment_info.duration_seconds() <
+          hls_params_.time_shift_buffer_depth;
+      if (segment_within_time_shift_buffer)
+        break;
+    }
+    if (index < rendered_entry_sizes_.size())
+      removed_rendered_size += rendered_entry_sizes_[index];
+
     if (entry_type == HlsEntry::EntryType::kExtKey) {
       if (prev_entry_type != HlsEntry::EntryType::kExtKey)
         ext_x_keys.clear();
@@ -694,43 +721,114 @@ void MediaPlaylist::SlideWindow() {
 
       const SegmentInfoEntry& segment_info =
           *reinterpret_cast<SegmentInfoEntry*>(last->get());
-      // Remove the current segment only if it falls completely out of time
-      // shift buffer range.
-      const bool segment_within_time_shift_buffer =
-          current_buffer_depth_ - segment_info.duration_seconds() <
-          hls_params_.time_shift_buffer_depth;
-      if (segment_within_time_shift_buffer)
-        break;
       current_buffer_depth_ -= segment_info.duration_seconds();
       RemoveOldSegment(segment_info.start_time());
       media_sequence_number_++;
     }
     prev_entry_type = entry_type;
   }
+  const size_t num_removed_entries = std::distance(entries_.begin(), last);
   entries_.erase(entries_.begin(), last);
+
+  if (num_removed_entries >= rendered_entry_sizes_.size()) {
+    rendered_entries_.clear();
+    rendered_entries_offset_ = 0;
+    rendered_entry_sizes_.clear();
+  } else {
+    rendered_entries_offset_ += removed_rendered_size;
+    rendered_entry_sizes_.erase(
+        rendered_entry_sizes_.begin(),
+        rendered_entry_sizes_.begin() + num_removed_entries);
+    // The key entries added back are rendered in the space left by the
+    // removed entries, which contains them.
+    std::string rendered_keys;
+    for (auto entry = ext_x_keys.rbegin(); entry != ext_x_keys.rend();
+         ++entry) {
+      const std::string rendered_key = entry->get()->ToString() + "\n";
+      rendered_keys.insert(0, rendered_key);
+      rendered_entry_sizes_.push_front(rendered_key.size());
+    }
+    DCHECK_LE(rendered_keys.size(), rendered_entries_offset_);
+    rendered_entries_offset_ -= rendered_keys.size();
+    rendered_entries_.replace(rendered_entries_offset_, rendered_keys.size(),
+                              rendered_keys);
+    if (rendered_entries_offset_ >
+        rendered_entries_.size() - rendered_entries_offset_) {
+      rendered_entries_.erase(0, rendered_entries_offset_);
+      rendered_entries_offset_ = 0;
+    }
+  }
+
   // Add key entries back.
   entries_.insert(entries_.begin(), std::make_move_iterator(ext_x_keys.begin()),
                   std::make_move_iterator(ext_x_keys.end()));
 }
 
+void MediaPlaylist::RenderNewEntries() {
+  DCHECK_LE(rendered_entry_sizes_.size(), entries_.size());
+  auto entry =
+      std::prev(entries_.end(), entries_.size() - rendered_entry_sizes_.size());
+  for (; entry != entries_.end(); ++entry) {
+    const size_t rendered_size = rendered_entries_.size();
+    base::StringAppendF(&rendered_entries_, "%s\n",
+                        entry->get()->ToString().c_str());
+    rendered_entry_sizes_.push_back(rendered_entries_.size() - rendered_size);
+  }
+}
+
+void MediaPlaylist::DropRenderedEntries(size_t index) {
+  if (index >= rendered_entry_sizes_.size())
+    return;
+  size_t dropped_size = 0;
+  for (size_t i = index; i < rendered_entry_sizes_.size(); ++i)
+    dropped_size += rendered_entry_sizes_[i];
+  DCHECK_LE(rendered_entries_offset_ + dropped_size, rendered_entries_.size());
+  rendered_entries_.resize(rendered_entries_.size() - dropped_size);
+  rendered_entry_sizes_.resize(index);
+}
+
 void MediaPlaylist::RemoveOldSegment(int64_t start_time) {
   if (hls_params_.preserved_segments_outside_live_window == 0)
     return;
   if (stream_type_ == MediaPlaylistStreamType::kVideoIFramesOnly)
     return;
 
+  {
+    // The segments which failed to be deleted are retried first.
+    base::AutoLock auto_lock(failed_deletions_->lock);
+    segments_to_be_removed_.splice(segments_to_be_removed_.begin(),
+                                   failed_deletions_->segment_names);
+  }
   segments_to_be_removed_.push_back(
       media::GetSegmentName(media_info_.segment_template(), start_time,
                             media_sequence_number_, media_info_.bandwidth()));
   while (segments_to_be_removed_.size() >
          hls_params_.preserved_segments_outside_live_window) {
-    VLOG(2) << "Deleting " << segments_to_be_removed_.front();
-    if (!File::Delete(segments_to_be_removed_.front().c_str())) {
-      LOG(WARNING) << "Failed to delete " << segments_to_be_removed_.front()
+    const std::string segment_name = segments_to_be_removed_.front();
+    segments_to_be_removed_.pop_front();
+    VLOG(2) << "Deleting " << segment_name;
+    // Deleted asynchronously, so that the manifest update is not held up by
+    // the file system.
+    std::shared_ptr<FailedDeletions> failed_deletions = failed_deletions_;
+    IoService::Operation operation = [segment_name]() {
+      return File::Delete(segment_name.c_str());
+    };
+    IoService::CompletionCallback callback = [segment_name,
+                                              failed_deletions](bool success) {
+      if (success)
+        return;
+      LOG(WARNING) << "Failed to delete " << segment_name
                    << "; Will retry later.";
-      break;
+      base::AutoLock auto_lock(failed_deletions->lock);
+      failed_deletions->segment_names.push_back(segment_name);
+    };
+    if (io_operations_) {
+      io_operations_->Submit(segment_name, std::move(operation),
+                             std::move(callback));
+    } else {
+      IoService::GetInstance()->Submit(segment_name, std::move(operation),
+                                       std::move(callback));
     }
-    segments_to_be_removed_.pop_front();
   }
 }
 
@@ -7,12 +7,14 @@
 #ifndef PACKAGER_HLS_BASE_MEDIA_PLAYLIST_H_
 #define PACKAGER_HLS_BASE_MEDIA_PLAYLIST_H_
 
+#include <deque>
 #include <list>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "packager/base/macros.h"
+#include "packager/base/synchronization/lock.h"
 #include "packager/hls/public/hls_params.h"
 #include "packager/mpd/base/bandwidth_estimator.h"
 #include "packager/mpd/base/media_info.pb.h"
@@ -20,6 +22,7 @@
 namespace shaka {
 
 class File;
+class IoOperationGroup;
 
 namespace hls {
 
@@ -74,6 +77,14 @@ class MediaPlaylist {
                 const std::string& group_id);
   virtual ~MediaPlaylist();
 
+  /// Sets the group of the asynchronous deletions of the segments outside of
+  /// the live window, so that they can be waited for. They are submitted to
+  /// the process-wide IoService directly if it is not set.
+  /// @param io_operations must outlive the deletions. It can be NULL.
+  void set_io_operations(IoOperationGroup* io_operations) {
+    io_operations_ = io_operations;
+  }
+
   const std::string& file_name() const { return file_name_; }
   const std::string& name() const { return name_; }
   const std::string& group_id() const { return group_id_; }
@@ -162,6 +173,11 @@ class MediaPlaylist {
   /// @return true on success, false otherwise.
   virtual bool WriteToFile(const std::string& file_path);
 
+  /// Generate the playlist, as written by WriteToFile(). The same caveat on
+  /// target duration applies.
+  /// @return the content of the playlist.
+  virtual std::string ToString();
+
   /// If bitrate is specified in MediaInfo then it will use that value.
   /// Otherwise, returns the max bitrate.
   /// @return the max bitrate (in bits per second) of this MediaPlaylist.
@@ -234,6 +250,12 @@ class MediaPlaylist {
   // Remove elements from |entries_| for live profile. Increments
   // |sequence_number_| by the number of segments removed.
   void SlideWindow();
+  // Render the entries added since the previous call into
+  // |rendered_entries_|.
+  void RenderNewEntries();
+  // Drop the rendered text of the entry at |index| in |entries_| and of the
+  // entries after it, so that they are rendered again.
+  void DropRenderedEntries(size_t index);
   // Remove the segment specified by |start_time|. The actual deletion can
   // happen at a later time depending on the value of
   // |preserved_segment_outside_live_window| in |hls_params_|.
@@ -271,10 +293,27 @@ class MediaPlaylist {
   // TODO(kqyang): This could be managed better by a separate class, than having
   // all them managed in MediaPlaylist.
   std::list<std::unique_ptr<HlsEntry>> entries_;
+  // The first entries of |entries_| are rendered once and kept in
+  // |rendered_entries_|, starting at |rendered_entries_offset_|. The space
+  // before the offset is left by the entries removed by SlideWindow(), and is
+  // reclaimed when it gets larger than the rendered entries.
+  std::string rendered_entries_;
+  size_t rendered_entries_offset_ = 0;
+  // The size of the rendered text of each rendered entry, newline included.
+  std::deque<size_t> rendered_entry_sizes_;
   double current_buffer_depth_ = 0;
   // A list to hold the file names of the segments to be removed temporarily.
-  // Once a file is actually removed, it is removed from the list.
+  // Once a file is submitted for deletion, it is removed from the list.
   std::list<std::string> segments_to_be_removed_;
+  // The segments which failed to be deleted, to be put back in
+  // |segments_to_be_removed_|. Shared with the pending deletions, which may
+  // complete after this playlist is destroyed.
+  struct FailedDeletions {
+    base::Lock lock;
+    std::list<std::string> segment_names;
+  };
+  std::shared_ptr<FailedDeletions> failed_deletions_;
+  IoOperationGroup* io_operations_ = nullptr;
 
   // Used by kVideoIFrameOnly playlists to track the i-frames (key frames).
   struct KeyFrameInfo {
@@ -7,9 +7,13 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "packager/base/logging.h"
 #include "packager/base/strings/stringprintf.h"
+#include "packager/base/synchronization/lock.h"
+#include "packager/base/time/time.h"
 #include "packager/file/file.h"
 #include "packager/file/file_closer.h"
+#include "packager/file/io_service.h"
 #include "packager/file/file_test_util.h"
 #include "packager/hls/base/media_playlist.h"
 #include "packager/version/version.h"
@@ -20,6 +24,7 @@ namespace hls {
 using ::testing::_;
 using ::testing::ElementsAreArray;
 using ::testing::ReturnArg;
+using ::testing::UnorderedElementsAre;
 using ::testing::Values;
 using ::testing::WithParamInterface;
 
@@ -819,6 +824,61 @@ TEST_F(LiveMediaPlaylistTest, TimeShiftedWithEncryptionInfoShifted) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+// The rendered entries are kept across calls, so the output should not
+// depend on how often the playlist is generated.
+TEST_F(LiveMediaPlaylistTest, TimeShiftedGeneratedRepeatedly) {
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  for (int i = 0; i < 8; ++i) {
+    if (i % 3 == 1) {
+      const std::string iv = base::StringPrintf("0x%d2345678", i);
+      media_playlist_->AddEncryptionInfo(
+          MediaPlaylist::EncryptionMethod::kSampleAes, "http://example.com",
+          "", iv, "com.widevine", "1/2/4");
+      media_playlist_->AddEncryptionInfo(
+          MediaPlaylist::EncryptionMethod::kSampleAes, "http://mydomain.com",
+          "0xfedc", iv, "com.widevine.someother", "1");
+    }
+    media_playlist_->AddSegment(base::StringPrintf("file%d.ts", i),
+                                i * 10 * kTimeScale, 10 * kTimeScale,
+                                kZeroByteOffset, kMBytes);
+    media_playlist_->ToString();
+  }
+
+  const char kExpectedOutput[] =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:6\n"
+      "## Generated with https://github.com/google/shaka-packager version "
+      "test\n"
+      "#EXT-X-TARGETDURATION:10\n"
+      "#EXT-X-MEDIA-SEQUENCE:5\n"
+      "#EXT-X-DISCONTINUITY-SEQUENCE:1\n"
+      "#EXT-X-KEY:METHOD=SAMPLE-AES,"
+      "URI=\"http://example.com\",IV=0x42345678,KEYFORMATVERSIONS=\"1/2/4\","
+      "KEYFORMAT=\"com.widevine\"\n"
+      "#EXT-X-KEY:METHOD=SAMPLE-AES,"
+      "URI=\"http://mydomain.com\",KEYID=0xfedc,IV=0x42345678,"
+      "KEYFORMATVERSIONS=\"1\","
+      "KEYFORMAT=\"com.widevine.someother\"\n"
+      "#EXTINF:10.000,\n"
+      "file5.ts\n"
+      "#EXTINF:10.000,\n"
+      "file6.ts\n"
+      "#EXT-X-KEY:METHOD=SAMPLE-AES,"
+      "URI=\"http://example.com\",IV=0x72345678,KEYFORMATVERSIONS=\"1/2/4\","
+      "KEYFORMAT=\"com.widevine\"\n"
+      "#EXT-X-KEY:METHOD=SAMPLE-AES,"
+      "URI=\"http://mydomain.com\",KEYID=0xfedc,IV=0x72345678,"
+      "KEYFORMATVERSIONS=\"1\","
+      "KEYFORMAT=\"com.widevine.someother\"\n"
+      "#EXTINF:10.000,\n"
+      "file7.ts\n";
+
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+  EXPECT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
+}
+
 class EventMediaPlaylistTest : public MediaPlaylistMultiSegmentTest {
  protected:
   EventMediaPlaylistTest()
@@ -849,6 +909,31 @@ TEST_F(EventMediaPlaylistTest, Basic) {
   ASSERT_FILE_STREQ(kMemoryFilePath, kExpectedOutput);
 }
 
+// Run with --gtest_also_run_disabled_tests to measure writing a 24 hour EVENT
+// playlist of 2 second segments after each segment.
+TEST_F(EventMediaPlaylistTest, DISABLED_Benchmark24Hours) {
+  const int kNumSegments = 24 * 60 * 60 / 2;
+  const uint64_t kSegmentDuration = 2 * kTimeScale;
+  const char kMemoryFilePath[] = "memory://media.m3u8";
+
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kNumSegments; ++i) {
+    media_playlist_->AddSegment(base::StringPrintf("file%d.ts", i),
+                                i * kSegmentDuration, kSegmentDuration,
+                                kZeroByteOffset, kMBytes);
+    ASSERT_TRUE(media_playlist_->WriteToFile(kMemoryFilePath));
+  }
+  const base::TimeDelta time = base::TimeTicks::Now() - start;
+
+  std::string playlist;
+  ASSERT_TRUE(File::ReadFileToString(kMemoryFilePath, &playlist));
+  LOG(INFO) << kNumSegments << " segments written in "
+            << time.InMilliseconds() << " ms, final playlist is "
+            << playlist.size() << " bytes";
+}
+
 class IFrameMediaPlaylistTest : public MediaPlaylistTest {};
 
 TEST_F(IFrameMediaPlaylistTest, MediaPlaylistType) {
@@ -950,11 +1035,16 @@ TEST_F(IFrameMediaPlaylistTest, MultiSegmentWithPlacementOpportunity) {
   valid_video_media_info_.set_reference_time_scale(90000);
   valid_video_media_info_.set_segment_template_url("file$Number$.ts");
   ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+  // The target duration would otherwise be set by the first generation.
+  media_playlist_->SetTargetDuration(25);
 
   media_playlist_->AddKeyFrame(0, 1000, 2345);
   media_playlist_->AddKeyFrame(2 * kTimeScale, 5000, 6345);
   media_playlist_->AddSegment("file1.ts", 0, 10 * kTimeScale, kZeroByteOffset,
                               kMBytes);
+  // Generate the playlist before the duration of the last key frame in
+  // file1.ts is adjusted with the next key frame.
+  media_playlist_->ToString();
   media_playlist_->AddPlacementOpportunity();
   media_playlist_->AddKeyFrame(11 * kTimeScale, 1000, 2345);
   media_playlist_->AddKeyFrame(15 * kTimeScale, 3345, 12345);
@@ -1037,6 +1127,8 @@ class MediaPlaylistDeleteSegmentsTest
   }
 
   bool SegmentDeleted(const std::string& segment_name) {
+    // Segments are deleted asynchronously.
+    IoService::GetInstance()->Flush();
     std::unique_ptr<File, FileCloser> file_closer(
         File::Open(segment_name.c_str(), "r"));
     return file_closer.get() == nullptr;
@@ -1086,6 +1178,51 @@ INSTANTIATE_TEST_CASE_P(
     Values(std::make_pair(kSegmentTemplateNumber, kSegmentTemplateNumberUrl),
            std::make_pair(kSegmentTemplateTime, kSegmentTemplateTimeUrl)));
 
+TEST_F(LiveMediaPlaylistTest, RetriesFailedSegmentDeletions) {
+  // The segments are deleted through a callback, which fails the first
+  // deletion.
+  base::Lock lock;
+  bool fail_deletion = true;
+  std::vector<std::string> deleted_segments;
+  BufferCallbackParams callback_params;
+  callback_params.write_func = [&lock, &fail_deletion, &deleted_segments](
+                                   const std::string& name, const void* buffer,
+                                   uint64_t size) -> int64_t {
+    // A deletion is a write without a buffer.
+    EXPECT_FALSE(buffer);
+    base::AutoLock auto_lock(lock);
+    if (fail_deletion) {
+      fail_deletion = false;
+      return 0;
+    }
+    deleted_segments.push_back(name);
+    return 1;
+  };
+  valid_video_media_info_.set_segment_template(
+      File::MakeCallbackFileName(callback_params, "$Number$.mp4"));
+  valid_video_media_info_.set_segment_template_url(kSegmentTemplateNumberUrl);
+  ASSERT_TRUE(media_playlist_->SetMediaInfo(valid_video_media_info_));
+  mutable_hls_params()->preserved_segments_outside_live_window =
+      kNumPreservedSegmentsOutsideLiveWindow;
+  IoOperationGroup io_operations(IoService::GetInstance());
+  media_playlist_->set_io_operations(&io_operations);
+
+  // The first segment fails to be deleted.
+  for (int i = 0; i <= kMaxNumSegmentsAvailable; ++i) {
+    media_playlist_->AddSegment(kIgnoredSegmentName, i * kDuration, kDuration,
+                                kZeroByteOffset, kMBytes);
+  }
+  io_operations.Flush();
+  EXPECT_TRUE(deleted_segments.empty());
+
+  // It is deleted again with the next segment.
+  media_playlist_->AddSegment(kIgnoredSegmentName,
+                              (kMaxNumSegmentsAvailable + 1) * kDuration,
+                              kDuration, kZeroByteOffset, kMBytes);
+  io_operations.Flush();
+  EXPECT_THAT(deleted_segments, UnorderedElementsAre("1.mp4", "2.mp4"));
+}
+
 class MediaPlaylistCodecTest
     : public MediaPlaylistTest,
       public WithParamInterface<std::pair<std::string, std::string>> {};
@@ -43,6 +43,7 @@ class MockMediaPlaylist : public MediaPlaylist {
                     const std::string& key_format_versions));
   MOCK_METHOD0(AddPlacementOpportunity, void());
   MOCK_METHOD1(WriteToFile, bool(const std::string& file_path));
+  MOCK_METHOD0(ToString, std::string());
   MOCK_CONST_METHOD0(MaxBitrate, uint64_t());
   MOCK_CONST_METHOD0(AvgBitrate, uint64_t());
   MOCK_CONST_METHOD0(GetLongestSegmentDuration, double());
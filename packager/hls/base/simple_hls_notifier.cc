@@ -8,6 +8,7 @@
 
 #include <gflags/gflags.h>
 #include <cmath>
+#include <utility>
 
 #include "packager/base/base64.h"
 #include "packager/base/files/file_path.h"
@@ -15,6 +16,7 @@
 #include "packager/base/optional.h"
 #include "packager/base/strings/string_number_conversions.h"
 #include "packager/base/strings/stringprintf.h"
+#include "packager/file/file.h"
 #include "packager/hls/base/media_playlist.h"
 #include "packager/media/base/protection_system_ids.h"
 #include "packager/media/base/protection_system_specific_info.h"
@@ -251,17 +253,11 @@ bool HandleWidevineKeyFormats(
   return true;
 }
 
-bool WriteMediaPlaylist(const std::string& output_dir,
-                        MediaPlaylist* playlist) {
-  std::string file_path =
-      FilePath::FromUTF8Unsafe(output_dir)
-          .Append(FilePath::FromUTF8Unsafe(playlist->file_name()))
-          .AsUTF8Unsafe();
-  if (!playlist->WriteToFile(file_path)) {
-    LOG(ERROR) << "Failed to write playlist " << file_path;
-    return false;
-  }
-  return true;
+std::string GetMediaPlaylistPath(const std::string& output_dir,
+                                 const MediaPlaylist& playlist) {
+  return FilePath::FromUTF8Unsafe(output_dir)
+      .Append(FilePath::FromUTF8Unsafe(playlist.file_name()))
+      .AsUTF8Unsafe();
 }
 
 }  // namespace
@@ -291,6 +287,8 @@ SimpleHlsNotifier::SimpleHlsNotifier(const HlsParams& hls_params)
   master_playlist_.reset(
       new MasterPlaylist(master_playlist_path.BaseName().AsUTF8Unsafe(),
                          default_audio_langauge, default_text_language));
+  manifest_writer_.reset(new ManifestWriter(
+      std::bind(&SimpleHlsNotifier::WritePlaylists, this)));
 }
 
 SimpleHlsNotifier::~SimpleHlsNotifier() {}
@@ -312,6 +310,7 @@ bool SimpleHlsNotifier::NotifyNewStream(const MediaInfo& media_info,
   std::unique_ptr<MediaPlaylist> media_playlist =
       media_playlist_factory_->Create(hls_params(), relative_playlist_path,
                                       name, group_id);
+  media_playlist->set_io_operations(io_operations_);
   MediaInfo adjusted_media_info = MakeMediaInfoPathsRelativeToPlaylist(
       media_info, hls_params().base_url, master_playlist_dir_,
       media_playlist->file_name());
@@ -384,25 +383,20 @@ bool SimpleHlsNotifier::NotifyNewSegment(uint32_t stream_id,
     target_duration_updated = true;
   }
 
-  // Update the playlists when there is new segments in live mode.
+  // Update the playlists when there is new segments in live mode. The
+  // playlists are written asynchronously by |manifest_writer_|.
   if (hls_params().playlist_type == HlsPlaylistType::kLive ||
       hls_params().playlist_type == HlsPlaylistType::kEvent) {
     // Update all playlists if target duration is updated.
     if (target_duration_updated) {
       for (MediaPlaylist* playlist : media_playlists_) {
         playlist->SetTargetDuration(target_duration_);
-        if (!WriteMediaPlaylist(master_playlist_dir_, playlist))
-          return false;
+        dirty_playlists_.insert(playlist);
       }
     } else {
-      if (!WriteMediaPlaylist(master_playlist_dir_, media_playlist.get()))
-        return false;
-    }
-    if (!master_playlist_->WriteMasterPlaylist(
-            hls_params().base_url, master_playlist_dir_, media_playlists_)) {
-      LOG(ERROR) << "Failed to write master playlist.";
-      return false;
+      dirty_playlists_.insert(media_playlist.get());
     }
+    manifest_writer_->ScheduleWrite();
   }
   return true;
 }
@@ -497,12 +491,42 @@ bool SimpleHlsNotifier::NotifyEncryptionUpdate(
 }
 
 bool SimpleHlsNotifier::Flush() {
-  base::AutoLock auto_lock(lock_);
-  for (MediaPlaylist* playlist : media_playlists_) {
-    playlist->SetTargetDuration(target_duration_);
-    if (!WriteMediaPlaylist(master_playlist_dir_, playlist))
+  {
+    base::AutoLock auto_lock(lock_);
+    for (MediaPlaylist* playlist : media_playlists_) {
+      playlist->SetTargetDuration(target_duration_);
+      dirty_playlists_.insert(playlist);
+    }
+  }
+  return manifest_writer_->Flush();
+}
+
+bool SimpleHlsNotifier::WritePlaylists() {
+  // Generate the playlists with |lock_| held, but write them without it, so
+  // the muxer threads are not blocked on file I/O.
+  std::vector<std::pair<std::string, std::string>> playlists;
+  {
+    base::AutoLock auto_lock(lock_);
+    for (MediaPlaylist* playlist : media_playlists_) {
+      if (dirty_playlists_.find(playlist) == dirty_playlists_.end())
+        continue;
+      playlists.emplace_back(
+          GetMediaPlaylistPath(master_playlist_dir_, *playlist),
+          playlist->ToString());
+    }
+    dirty_playlists_.clear();
+  }
+
+  for (const auto& playlist : playlists) {
+    if (!File::WriteFileAtomically(playlist.first.c_str(), playlist.second)) {
+      LOG(ERROR) << "Failed to write playlist " << playlist.first;
       return false;
+    }
   }
+
+  // The master playlist is written after the media playlists it references.
+  // It is rarely updated, as it is written only if its content changes.
+  base::AutoLock auto_lock(lock_);
   if (!master_playlist_->WriteMasterPlaylist(
           hls_params().base_url, master_playlist_dir_, media_playlists_)) {
     LOG(ERROR) << "Failed to write master playlist.";
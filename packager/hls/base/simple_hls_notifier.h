@@ -10,6 +10,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -19,6 +20,7 @@
 #include "packager/hls/base/master_playlist.h"
 #include "packager/hls/base/media_playlist.h"
 #include "packager/hls/public/hls_params.h"
+#include "packager/mpd/base/manifest_writer.h"
 
 namespace shaka {
 namespace hls {
@@ -71,6 +73,13 @@ class SimpleHlsNotifier : public HlsNotifier {
   bool Flush() override;
   /// }@
 
+  /// Sets the group of the asynchronous file operations of the media
+  /// playlists, see MediaPlaylist::set_io_operations(). Must be called before
+  /// the streams are added.
+  void set_io_operations(IoOperationGroup* io_operations) {
+    io_operations_ = io_operations;
+  }
+
  private:
   friend class SimpleHlsNotifierTest;
 
@@ -79,10 +88,15 @@ class SimpleHlsNotifier : public HlsNotifier {
     MediaPlaylist::EncryptionMethod encryption_method;
   };
 
+  // Writes the media playlists updated since the last write, followed by the
+  // master playlist. Called by |manifest_writer_|.
+  bool WritePlaylists();
+
   std::string master_playlist_dir_;
   uint32_t target_duration_ = 0;
 
   std::unique_ptr<MediaPlaylistFactory> media_playlist_factory_;
+  IoOperationGroup* io_operations_ = nullptr;
   std::unique_ptr<MasterPlaylist> master_playlist_;
 
   // Maps to unique_ptr because StreamEntry also holds unique_ptr
@@ -91,8 +105,15 @@ class SimpleHlsNotifier : public HlsNotifier {
 
   uint32_t sequence_number_ = 0;
 
+  // Media playlists updated since they were last written.
+  std::set<MediaPlaylist*> dirty_playlists_;
+
   base::Lock lock_;
 
+  // Declared last so it is destroyed, and the pending write completed, before
+  // the playlists it writes.
+  std::unique_ptr<ManifestWriter> manifest_writer_;
+
   DISALLOW_COPY_AND_ASSIGN(SimpleHlsNotifier);
 };
 
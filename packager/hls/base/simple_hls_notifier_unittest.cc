@@ -12,6 +12,7 @@
 
 #include "packager/base/base64.h"
 #include "packager/base/files/file_path.h"
+#include "packager/file/file.h"
 #include "packager/hls/base/mock_media_playlist.h"
 #include "packager/hls/base/simple_hls_notifier.h"
 #include "packager/media/base/protection_system_ids.h"
@@ -75,7 +76,7 @@ class MockMediaPlaylistFactory : public MediaPlaylistFactory {
 
 const double kTestTimeShiftBufferDepth = 1800.0;
 const char kTestPrefix[] = "http://testprefix.com/";
-const char kAnyOutputDir[] = "anything";
+const char kAnyOutputDir[] = "memory://anything";
 
 const uint64_t kAnyStartTime = 10;
 const uint64_t kAnyDuration = 1000;
@@ -119,6 +120,25 @@ class SimpleHlsNotifierTest : public ::testing::Test {
     return notifier.stream_map_.size();
   }
 
+  // Run the playlist write scheduled asynchronously, if any, so the writes
+  // can be verified deterministically.
+  bool FlushScheduledWrite(SimpleHlsNotifier* notifier) {
+    return notifier->manifest_writer_->FlushScheduledWrite();
+  }
+
+  std::string GetPlaylistPath(const std::string& playlist_name) {
+    return base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
+        .Append(base::FilePath::FromUTF8Unsafe(playlist_name))
+        .AsUTF8Unsafe();
+  }
+
+  std::string ReadPlaylist(const std::string& playlist_name) {
+    std::string content;
+    const std::string playlist_path = GetPlaylistPath(playlist_name);
+    EXPECT_TRUE(File::ReadFileToString(playlist_path.c_str(), &content));
+    return content;
+  }
+
   uint32_t SetupStream(const std::string& protection_scheme,
                        MockMediaPlaylist* mock_media_playlist,
                        SimpleHlsNotifier* notifier) {
@@ -242,13 +262,10 @@ TEST_F(SimpleHlsNotifierTest, NotifyNewSegment) {
       .WillOnce(Return(true));
   EXPECT_CALL(*mock_media_playlist, SetTargetDuration(kTargetDuration))
       .Times(1);
-  EXPECT_CALL(*mock_media_playlist,
-              WriteToFile(StrEq(
-                  base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
-                      .Append(base::FilePath::FromUTF8Unsafe("playlist.m3u8"))
-                      .AsUTF8Unsafe())))
-      .WillOnce(Return(true));
+  EXPECT_CALL(*mock_media_playlist, ToString())
+      .WillOnce(Return("playlist content"));
   EXPECT_TRUE(notifier.Flush());
+  EXPECT_EQ("playlist content", ReadPlaylist("playlist.m3u8"));
 }
 
 TEST_F(SimpleHlsNotifierTest, NotifyKeyFrame) {
@@ -554,12 +571,8 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegment) {
       .WillOnce(Return(true));
   EXPECT_CALL(*mock_media_playlist, SetTargetDuration(kTargetDuration))
       .Times(1);
-  EXPECT_CALL(*mock_media_playlist,
-              WriteToFile(StrEq(
-                  base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
-                      .Append(base::FilePath::FromUTF8Unsafe("playlist.m3u8"))
-                      .AsUTF8Unsafe())))
-      .WillOnce(Return(true));
+  EXPECT_CALL(*mock_media_playlist, ToString())
+      .WillOnce(Return("live playlist content"));
 
   hls_params_.playlist_type = GetParam();
   SimpleHlsNotifier notifier(hls_params_);
@@ -573,6 +586,8 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegment) {
 
   EXPECT_TRUE(notifier.NotifyNewSegment(stream_id, segment_name, kStartTime,
                                         kDuration, 0, kSize));
+  EXPECT_TRUE(FlushScheduledWrite(&notifier));
+  EXPECT_EQ("live playlist content", ReadPlaylist("playlist.m3u8"));
 }
 
 TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
@@ -624,20 +639,12 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
   // SetTargetDuration and update all playlists as target duration is updated.
   EXPECT_CALL(*mock_media_playlist1, SetTargetDuration(kTargetDuration))
       .Times(1);
-  EXPECT_CALL(*mock_media_playlist1,
-              WriteToFile(StrEq(
-                  base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
-                      .Append(base::FilePath::FromUTF8Unsafe("playlist1.m3u8"))
-                      .AsUTF8Unsafe())))
-      .WillOnce(Return(true));
   EXPECT_CALL(*mock_media_playlist2, SetTargetDuration(kTargetDuration))
       .Times(1);
-  EXPECT_CALL(*mock_media_playlist2,
-              WriteToFile(StrEq(
-                  base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
-                      .Append(base::FilePath::FromUTF8Unsafe("playlist2.m3u8"))
-                      .AsUTF8Unsafe())))
-      .WillOnce(Return(true));
+  EXPECT_CALL(*mock_media_playlist1, ToString())
+      .WillOnce(Return("playlist1 content"));
+  EXPECT_CALL(*mock_media_playlist2, ToString())
+      .WillOnce(Return("playlist2 content"));
   EXPECT_CALL(
       *mock_master_playlist_ptr,
       WriteMasterPlaylist(
@@ -645,21 +652,69 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
       .WillOnce(Return(true));
   EXPECT_TRUE(notifier.NotifyNewSegment(stream_id1, "segment_name", kStartTime,
                                         kDuration, 0, kSize));
+  EXPECT_TRUE(FlushScheduledWrite(&notifier));
+  EXPECT_EQ("playlist1 content", ReadPlaylist("playlist1.m3u8"));
+  EXPECT_EQ("playlist2 content", ReadPlaylist("playlist2.m3u8"));
 
   EXPECT_CALL(*mock_media_playlist2, AddSegment(_, _, _, _, _)).Times(1);
   EXPECT_CALL(*mock_media_playlist2, GetLongestSegmentDuration())
       .WillOnce(Return(kLongestSegmentDuration));
   // Not updating other playlists as target duration does not change.
-  EXPECT_CALL(*mock_media_playlist2,
-              WriteToFile(StrEq(
-                  base::FilePath::FromUTF8Unsafe(kAnyOutputDir)
-                      .Append(base::FilePath::FromUTF8Unsafe("playlist2.m3u8"))
-                      .AsUTF8Unsafe())))
-      .WillOnce(Return(true));
+  EXPECT_CALL(*mock_media_playlist2, ToString())
+      .WillOnce(Return("updated playlist2 content"));
   EXPECT_CALL(*mock_master_playlist_ptr, WriteMasterPlaylist(_, _, _))
       .WillOnce(Return(true));
   EXPECT_TRUE(notifier.NotifyNewSegment(stream_id2, "segment_name", kStartTime,
                                         kDuration, 0, kSize));
+  EXPECT_TRUE(FlushScheduledWrite(&notifier));
+  EXPECT_EQ("playlist1 content", ReadPlaylist("playlist1.m3u8"));
+  EXPECT_EQ("updated playlist2 content", ReadPlaylist("playlist2.m3u8"));
+}
+
+TEST_P(LiveOrEventSimpleHlsNotifierTest, CoalesceSegmentUpdates) {
+  std::unique_ptr<MockMasterPlaylist> mock_master_playlist(
+      new MockMasterPlaylist());
+  std::unique_ptr<MockMediaPlaylistFactory> factory(
+      new MockMediaPlaylistFactory());
+
+  // Pointer released by SimpleHlsNotifier.
+  MockMediaPlaylist* mock_media_playlist =
+      new MockMediaPlaylist("playlist.m3u8", "", "");
+  EXPECT_CALL(*mock_media_playlist, SetMediaInfo(_)).WillOnce(Return(true));
+  EXPECT_CALL(*factory, CreateMock(_, _, _, _))
+      .WillOnce(Return(mock_media_playlist));
+
+  const int kNumSegments = 5;
+  EXPECT_CALL(*mock_media_playlist, AddSegment(_, _, _, _, _))
+      .Times(kNumSegments);
+  EXPECT_CALL(*mock_media_playlist, GetLongestSegmentDuration())
+      .WillRepeatedly(Return(10.0));
+  EXPECT_CALL(*mock_media_playlist, SetTargetDuration(10)).Times(1);
+  // Written at most once per segment, and at least once after the last one.
+  EXPECT_CALL(*mock_media_playlist, ToString())
+      .Times(::testing::Between(1, kNumSegments))
+      .WillRepeatedly(Return("playlist content"));
+  EXPECT_CALL(*mock_master_playlist, WriteMasterPlaylist(_, _, _))
+      .Times(::testing::Between(1, kNumSegments))
+      .WillRepeatedly(Return(true));
+
+  hls_params_.playlist_type = GetParam();
+  SimpleHlsNotifier notifier(hls_params_);
+  InjectMasterPlaylist(std::move(mock_master_playlist), &notifier);
+  InjectMediaPlaylistFactory(std::move(factory), &notifier);
+  EXPECT_TRUE(notifier.Init());
+  MediaInfo media_info;
+  uint32_t stream_id;
+  EXPECT_TRUE(notifier.NotifyNewStream(media_info, "playlist.m3u8", "name",
+                                       "groupid", &stream_id));
+
+  for (int i = 0; i < kNumSegments; ++i) {
+    EXPECT_TRUE(notifier.NotifyNewSegment(stream_id, "segment_name",
+                                          kAnyStartTime + i * kAnyDuration,
+                                          kAnyDuration, 0, kAnySize));
+  }
+  EXPECT_TRUE(FlushScheduledWrite(&notifier));
+  EXPECT_EQ("playlist content", ReadPlaylist("playlist.m3u8"));
 }
 
 INSTANTIATE_TEST_CASE_P(PlaylistTypes,
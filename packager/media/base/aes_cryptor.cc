@@ -67,6 +67,19 @@ bool AesCryptor::Crypt(const std::string& text, std::string* crypt_text) {
   return true;
 }
 
+bool AesCryptor::CryptChains(const std::vector<CryptChain>& chains) {
+  if (chains.empty())
+    return true;
+  if (!CryptChainsInternal(chains))
+    return false;
+  num_crypt_bytes_ = 0;
+  if (constant_iv_flag_ == kDontUseConstantIv) {
+    for (const CryptSegment& segment : chains.back())
+      num_crypt_bytes_ += segment.size;
+  }
+  return true;
+}
+
 bool AesCryptor::SetIv(const std::vector<uint8_t>& iv) {
   if (!IsIvSizeValid(iv.size())) {
     LOG(ERROR) << "Invalid IV size: " << iv.size();
@@ -98,15 +111,20 @@ void AesCryptor::UpdateIv() {
     increment = (num_crypt_bytes_ + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
   }
 
-  for (int i = iv_.size() - 1; increment > 0 && i >= 0; --i) {
-    increment += iv_[i];
-    iv_[i] = increment & 0xFF;
-    increment >>= 8;
-  }
+  IncrementIv(increment, &iv_);
   num_crypt_bytes_ = 0;
   SetIvInternal();
 }
 
+void AesCryptor::IncrementIv(uint64_t increment, std::vector<uint8_t>* iv) {
+  DCHECK(iv);
+  for (int i = iv->size() - 1; increment > 0 && i >= 0; --i) {
+    increment += (*iv)[i];
+    (*iv)[i] = increment & 0xFF;
+    increment >>= 8;
+  }
+}
+
 bool AesCryptor::GenerateRandomIv(FourCC protection_scheme,
                                   std::vector<uint8_t>* iv) {
   // ISO/IEC 23001-7:2016 10.1 and 10.3 For 'cenc' and 'cens'
@@ -126,6 +144,23 @@ bool AesCryptor::GenerateRandomIv(FourCC protection_scheme,
   return true;
 }
 
+bool AesCryptor::CryptChainsInternal(const std::vector<CryptChain>& chains) {
+  for (const CryptChain& chain : chains) {
+    SetIvInternal();
+    for (const CryptSegment& segment : chain) {
+      if (constant_iv_flag_ == kUseConstantIv)
+        SetIvInternal();
+      size_t crypt_text_size = segment.size;
+      if (!CryptInternal(segment.text, segment.size, segment.crypt_text,
+                         &crypt_text_size)) {
+        return false;
+      }
+      DCHECK_EQ(crypt_text_size, segment.size);
+    }
+  }
+  return true;
+}
+
 size_t AesCryptor::NumPaddingBytes(size_t size) const {
   // No padding by default.
   return 0;
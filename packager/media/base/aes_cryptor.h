@@ -68,6 +68,26 @@ class AesCryptor {
   }
   /// @}
 
+  /// A segment of text to be crypted, with the location of its crypted output,
+  /// which should have at least @a size bytes and can be the same as @a text.
+  struct CryptSegment {
+    const uint8_t* text;
+    size_t size;
+    uint8_t* crypt_text;
+  };
+  /// A sequence of segments crypted back to back.
+  typedef std::vector<CryptSegment> CryptChain;
+
+  /// Crypt several independent chains. Each chain is crypted as if SetIv(iv())
+  /// was called before it and Crypt() was then called on each of its segments
+  /// in order. As the chains do not depend on each other, implementations may
+  /// interleave them to keep the AES pipeline busy, e.g. the subsamples of a
+  /// sample with constant iv in cipher block chaining mode.
+  /// The cryptor is left in the state after crypting the last chain.
+  /// Cryptors which need padding, i.e. kPkcs5Padding, are not supported.
+  /// @return true on success, false otherwise.
+  bool CryptChains(const std::vector<CryptChain>& chains);
+
   /// Set IV. SetIv() implementation guarantees that the iv passed to SetIv()
   /// is set to iv() and then calls SetIvInternal().
   /// @return true if successful, false if the input is invalid.
@@ -78,6 +98,10 @@ class AesCryptor {
   /// This is used by encryptors only. It is a NOP if using kUseConstantIv.
   void UpdateIv();
 
+  /// Add @a increment to @a iv, as a big-endian integer that wraps around.
+  /// This is how UpdateIv() advances non-constant ivs.
+  static void IncrementIv(uint64_t increment, std::vector<uint8_t>* iv);
+
   /// @return The current iv.
   const std::vector<uint8_t>& iv() const { return iv_; }
 
@@ -95,6 +119,10 @@ class AesCryptor {
   const AES_KEY* aes_key() const { return aes_key_.get(); }
   AES_KEY* mutable_aes_key() { return aes_key_.get(); }
 
+  // Internal implementation of CryptChains. The default implementation
+  // crypts the chains one after another with CryptInternal.
+  virtual bool CryptChainsInternal(const std::vector<CryptChain>& chains);
+
  private:
   // Internal implementation of crypt function.
   // |text| points to the input text.
@@ -5,7 +5,9 @@
 // https://developers.google.com/open-source/licenses/bsd
 
 #include <gtest/gtest.h>
+#include <openssl/aes.h>
 
+#include <algorithm>
 #include <memory>
 
 #include "packager/base/logging.h"
@@ -197,6 +199,22 @@ TEST_F(AesCtrEncryptorTest, 64BitIvUpdate) {
   EXPECT_EQ(iv_one, encryptor_.iv());
 }
 
+TEST(AesCryptorTest, IncrementIv) {
+  std::vector<uint8_t> iv = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xFF};
+  AesCryptor::IncrementIv(0x0102, &iv);
+  EXPECT_EQ(std::vector<uint8_t>({0, 0, 0, 0, 0, 0, 0x03, 0x01}), iv);
+
+  // The carry propagates and wraps around.
+  iv = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE};
+  AesCryptor::IncrementIv(3, &iv);
+  EXPECT_EQ(std::vector<uint8_t>({0, 0, 0, 0, 0, 0, 0, 0x01}), iv);
+
+  // Increments wider than the iv are truncated.
+  iv = {0x00, 0x01};
+  AesCryptor::IncrementIv(0x10000, &iv);
+  EXPECT_EQ(std::vector<uint8_t>({0x00, 0x01}), iv);
+}
+
 TEST_F(AesCtrEncryptorTest, GenerateRandomIv) {
   const uint8_t kCencIvSize = 8;
   std::vector<uint8_t> iv;
@@ -266,6 +284,102 @@ INSTANTIATE_TEST_CASE_P(SubsampleTestCases,
                         AesCtrEncryptorSubsampleTest,
                         ::testing::ValuesIn(kSubsampleTestCases));
 
+namespace {
+
+// Straightforward byte-by-byte AES-CTR implementation as described in CENC
+// spec, used as the reference for the bulk implementation in AesCtrEncryptor.
+class ReferenceAesCtrCryptor {
+ public:
+  ReferenceAesCtrCryptor(const std::vector<uint8_t>& key,
+                         const std::vector<uint8_t>& iv)
+      : counter_(iv), encrypted_counter_(kAesBlockSize) {
+    counter_.resize(kAesBlockSize, 0);
+    CHECK_EQ(AES_set_encrypt_key(key.data(), key.size() * 8, &aes_key_), 0);
+  }
+
+  void Crypt(const uint8_t* text, size_t text_size, uint8_t* crypt_text) {
+    for (size_t i = 0; i < text_size; ++i) {
+      if (block_offset_ == 0) {
+        AES_encrypt(counter_.data(), encrypted_counter_.data(), &aes_key_);
+        // Only the least significant 8 bytes are incremented.
+        for (int j = kAesBlockSize - 1; j >= 8; --j) {
+          if (++counter_[j] != 0)
+            break;
+        }
+      }
+      crypt_text[i] = text[i] ^ encrypted_counter_[block_offset_];
+      block_offset_ = (block_offset_ + 1) % kAesBlockSize;
+    }
+  }
+
+ private:
+  AES_KEY aes_key_;
+  std::vector<uint8_t> counter_;
+  std::vector<uint8_t> encrypted_counter_;
+  uint32_t block_offset_ = 0;
+};
+
+const uint8_t kIv128Max64MinusTwo[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+                                       0x07, 0x08, 0xff, 0xff, 0xff, 0xff,
+                                       0xff, 0xff, 0xff, 0xfd};
+
+}  // namespace
+
+class AesCtrEncryptorReferenceTest
+    : public ::testing::TestWithParam<std::vector<uint8_t>> {};
+
+TEST_P(AesCtrEncryptorReferenceTest, MatchesReferenceImplementation) {
+  const std::vector<uint8_t> key(kAesKey, kAesKey + arraysize(kAesKey));
+  const std::vector<uint8_t>& iv = GetParam();
+
+  std::vector<uint8_t> plaintext(4096 + 7);
+  for (size_t i = 0; i < plaintext.size(); ++i)
+    plaintext[i] = static_cast<uint8_t>(i * 31 + 7);
+
+  // Split the text into subsamples of various sizes, so partial block state is
+  // carried across Crypt calls, both within and across the 64-bit wrap point.
+  const size_t kSubsampleSizes[] = {1, 15, 16, 17, 3, 64, 100, 255, 1000, 33};
+
+  ReferenceAesCtrCryptor reference(key, iv);
+  std::vector<uint8_t> expected(plaintext.size());
+  reference.Crypt(plaintext.data(), plaintext.size(), expected.data());
+
+  AesCtrEncryptor encryptor;
+  ASSERT_TRUE(encryptor.InitializeWithIv(key, iv));
+  std::vector<uint8_t> encrypted(plaintext.size());
+  size_t offset = 0;
+  for (size_t i = 0; offset < plaintext.size(); ++i) {
+    const size_t size =
+        std::min(kSubsampleSizes[i % arraysize(kSubsampleSizes)],
+                 plaintext.size() - offset);
+    ASSERT_TRUE(
+        encryptor.Crypt(&plaintext[offset], size, &encrypted[offset]));
+    offset += size;
+    EXPECT_EQ(offset % kAesBlockSize, encryptor.block_offset());
+  }
+  EXPECT_EQ(expected, encrypted);
+
+  // In place, in a single call.
+  ASSERT_TRUE(encryptor.SetIv(iv));
+  std::vector<uint8_t> buffer = plaintext;
+  ASSERT_TRUE(encryptor.Crypt(buffer.data(), buffer.size(), buffer.data()));
+  EXPECT_EQ(expected, buffer);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ReferenceTestCases,
+    AesCtrEncryptorReferenceTest,
+    ::testing::Values(
+        std::vector<uint8_t>(kAesIv, kAesIv + arraysize(kAesIv)),
+        std::vector<uint8_t>(kIv128Zero, kIv128Zero + arraysize(kIv128Zero)),
+        std::vector<uint8_t>(kIv128Max64, kIv128Max64 + arraysize(kIv128Max64)),
+        std::vector<uint8_t>(kIv128Max64MinusTwo,
+                             kIv128Max64MinusTwo +
+                                 arraysize(kIv128Max64MinusTwo)),
+        std::vector<uint8_t>(kIv128MaxMinusOne,
+                             kIv128MaxMinusOne + arraysize(kIv128MaxMinusOne)),
+        std::vector<uint8_t>(kIv64Max, kIv64Max + arraysize(kIv64Max))));
+
 struct IvTestCase {
   const uint8_t* iv_test;
   uint32_t iv_size;
@@ -533,6 +647,94 @@ TEST_F(AesCbcTest, NoPaddingChainAcrossCalls) {
   EXPECT_EQ(plaintext, decrypted);
 }
 
+namespace {
+
+// Builds chains of segments with various sizes from |text|, with output to
+// |crypt_text|. Returns the chains.
+std::vector<AesCryptor::CryptChain> BuildCryptChains(
+    const std::vector<uint8_t>& text,
+    std::vector<uint8_t>* crypt_text) {
+  // Chains with segments of various sizes, including residual blocks and
+  // segments without any full block.
+  const std::vector<std::vector<size_t>> kChainSegmentSizes = {
+      {160, 16, 33},  {5},       {},          {48, 7, 64},  {1024},
+      {17, 17, 17},   {256, 32}, {15, 16},    {512, 512},   {31},
+      {80, 16, 16, 4}, {640},    {16, 16, 16}};
+  crypt_text->resize(text.size());
+  std::vector<AesCryptor::CryptChain> chains;
+  size_t offset = 0;
+  for (const std::vector<size_t>& segment_sizes : kChainSegmentSizes) {
+    chains.emplace_back();
+    for (size_t segment_size : segment_sizes) {
+      CHECK_LE(offset + segment_size, text.size());
+      chains.back().push_back(
+          {&text[offset], segment_size, &(*crypt_text)[offset]});
+      offset += segment_size;
+    }
+  }
+  return chains;
+}
+
+}  // namespace
+
+TEST_F(AesCbcTest, CryptChainsMatchesCrypt) {
+  std::vector<uint8_t> plaintext(8192);
+  for (size_t i = 0; i < plaintext.size(); ++i)
+    plaintext[i] = static_cast<uint8_t>(i * 7 + 3);
+
+  for (AesCryptor::ConstantIvFlag constant_iv_flag :
+       {AesCryptor::kUseConstantIv, AesCryptor::kDontUseConstantIv}) {
+    AesCbcEncryptor encryptor(kNoPadding, constant_iv_flag);
+    ASSERT_TRUE(encryptor.InitializeWithIv(key_, iv_));
+    std::vector<uint8_t> encrypted;
+    const std::vector<AesCryptor::CryptChain> chains =
+        BuildCryptChains(plaintext, &encrypted);
+    ASSERT_TRUE(encryptor.CryptChains(chains));
+
+    AesCbcEncryptor expected_encryptor(kNoPadding, constant_iv_flag);
+    ASSERT_TRUE(expected_encryptor.InitializeWithIv(key_, iv_));
+    std::vector<uint8_t> expected;
+    const std::vector<AesCryptor::CryptChain> expected_chains =
+        BuildCryptChains(plaintext, &expected);
+    for (const AesCryptor::CryptChain& chain : expected_chains) {
+      ASSERT_TRUE(expected_encryptor.SetIv(iv_));
+      for (const AesCryptor::CryptSegment& segment : chain) {
+        ASSERT_TRUE(expected_encryptor.Crypt(segment.text, segment.size,
+                                             segment.crypt_text));
+      }
+    }
+    EXPECT_EQ(expected, encrypted);
+
+    // The chain continues from the end of the last chain.
+    std::vector<uint8_t> next_encrypted;
+    ASSERT_TRUE(encryptor.Crypt(plaintext, &next_encrypted));
+    std::vector<uint8_t> next_expected;
+    ASSERT_TRUE(expected_encryptor.Crypt(plaintext, &next_expected));
+    EXPECT_EQ(next_expected, next_encrypted);
+  }
+}
+
+TEST_F(AesCbcTest, CryptChainsInPlace) {
+  std::vector<uint8_t> plaintext(8192);
+  for (size_t i = 0; i < plaintext.size(); ++i)
+    plaintext[i] = static_cast<uint8_t>(i * 11 + 5);
+
+  AesCbcEncryptor encryptor(kNoPadding, AesCryptor::kUseConstantIv);
+  ASSERT_TRUE(encryptor.InitializeWithIv(key_, iv_));
+  std::vector<uint8_t> expected;
+  ASSERT_TRUE(encryptor.CryptChains(BuildCryptChains(plaintext, &expected)));
+
+  std::vector<uint8_t> buffer = plaintext;
+  std::vector<AesCryptor::CryptChain> chains =
+      BuildCryptChains(plaintext, &buffer);
+  for (AesCryptor::CryptChain& chain : chains) {
+    for (AesCryptor::CryptSegment& segment : chain)
+      segment.text = segment.crypt_text;
+  }
+  ASSERT_TRUE(encryptor.CryptChains(chains));
+  EXPECT_EQ(expected, buffer);
+}
+
 TEST_F(AesCbcTest, UnsupportedKeySize) {
   EXPECT_FALSE(encryptor_->InitializeWithIv(std::vector<uint8_t>(15, 0), iv_));
   EXPECT_FALSE(decryptor_->InitializeWithIv(std::vector<uint8_t>(15, 0), iv_));
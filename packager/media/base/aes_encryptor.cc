@@ -8,18 +8,121 @@
 
 #include <openssl/aes.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "packager/base/logging.h"
 
 namespace {
 
-// Increment an 8-byte counter by 1. Return true if overflowed.
-bool Increment64(uint8_t* counter) {
+// Return the number of blocks that can be processed using an 8-byte big-endian
+// |counter| before it wraps around, or 0 if it cannot wrap around for any
+// buffer that fits in memory.
+uint64_t NumBlocksBeforeWrap64(const uint8_t* counter) {
   DCHECK(counter);
-  for (int i = 7; i >= 0; --i) {
-    if (++counter[i] != 0)
-      return false;
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i)
+    value = (value << 8) | counter[i];
+  // 2^64 - value, which is 0 if |value| is 0.
+  return 0 - value;
+}
+
+// Maximum number of independent cipher block chains encrypted together.
+const size_t kMaxInterleavedChains = 8;
+
+// Tracks the progress of a cipher block chain in AesCbcEncryptChains.
+struct CbcChainState {
+  const shaka::media::AesCryptor::CryptChain* chain = nullptr;
+  size_t segment_index = 0;
+  size_t segment_offset = 0;
+  uint8_t iv[AES_BLOCK_SIZE];
+};
+
+// Advance |state| to the next full block to be encrypted, copying the
+// unencrypted residual bytes of the segments passed over. Return false if
+// there is no more block to encrypt in the chain.
+bool SeekNextCbcBlock(CbcChainState* state) {
+  while (state->segment_index < state->chain->size()) {
+    const shaka::media::AesCryptor::CryptSegment& segment =
+        (*state->chain)[state->segment_index];
+    if (segment.size - state->segment_offset >= AES_BLOCK_SIZE)
+      return true;
+    // The residual block is left unencrypted. There is nothing to copy when
+    // encrypting in place.
+    if (segment.crypt_text != segment.text) {
+      memcpy(segment.crypt_text + state->segment_offset,
+             segment.text + state->segment_offset,
+             segment.size - state->segment_offset);
+    }
+    ++state->segment_index;
+    state->segment_offset = 0;
+  }
+  return false;
+}
+
+// Encrypt |chains| with AES-CBC without padding, each chain starting from
+// |iv|. CBC is sequential within a chain, so a single chain cannot make use of
+// the pipelining of the AES units. Blocks from up to kMaxInterleavedChains
+// chains are encrypted in turn instead, so the encryption of one block
+// overlaps the encryption of the blocks from the other chains.
+// |last_iv| is set to the chaining value at the end of the last chain.
+void AesCbcEncryptChains(
+    const AES_KEY* aes_key,
+    const uint8_t* iv,
+    const std::vector<shaka::media::AesCryptor::CryptChain>& chains,
+    uint8_t* last_iv) {
+  // |last_iv| may point to the same location as |iv|.
+  uint8_t initial_iv[AES_BLOCK_SIZE];
+  memcpy(initial_iv, iv, AES_BLOCK_SIZE);
+
+  CbcChainState states[kMaxInterleavedChains];
+  size_t num_active_chains = 0;
+  size_t next_chain = 0;
+
+  while (true) {
+    // Fill up the lanes with pending chains.
+    while (num_active_chains < kMaxInterleavedChains &&
+           next_chain < chains.size()) {
+      CbcChainState* state = &states[num_active_chains];
+      state->chain = &chains[next_chain];
+      state->segment_index = 0;
+      state->segment_offset = 0;
+      memcpy(state->iv, initial_iv, AES_BLOCK_SIZE);
+      if (SeekNextCbcBlock(state))
+        ++num_active_chains;
+      else if (next_chain == chains.size() - 1)
+        memcpy(last_iv, initial_iv, AES_BLOCK_SIZE);
+      ++next_chain;
+    }
+    if (num_active_chains == 0)
+      break;
+
+    // Encrypt one block from every active chain.
+    uint8_t block[AES_BLOCK_SIZE];
+    for (size_t i = 0; i < num_active_chains; ++i) {
+      CbcChainState* state = &states[i];
+      const shaka::media::AesCryptor::CryptSegment& segment =
+          (*state->chain)[state->segment_index];
+      const uint8_t* text = segment.text + state->segment_offset;
+      uint8_t* crypt_text = segment.crypt_text + state->segment_offset;
+      for (size_t j = 0; j < AES_BLOCK_SIZE; ++j)
+        block[j] = text[j] ^ state->iv[j];
+      AES_encrypt(block, crypt_text, aes_key);
+      memcpy(state->iv, crypt_text, AES_BLOCK_SIZE);
+      state->segment_offset += AES_BLOCK_SIZE;
+    }
+
+    // Retire the chains which are done, compacting the active lanes.
+    for (size_t i = 0; i < num_active_chains;) {
+      if (SeekNextCbcBlock(&states[i])) {
+        ++i;
+        continue;
+      }
+      if (states[i].chain == &chains.back())
+        memcpy(last_iv, states[i].iv, AES_BLOCK_SIZE);
+      states[i] = states[--num_active_chains];
+    }
   }
-  return true;
 }
 
 // AES defines three key sizes: 128, 192 and 256 bits.
@@ -74,18 +177,40 @@ bool AesCtrEncryptor::CryptInternal(const uint8_t* plaintext,
   }
   *ciphertext_size = plaintext_size;
 
-  for (size_t i = 0; i < plaintext_size; ++i) {
-    if (block_offset_ == 0) {
-      AES_encrypt(&counter_[0], &encrypted_counter_[0], aes_key());
-      // As mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte counter
-      // block, bytes 8 to 15 (i.e. the least significant bytes) are used as a
-      // simple 64 bit unsigned integer that is incremented by one for each
-      // subsequent block of sample data processed and is kept in network byte
-      // order.
-      Increment64(&counter_[8]);
+  // AES_ctr128_encrypt generates and encrypts counter blocks in bulk (using
+  // the pipelined hardware implementation if available) and keeps the partial
+  // block state in |block_offset_| and |encrypted_counter_| across calls.
+  // It treats the whole 16-byte counter block as a 128-bit integer though. As
+  // mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte counter block,
+  // bytes 8 to 15 (i.e. the least significant bytes) are used as a simple 64
+  // bit unsigned integer that is incremented by one for each subsequent block
+  // of sample data processed and is kept in network byte order. So the input
+  // is split where the 64-bit counter wraps around, and the carry into bytes 0
+  // to 7 is discarded.
+  uint8_t counter_high[8];
+  memcpy(counter_high, &counter_[0], sizeof(counter_high));
+  while (plaintext_size > 0) {
+    size_t chunk_size = plaintext_size;
+    const uint64_t num_blocks = NumBlocksBeforeWrap64(&counter_[8]);
+    const size_t kMaxNumBlocks =
+        (std::numeric_limits<size_t>::max() - AES_BLOCK_SIZE) / AES_BLOCK_SIZE;
+    if (num_blocks != 0 && num_blocks <= kMaxNumBlocks) {
+      const size_t partial_block_remaining =
+          (AES_BLOCK_SIZE - block_offset_) % AES_BLOCK_SIZE;
+      chunk_size = std::min(
+          chunk_size, partial_block_remaining +
+                          static_cast<size_t>(num_blocks) * AES_BLOCK_SIZE);
     }
-    ciphertext[i] = plaintext[i] ^ encrypted_counter_[block_offset_];
-    block_offset_ = (block_offset_ + 1) % AES_BLOCK_SIZE;
+
+    unsigned int block_offset = block_offset_;
+    AES_ctr128_encrypt(plaintext, ciphertext, chunk_size, aes_key(),
+                       &counter_[0], &encrypted_counter_[0], &block_offset);
+    block_offset_ = block_offset;
+    memcpy(&counter_[0], counter_high, sizeof(counter_high));
+
+    plaintext += chunk_size;
+    ciphertext += chunk_size;
+    plaintext_size -= chunk_size;
   }
   return true;
 }
@@ -189,6 +314,31 @@ void AesCbcEncryptor::SetIvInternal() {
   internal_iv_.resize(AES_BLOCK_SIZE, 0);
 }
 
+bool AesCbcEncryptor::CryptChainsInternal(
+    const std::vector<CryptChain>& chains) {
+  if (padding_scheme_ != kNoPadding)
+    return AesEncryptor::CryptChainsInternal(chains);
+  DCHECK(aes_key());
+
+  SetIvInternal();
+  if (!use_constant_iv()) {
+    AesCbcEncryptChains(aes_key(), internal_iv_.data(), chains,
+                        internal_iv_.data());
+    return true;
+  }
+
+  // With constant iv, every Crypt call, i.e. every segment, starts a new
+  // chain.
+  std::vector<CryptChain> segment_chains;
+  for (const CryptChain& chain : chains) {
+    for (const CryptSegment& segment : chain)
+      segment_chains.push_back(CryptChain(1, segment));
+  }
+  AesCbcEncryptChains(aes_key(), internal_iv_.data(), segment_chains,
+                      internal_iv_.data());
+  return true;
+}
+
 size_t AesCbcEncryptor::NumPaddingBytes(size_t size) const {
   return (padding_scheme_ == kPkcs5Padding)
              ? (AES_BLOCK_SIZE - (size % AES_BLOCK_SIZE))
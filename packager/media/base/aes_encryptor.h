@@ -100,6 +100,7 @@ class AesCbcEncryptor : public AesEncryptor {
                      uint8_t* ciphertext,
                      size_t* ciphertext_size) override;
   void SetIvInternal() override;
+  bool CryptChainsInternal(const std::vector<CryptChain>& chains) override;
   size_t NumPaddingBytes(size_t size) const override;
 
   const CbcPaddingScheme padding_scheme_;
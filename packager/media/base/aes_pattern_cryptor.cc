@@ -49,6 +49,39 @@ bool AesPatternCryptor::CryptInternal(const uint8_t* text,
   }
   *crypt_text_size = text_size;
 
+  CryptChain crypt_chain;
+  ApplyPattern(text, text_size, crypt_text, &crypt_chain);
+  for (const CryptSegment& segment : crypt_chain) {
+    if (!cryptor_->Crypt(segment.text, segment.size, segment.crypt_text))
+      return false;
+  }
+  return true;
+}
+
+bool AesPatternCryptor::CryptChainsInternal(
+    const std::vector<CryptChain>& chains) {
+  if (!use_constant_iv())
+    return AesCryptor::CryptChainsInternal(chains);
+
+  // With constant iv, every Crypt call, i.e. every segment, restarts the
+  // underlying cryptor from iv(), so the encrypted blocks of each segment form
+  // an independent chain.
+  std::vector<CryptChain> crypt_chains;
+  for (const CryptChain& chain : chains) {
+    for (const CryptSegment& segment : chain) {
+      crypt_chains.emplace_back();
+      ApplyPattern(segment.text, segment.size, segment.crypt_text,
+                   &crypt_chains.back());
+    }
+  }
+  SetIvInternal();
+  return cryptor_->CryptChains(crypt_chains);
+}
+
+void AesPatternCryptor::ApplyPattern(const uint8_t* text,
+                                     size_t text_size,
+                                     uint8_t* crypt_text,
+                                     CryptChain* crypt_chain) {
   while (text_size > 0) {
     const size_t crypt_byte_size = crypt_byte_block_ * AES_BLOCK_SIZE;
 
@@ -61,8 +94,7 @@ bool AesPatternCryptor::CryptInternal(const uint8_t* text,
         // remains unencrypted.
         const size_t aligned_crypt_byte_size =
             text_size / AES_BLOCK_SIZE * AES_BLOCK_SIZE;
-        if (!cryptor_->Crypt(text, aligned_crypt_byte_size, crypt_text))
-          return false;
+        crypt_chain->push_back({text, aligned_crypt_byte_size, crypt_text});
         text += aligned_crypt_byte_size;
         text_size -= aligned_crypt_byte_size;
         crypt_text += aligned_crypt_byte_size;
@@ -70,11 +102,10 @@ bool AesPatternCryptor::CryptInternal(const uint8_t* text,
 
       // The remaining bytes are not encrypted.
       memcpy(crypt_text, text, text_size);
-      return true;
+      return;
     }
 
-    if (!cryptor_->Crypt(text, crypt_byte_size, crypt_text))
-      return false;
+    crypt_chain->push_back({text, crypt_byte_size, crypt_text});
     text += crypt_byte_size;
     text_size -= crypt_byte_size;
     crypt_text += crypt_byte_size;
@@ -86,7 +117,6 @@ bool AesPatternCryptor::CryptInternal(const uint8_t* text,
     text_size -= skip_byte_size;
     crypt_text += skip_byte_size;
   }
-  return true;
 }
 
 void AesPatternCryptor::SetIvInternal() {
@@ -67,6 +67,14 @@ class AesPatternCryptor : public AesCryptor {
                      uint8_t* crypt_text,
                      size_t* crypt_text_size) override;
   void SetIvInternal() override;
+  bool CryptChainsInternal(const std::vector<CryptChain>& chains) override;
+
+  // Copies the unencrypted bytes of |text| to |crypt_text| according to the
+  // pattern and appends the segments to be encrypted to |crypt_chain|.
+  void ApplyPattern(const uint8_t* text,
+                    size_t text_size,
+                    uint8_t* crypt_text,
+                    CryptChain* crypt_chain);
 
   uint8_t crypt_byte_block_;
   const uint8_t skip_byte_block_;
@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 
 #include "packager/base/strings/string_number_conversions.h"
+#include "packager/media/base/aes_encryptor.h"
 #include "packager/media/base/aes_pattern_cryptor.h"
 #include "packager/media/base/mock_aes_cryptor.h"
 
@@ -208,5 +209,39 @@ TEST(SampleAesPatternCryptor, MoreThan16Bytes) {
   ASSERT_TRUE(pattern_cryptor.Crypt("0123456789abcdef012", &crypt_text));
 }
 
+TEST(AesPatternCryptorCryptChainsTest, MatchesCrypt) {
+  const std::vector<uint8_t> key(16, 'k');
+  const std::vector<uint8_t> iv(16, 'i');
+  std::vector<uint8_t> text(4096);
+  for (size_t i = 0; i < text.size(); ++i)
+    text[i] = static_cast<uint8_t>(i * 13 + 1);
+  const size_t kSegmentSizes[] = {1024, 15, 16, 17, 160, 161, 500, 33, 2170};
+
+  for (AesPatternCryptor::PatternEncryptionMode encryption_mode :
+       {AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+        AesPatternCryptor::kSkipIfCryptByteBlockRemaining}) {
+    AesPatternCryptor pattern_cryptor(
+        1, 9, encryption_mode, AesCryptor::kUseConstantIv,
+        std::unique_ptr<AesCryptor>(new AesCbcEncryptor(kNoPadding)));
+    ASSERT_TRUE(pattern_cryptor.InitializeWithIv(key, iv));
+
+    std::vector<uint8_t> expected(text.size());
+    std::vector<uint8_t> encrypted(text.size());
+    AesCryptor::CryptChain chain;
+    size_t offset = 0;
+    for (size_t segment_size : kSegmentSizes) {
+      ASSERT_TRUE(pattern_cryptor.Crypt(&text[offset], segment_size,
+                                        &expected[offset]));
+      chain.push_back({&text[offset], segment_size, &encrypted[offset]});
+      offset += segment_size;
+    }
+    ASSERT_EQ(text.size(), offset);
+
+    ASSERT_TRUE(pattern_cryptor.CryptChains(
+        std::vector<AesCryptor::CryptChain>(1, chain)));
+    EXPECT_EQ(expected, encrypted);
+  }
+}
+
 }  // namespace media
 }  // namespace shaka
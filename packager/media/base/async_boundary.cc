@@ -0,0 +1,137 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/async_boundary.h"
+
+#include <algorithm>
+
+#include "packager/base/logging.h"
+
+namespace shaka {
+namespace media {
+
+AsyncBoundary::AsyncBoundary(size_t queue_size)
+    : slots_(queue_size),
+      slot_freed_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                  base::WaitableEvent::InitialState::NOT_SIGNALED),
+      slot_filled_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                   base::WaitableEvent::InitialState::NOT_SIGNALED),
+      flush_done_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                  base::WaitableEvent::InitialState::NOT_SIGNALED) {
+  DCHECK_GT(queue_size, 0u);
+}
+
+AsyncBoundary::~AsyncBoundary() {
+  if (thread_) {
+    stopped_ = true;
+    slot_filled_.Signal();
+    thread_->Join();
+  }
+  if (num_queued_ > 0) {
+    VLOG(1) << "AsyncBoundary queue depth: max " << max_queue_depth()
+            << ", average " << average_queue_depth() << " of " << slots_.size()
+            << ".";
+  }
+}
+
+Status AsyncBoundary::InitializeInternal() {
+  if (num_input_streams() != 1 || next_output_stream_index() != 1) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Expects exactly one input and one output.");
+  }
+  thread_.reset(new base::DelegateSimpleThread(this, "AsyncBoundary"));
+  thread_->Start();
+  return Status::OK;
+}
+
+Status AsyncBoundary::Process(std::unique_ptr<StreamData> stream_data) {
+  DCHECK(stream_data);
+  if (downstream_failed_)
+    return downstream_status();
+  Push(std::move(stream_data));
+  return Status::OK;
+}
+
+Status AsyncBoundary::OnFlushRequest(size_t input_stream_index) {
+  DCHECK_EQ(input_stream_index, 0u);
+  // A null stream data requests the downstream thread to flush.
+  Push(nullptr);
+  flush_done_.Wait();
+  return downstream_status();
+}
+
+void AsyncBoundary::Run() {
+  std::unique_ptr<StreamData> stream_data;
+  while (Pop(&stream_data)) {
+    const bool is_flush_request = !stream_data;
+    if (!downstream_failed_) {
+      Status status = is_flush_request ? FlushDownstream(0)
+                                       : Dispatch(std::move(stream_data));
+      if (!status.ok()) {
+        base::AutoLock auto_lock(lock_);
+        downstream_status_ = status;
+        downstream_failed_ = true;
+      }
+    }
+    stream_data.reset();
+    if (is_flush_request)
+      flush_done_.Signal();
+  }
+}
+
+void AsyncBoundary::Push(std::unique_ptr<StreamData> stream_data) {
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  while (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+    // Check again after announcing the wait, as the downstream thread may have
+    // freed a slot without noticing it.
+    upstream_waiting_ = true;
+    if (tail - head_.load() < slots_.size()) {
+      upstream_waiting_ = false;
+      break;
+    }
+    slot_freed_.Wait();
+  }
+
+  const size_t queue_depth = tail - head_.load(std::memory_order_relaxed) + 1;
+  max_queue_depth_ = std::max(max_queue_depth_, queue_depth);
+  total_queue_depth_ += queue_depth;
+  ++num_queued_;
+
+  slots_[tail % slots_.size()] = std::move(stream_data);
+  tail_.store(tail + 1);
+  if (downstream_waiting_.exchange(false))
+    slot_filled_.Signal();
+}
+
+bool AsyncBoundary::Pop(std::unique_ptr<StreamData>* stream_data) {
+  const size_t head = head_.load(std::memory_order_relaxed);
+  while (tail_.load(std::memory_order_acquire) == head) {
+    // Check again after announcing the wait, as the upstream thread may have
+    // filled a slot without noticing it.
+    downstream_waiting_ = true;
+    if (tail_.load() != head) {
+      downstream_waiting_ = false;
+      break;
+    }
+    if (stopped_)
+      return false;
+    slot_filled_.Wait();
+  }
+
+  *stream_data = std::move(slots_[head % slots_.size()]);
+  head_.store(head + 1);
+  if (upstream_waiting_.exchange(false))
+    slot_freed_.Signal();
+  return true;
+}
+
+Status AsyncBoundary::downstream_status() {
+  base::AutoLock auto_lock(lock_);
+  return downstream_status_;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,110 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_ASYNC_BOUNDARY_H_
+#define PACKAGER_MEDIA_BASE_ASYNC_BOUNDARY_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "packager/base/synchronization/lock.h"
+#include "packager/base/synchronization/waitable_event.h"
+#include "packager/base/threading/simple_thread.h"
+#include "packager/media/base/media_handler.h"
+
+namespace shaka {
+namespace media {
+
+/// AsyncBoundary splits a chain of media handlers into two pipeline stages
+/// running on different threads. Stream data is handed over through a bounded
+/// lock-free single-producer single-consumer queue to a dedicated thread, which
+/// dispatches it to the downstream handlers, so the upstream handlers can
+/// process the next stream data in the meantime. Upstream blocks while the
+/// queue is full.
+/// Flush requests wait for the queued stream data to be processed and return
+/// the status of the downstream handlers. An error from the downstream handlers
+/// is returned to upstream on the next call, after which the remaining stream
+/// data is dropped.
+/// Only supports single input single output.
+class AsyncBoundary : public MediaHandler,
+                      public base::DelegateSimpleThread::Delegate {
+ public:
+  /// @param queue_size is the maximum number of stream data queued.
+  explicit AsyncBoundary(size_t queue_size);
+  ~AsyncBoundary() override;
+
+  /// @return The maximum number of stream data queued, sampled when stream
+  ///         data is queued.
+  size_t max_queue_depth() const { return max_queue_depth_; }
+  /// @return The average number of stream data queued, sampled when stream
+  ///         data is queued.
+  double average_queue_depth() const {
+    return num_queued_ == 0 ? 0
+                            : static_cast<double>(total_queue_depth_) /
+                                  num_queued_;
+  }
+
+ protected:
+  /// @name MediaHandler implementation overrides.
+  /// @{
+  Status InitializeInternal() override;
+  Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
+  /// @}
+
+ private:
+  AsyncBoundary(const AsyncBoundary&) = delete;
+  AsyncBoundary& operator=(const AsyncBoundary&) = delete;
+
+  // base::DelegateSimpleThread::Delegate implementation. Dispatches the queued
+  // stream data to the downstream handlers until stopped.
+  void Run() override;
+
+  // Queue |stream_data|, or a flush request if it is null. Called on the
+  // upstream thread only. Blocks while the queue is full.
+  void Push(std::unique_ptr<StreamData> stream_data);
+  // Dequeue into |stream_data|. Called on the downstream thread only. Blocks
+  // while the queue is empty.
+  // @return false if the queue is empty and the boundary is stopped.
+  bool Pop(std::unique_ptr<StreamData>* stream_data);
+
+  Status downstream_status();
+
+  // The slots of the ring buffer. A slot is owned by the upstream thread when
+  // it is free and by the downstream thread when it is filled.
+  std::vector<std::unique_ptr<StreamData>> slots_;
+  // |head_| is only advanced by the downstream thread and |tail_| only by the
+  // upstream thread. The number of queued stream data is |tail_| - |head_|.
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+
+  // Set by a thread before it sleeps waiting for the other one, which wakes it
+  // up after advancing its index.
+  std::atomic<bool> upstream_waiting_{false};
+  std::atomic<bool> downstream_waiting_{false};
+  base::WaitableEvent slot_freed_;
+  base::WaitableEvent slot_filled_;
+  base::WaitableEvent flush_done_;
+  std::atomic<bool> stopped_{false};
+
+  base::Lock lock_;
+  // The first error from the downstream handlers.
+  Status downstream_status_;
+  std::atomic<bool> downstream_failed_{false};
+
+  std::unique_ptr<base::DelegateSimpleThread> thread_;
+
+  // Queue depth statistics, updated by the upstream thread.
+  size_t max_queue_depth_ = 0;
+  uint64_t total_queue_depth_ = 0;
+  uint64_t num_queued_ = 0;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_ASYNC_BOUNDARY_H_
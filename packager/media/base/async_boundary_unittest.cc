@@ -0,0 +1,141 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/async_boundary.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "packager/media/base/media_handler_test_base.h"
+#include "packager/status_test_util.h"
+
+using ::testing::_;
+
+namespace shaka {
+namespace media {
+namespace {
+const size_t kOneInput = 1;
+const size_t kOneOutput = 1;
+const size_t kStreamIndex = 0;
+const size_t kQueueSize = 4;
+const uint32_t kTimeScale = 1000;
+const int64_t kDuration = 100;
+const bool kKeyFrame = true;
+const bool kEncrypted = true;
+const int kNumSamples = 100;
+
+// Fails to process the media sample at |failing_sample_index|.
+class FailingMediaHandler : public MediaHandler {
+ public:
+  explicit FailingMediaHandler(int failing_sample_index)
+      : failing_sample_index_(failing_sample_index) {}
+
+  int num_samples() const { return num_samples_; }
+
+ private:
+  Status InitializeInternal() override { return Status::OK; }
+
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    if (stream_data->stream_data_type != StreamDataType::kMediaSample)
+      return Status::OK;
+    if (num_samples_++ == failing_sample_index_)
+      return Status(error::MUXER_FAILURE, "Failed to process sample.");
+    return Status::OK;
+  }
+
+  Status OnFlushRequest(size_t input_stream_index) override {
+    return Status::OK;
+  }
+
+  const int failing_sample_index_;
+  int num_samples_ = 0;
+};
+
+}  // namespace
+
+class AsyncBoundaryTest : public MediaHandlerTestBase {
+ protected:
+  std::unique_ptr<StreamData> GetSampleStreamData(int64_t index) {
+    return StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(index * kDuration, kDuration, kKeyFrame));
+  }
+};
+
+TEST_F(AsyncBoundaryTest, DispatchInOrderThenFlush) {
+  auto async_boundary = std::make_shared<AsyncBoundary>(kQueueSize);
+  ASSERT_OK(SetUpAndInitializeGraph(async_boundary, kOneInput, kOneOutput));
+
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*Output(kStreamIndex),
+                OnProcess(IsStreamInfo(kStreamIndex, kTimeScale, !kEncrypted,
+                                       _)));
+    for (int i = 0; i < kNumSamples; ++i) {
+      EXPECT_CALL(*Output(kStreamIndex),
+                  OnProcess(IsMediaSample(kStreamIndex, i * kDuration,
+                                          kDuration, !kEncrypted, _)));
+    }
+    EXPECT_CALL(*Output(kStreamIndex), OnFlush(kStreamIndex));
+  }
+
+  ASSERT_OK(Input(kStreamIndex)
+                ->Dispatch(StreamData::FromStreamInfo(
+                    kStreamIndex, GetVideoStreamInfo(kTimeScale))));
+  for (int i = 0; i < kNumSamples; ++i)
+    ASSERT_OK(Input(kStreamIndex)->Dispatch(GetSampleStreamData(i)));
+  ASSERT_OK(Input(kStreamIndex)->FlushAllDownstreams());
+
+  EXPECT_LT(0u, async_boundary->max_queue_depth());
+  EXPECT_GE(kQueueSize, async_boundary->max_queue_depth());
+  EXPECT_LT(0, async_boundary->average_queue_depth());
+}
+
+TEST_F(AsyncBoundaryTest, DownstreamError) {
+  const int kFailingSampleIndex = 10;
+
+  auto input = std::make_shared<FakeInputMediaHandler>();
+  auto async_boundary = std::make_shared<AsyncBoundary>(kQueueSize);
+  auto output = std::make_shared<FailingMediaHandler>(kFailingSampleIndex);
+  ASSERT_OK(MediaHandler::Chain({input, async_boundary, output}));
+  ASSERT_OK(input->Initialize());
+
+  // The error is returned to upstream asynchronously, some time after the
+  // failing sample is queued.
+  Status status;
+  for (int i = 0; i < kNumSamples && status.ok(); ++i)
+    status = input->Dispatch(GetSampleStreamData(i));
+  if (status.ok())
+    status = input->FlushAllDownstreams();
+  EXPECT_EQ(error::MUXER_FAILURE, status.error_code());
+  // Flush requests return the error too.
+  EXPECT_EQ(error::MUXER_FAILURE,
+            input->FlushAllDownstreams().error_code());
+  // Stream data after the failure is dropped.
+  EXPECT_EQ(kFailingSampleIndex + 1, output->num_samples());
+}
+
+TEST_F(AsyncBoundaryTest, DestroyWithoutFlush) {
+  auto input = std::make_shared<FakeInputMediaHandler>();
+  auto async_boundary = std::make_shared<AsyncBoundary>(kQueueSize);
+  auto output = std::make_shared<FailingMediaHandler>(kNumSamples);
+  ASSERT_OK(MediaHandler::Chain({input, async_boundary, output}));
+  ASSERT_OK(input->Initialize());
+
+  for (size_t i = 0; i < kQueueSize; ++i)
+    ASSERT_OK(input->Dispatch(GetSampleStreamData(i)));
+  // The downstream thread is stopped on destruction.
+  input.reset();
+  async_boundary.reset();
+}
+
+TEST_F(AsyncBoundaryTest, MultipleInputsNotSupported) {
+  auto async_boundary = std::make_shared<AsyncBoundary>(kQueueSize);
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            SetUpAndInitializeGraph(async_boundary, 2, 2).error_code());
+}
+
+}  // namespace media
+}  // namespace shaka
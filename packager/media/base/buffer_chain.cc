@@ -0,0 +1,93 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/buffer_chain.h"
+
+#include "packager/base/logging.h"
+#include "packager/file/file.h"
+#include "packager/media/base/buffer_writer.h"
+
+namespace shaka {
+namespace media {
+namespace {
+// Shared data smaller than this is copied.
+const size_t kMinSharedDataSize = 4096;
+}  // namespace
+
+BufferChain::BufferChain() {}
+BufferChain::~BufferChain() {}
+
+void BufferChain::AppendArray(const uint8_t* data, size_t size) {
+  if (size == 0)
+    return;
+  std::vector<uint8_t>* tail = GetOwnedTail();
+  tail->insert(tail->end(), data, data + size);
+  blocks_.back().size += size;
+  size_ += size;
+}
+
+void BufferChain::AppendBuffer(const BufferWriter& buffer) {
+  if (buffer.Size() > 0)
+    AppendArray(buffer.Buffer(), buffer.Size());
+}
+
+void BufferChain::AppendSharedData(std::shared_ptr<const uint8_t> data,
+                                   size_t size) {
+  if (size < kMinSharedDataSize) {
+    AppendArray(data.get(), size);
+    return;
+  }
+  Block block;
+  block.shared_data = std::move(data);
+  block.size = size;
+  blocks_.push_back(std::move(block));
+  size_ += size;
+}
+
+void BufferChain::AppendChain(BufferChain* chain) {
+  DCHECK(chain);
+  DCHECK_NE(chain, this);
+  for (Block& block : chain->blocks_) {
+    if (!block.shared_data && !blocks_.empty() && !blocks_.back().shared_data) {
+      // Merge consecutive owned blocks.
+      AppendArray(block.owned_data.data(), block.size);
+      continue;
+    }
+    size_ += block.size;
+    blocks_.push_back(std::move(block));
+  }
+  chain->Clear();
+}
+
+void BufferChain::Clear() {
+  blocks_.clear();
+  size_ = 0;
+}
+
+Status BufferChain::WriteToFile(File* file) {
+  DCHECK(file);
+  DCHECK_GT(size_, 0u);
+
+  std::vector<IoVec> buffers(blocks_.size());
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    buffers[i] = {blocks_[i].data(), blocks_[i].size};
+  const int64_t size_written = file->WriteV(buffers.data(), buffers.size());
+  if (size_written != static_cast<int64_t>(size_)) {
+    return Status(error::FILE_FAILURE,
+                  "Fail to write to file in BufferChain");
+  }
+  Clear();
+  return Status::OK;
+}
+
+std::vector<uint8_t>* BufferChain::GetOwnedTail() {
+  if (blocks_.empty() || blocks_.back().shared_data)
+    blocks_.emplace_back();
+  return &blocks_.back().owned_data;
+}
+
+}  // namespace media
+}  // namespace shaka
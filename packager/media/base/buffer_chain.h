@@ -0,0 +1,81 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_BUFFER_CHAIN_H_
+#define PACKAGER_MEDIA_BASE_BUFFER_CHAIN_H_
+
+#include <memory>
+#include <vector>
+
+#include "packager/base/macros.h"
+#include "packager/status.h"
+
+namespace shaka {
+
+class File;
+
+namespace media {
+
+class BufferWriter;
+
+/// A buffer made of a chain of blocks, which are either owned by the chain or
+/// shared with other objects, e.g. media sample data. Unlike BufferWriter,
+/// shared data is referenced instead of copied, and the blocks are written to
+/// file with a single vectored write.
+class BufferChain {
+ public:
+  BufferChain();
+  ~BufferChain();
+
+  /// Append a copy of @a size bytes at @a data.
+  void AppendArray(const uint8_t* data, size_t size);
+
+  /// Append a copy of the content of @a buffer.
+  void AppendBuffer(const BufferWriter& buffer);
+
+  /// Append @a size bytes at @a data without copying. Small blocks are copied
+  /// instead, as it is cheaper than writing them separately.
+  /// @param data is kept alive until the chain is cleared. It must not be
+  ///        modified in the meantime.
+  void AppendSharedData(std::shared_ptr<const uint8_t> data, size_t size);
+
+  /// Move the blocks of @a chain to the end of this chain. @a chain is cleared.
+  void AppendChain(BufferChain* chain);
+
+  void Clear();
+  size_t Size() const { return size_; }
+
+  /// Write the buffer to file. The buffer will be cleared after writing.
+  /// @param file should not be NULL.
+  /// @return OK on success.
+  Status WriteToFile(File* file);
+
+ private:
+  struct Block {
+    // Null if the block is owned by the chain, in which case the data is in
+    // |owned_data|.
+    std::shared_ptr<const uint8_t> shared_data;
+    std::vector<uint8_t> owned_data;
+    size_t size = 0;
+
+    const uint8_t* data() const {
+      return shared_data ? shared_data.get() : owned_data.data();
+    }
+  };
+
+  // @return The owned block at the end of the chain, which is added if needed.
+  std::vector<uint8_t>* GetOwnedTail();
+
+  std::vector<Block> blocks_;
+  size_t size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferChain);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_BUFFER_CHAIN_H_
@@ -0,0 +1,116 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/buffer_chain.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "packager/file/file.h"
+#include "packager/media/base/buffer_writer.h"
+#include "packager/status_test_util.h"
+
+namespace shaka {
+namespace media {
+namespace {
+const char kOutputFile[] = "memory://buffer_chain_output";
+const uint8_t kArray[] = {10, 1, 100, 5, 3, 60};
+const size_t kLargeDataSize = 100000;
+const size_t kSmallDataSize = 10;
+
+std::shared_ptr<uint8_t> CreateData(size_t size, uint8_t value) {
+  std::shared_ptr<uint8_t> data(new uint8_t[size],
+                                std::default_delete<uint8_t[]>());
+  std::fill(data.get(), data.get() + size, value);
+  return data;
+}
+
+std::string ToString(const uint8_t* data, size_t size) {
+  return std::string(data, data + size);
+}
+
+}  // namespace
+
+class BufferChainTest : public testing::Test {
+ protected:
+  void TearDown() override { File::Delete(kOutputFile); }
+
+  std::string WriteAndRead(BufferChain* chain) {
+    File* const output_file = File::Open(kOutputFile, "w");
+    EXPECT_TRUE(output_file);
+    EXPECT_OK(chain->WriteToFile(output_file));
+    EXPECT_EQ(0u, chain->Size());
+    EXPECT_TRUE(output_file->Close());
+
+    std::string contents;
+    EXPECT_TRUE(File::ReadFileToString(kOutputFile, &contents));
+    return contents;
+  }
+};
+
+TEST_F(BufferChainTest, AppendAndWrite) {
+  std::shared_ptr<uint8_t> large_data = CreateData(kLargeDataSize, 'a');
+  std::shared_ptr<uint8_t> small_data = CreateData(kSmallDataSize, 'b');
+  BufferWriter buffer;
+  buffer.AppendInt(static_cast<uint32_t>(0x01020304));
+
+  BufferChain chain;
+  chain.AppendArray(kArray, sizeof(kArray));
+  chain.AppendSharedData(large_data, kLargeDataSize);
+  chain.AppendBuffer(buffer);
+  chain.AppendSharedData(small_data, kSmallDataSize);
+  chain.AppendSharedData(large_data, kLargeDataSize);
+  EXPECT_EQ(sizeof(kArray) + 2 * kLargeDataSize + buffer.Size() +
+                kSmallDataSize,
+            chain.Size());
+
+  const std::string large_data_string =
+      ToString(large_data.get(), kLargeDataSize);
+  EXPECT_EQ(ToString(kArray, sizeof(kArray)) + large_data_string +
+                ToString(buffer.Buffer(), buffer.Size()) +
+                ToString(small_data.get(), kSmallDataSize) + large_data_string,
+            WriteAndRead(&chain));
+}
+
+TEST_F(BufferChainTest, LargeSharedDataNotCopied) {
+  std::shared_ptr<uint8_t> large_data = CreateData(kLargeDataSize, 'a');
+  std::shared_ptr<uint8_t> small_data = CreateData(kSmallDataSize, 'b');
+
+  BufferChain chain;
+  chain.AppendSharedData(large_data, kLargeDataSize);
+  chain.AppendSharedData(small_data, kSmallDataSize);
+  EXPECT_EQ(2, large_data.use_count());
+  EXPECT_EQ(1, small_data.use_count());
+
+  chain.Clear();
+  EXPECT_EQ(0u, chain.Size());
+  EXPECT_EQ(1, large_data.use_count());
+}
+
+TEST_F(BufferChainTest, AppendChain) {
+  std::shared_ptr<uint8_t> large_data = CreateData(kLargeDataSize, 'a');
+
+  BufferChain chain;
+  chain.AppendArray(kArray, sizeof(kArray));
+  BufferChain other_chain;
+  other_chain.AppendArray(kArray, sizeof(kArray));
+  other_chain.AppendSharedData(large_data, kLargeDataSize);
+  chain.AppendChain(&other_chain);
+  EXPECT_EQ(0u, other_chain.Size());
+  EXPECT_EQ(2 * sizeof(kArray) + kLargeDataSize, chain.Size());
+  // The shared data is moved, not copied.
+  EXPECT_EQ(2, large_data.use_count());
+
+  const std::string array_string = ToString(kArray, sizeof(kArray));
+  EXPECT_EQ(array_string + array_string +
+                ToString(large_data.get(), kLargeDataSize),
+            WriteAndRead(&chain));
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,192 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/buffer_pool.h"
+
+#include <gflags/gflags.h>
+
+#include <atomic>
+#include <vector>
+
+#include "packager/base/logging.h"
+#include "packager/base/synchronization/lock.h"
+
+DEFINE_uint64(media_sample_buffer_pool_size,
+              64ULL << 20,
+              "Maximum total size of the free media sample buffers kept for "
+              "reuse, in bytes. Specify 0 to disable buffer pooling.");
+
+namespace shaka {
+namespace media {
+namespace {
+
+// The smallest size class is 1KB. Above that, there are four size classes for
+// every power of two, i.e. 1.25, 1.5, 1.75 and 2 times the power of two, so
+// at most 25% of a buffer is wasted.
+const size_t kMinSizeClassShift = 10;
+const size_t kMinSizeClassBytes = 1 << kMinSizeClassShift;
+const size_t kSizeClassesPerPowerOfTwo = 4;
+const size_t kMaxSizeClassShift = 24;
+const size_t kNumSizeClasses =
+    1 + (kMaxSizeClassShift - kMinSizeClassShift) * kSizeClassesPerPowerOfTwo;
+
+size_t Log2Floor(size_t n) {
+  DCHECK_GT(n, 0u);
+  size_t log = 0;
+  while (n >>= 1)
+    ++log;
+  return log;
+}
+
+size_t GetSizeClass(size_t size) {
+  DCHECK_LE(size, BufferPool::kMaxPooledBufferSize);
+  if (size <= kMinSizeClassBytes)
+    return 0;
+  const size_t n = size - 1;
+  const size_t log = Log2Floor(n);
+  const size_t step = (n >> (log - 2)) & (kSizeClassesPerPowerOfTwo - 1);
+  return 1 + (log - kMinSizeClassShift) * kSizeClassesPerPowerOfTwo + step;
+}
+
+size_t GetSizeClassBytes(size_t size_class) {
+  DCHECK_LT(size_class, kNumSizeClasses);
+  if (size_class == 0)
+    return kMinSizeClassBytes;
+  const size_t log =
+      (size_class - 1) / kSizeClassesPerPowerOfTwo + kMinSizeClassShift;
+  const size_t step = (size_class - 1) % kSizeClassesPerPowerOfTwo;
+  return (kSizeClassesPerPowerOfTwo + 1 + step) << (log - 2);
+}
+
+}  // namespace
+
+const size_t BufferPool::kMaxPooledBufferSize;
+
+class BufferPool::Impl : public std::enable_shared_from_this<Impl> {
+ public:
+  explicit Impl(size_t max_pooled_bytes)
+      : max_pooled_bytes_(max_pooled_bytes) {}
+  ~Impl() { Purge(); }
+
+  std::shared_ptr<uint8_t> Allocate(size_t size) {
+    if (size == 0 || size > kMaxPooledBufferSize || max_pooled_bytes_ == 0) {
+      ++misses_;
+      return std::shared_ptr<uint8_t>(new uint8_t[size],
+                                      std::default_delete<uint8_t[]>());
+    }
+
+    const size_t size_class = GetSizeClass(size);
+    const size_t size_class_bytes = GetSizeClassBytes(size_class);
+    DCHECK_GE(size_class_bytes, size);
+
+    uint8_t* buffer = nullptr;
+    {
+      SizeClass& free_list = size_classes_[size_class];
+      base::AutoLock auto_lock(free_list.lock);
+      if (!free_list.buffers.empty()) {
+        buffer = free_list.buffers.back();
+        free_list.buffers.pop_back();
+      }
+    }
+    if (buffer) {
+      ++hits_;
+      pooled_bytes_ -= size_class_bytes;
+    } else {
+      ++misses_;
+      buffer = new uint8_t[size_class_bytes];
+    }
+
+    std::shared_ptr<Impl> self = shared_from_this();
+    return std::shared_ptr<uint8_t>(buffer, [self, size_class](uint8_t* data) {
+      self->Release(size_class, data);
+    });
+  }
+
+  void Purge() {
+    for (size_t size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+      std::vector<uint8_t*> buffers;
+      {
+        SizeClass& free_list = size_classes_[size_class];
+        base::AutoLock auto_lock(free_list.lock);
+        buffers.swap(free_list.buffers);
+      }
+      for (uint8_t* buffer : buffers)
+        delete[] buffer;
+      pooled_bytes_ -= buffers.size() * GetSizeClassBytes(size_class);
+    }
+  }
+
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+  size_t pooled_bytes() const { return pooled_bytes_; }
+
+ private:
+  struct SizeClass {
+    base::Lock lock;
+    std::vector<uint8_t*> buffers;
+  };
+
+  void Release(size_t size_class, uint8_t* buffer) {
+    const size_t size_class_bytes = GetSizeClassBytes(size_class);
+    if (pooled_bytes_.fetch_add(size_class_bytes) + size_class_bytes >
+        max_pooled_bytes_) {
+      pooled_bytes_ -= size_class_bytes;
+      delete[] buffer;
+      return;
+    }
+    SizeClass& free_list = size_classes_[size_class];
+    base::AutoLock auto_lock(free_list.lock);
+    free_list.buffers.push_back(buffer);
+  }
+
+  const size_t max_pooled_bytes_;
+  SizeClass size_classes_[kNumSizeClasses];
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<size_t> pooled_bytes_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(Impl);
+};
+
+BufferPool::BufferPool(size_t max_pooled_bytes)
+    : impl_(new Impl(max_pooled_bytes)) {}
+
+BufferPool::~BufferPool() {
+  // Outstanding buffers keep |impl_| alive until they are released.
+  impl_->Purge();
+}
+
+// static
+BufferPool* BufferPool::GetInstance() {
+  // Intentionally leaked, as buffers may be released during static
+  // destruction.
+  static BufferPool* instance =
+      new BufferPool(static_cast<size_t>(FLAGS_media_sample_buffer_pool_size));
+  return instance;
+}
+
+std::shared_ptr<uint8_t> BufferPool::Allocate(size_t size) {
+  return impl_->Allocate(size);
+}
+
+void BufferPool::Purge() {
+  impl_->Purge();
+}
+
+uint64_t BufferPool::hits() const {
+  return impl_->hits();
+}
+
+uint64_t BufferPool::misses() const {
+  return impl_->misses();
+}
+
+size_t BufferPool::pooled_bytes() const {
+  return impl_->pooled_bytes();
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,73 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_BUFFER_POOL_H_
+#define PACKAGER_MEDIA_BASE_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "packager/base/macros.h"
+
+namespace shaka {
+namespace media {
+
+/// A pool of recyclable buffers, used to hold media sample data so that the
+/// buffers are reused across samples instead of being allocated and freed for
+/// every sample. Buffer sizes are rounded up to one of a set of size classes,
+/// with four classes per power of two, and each size class keeps its own list
+/// of free buffers with its own lock, so threads allocating or releasing
+/// buffers of different sizes do not contend. A buffer returns to the pool
+/// automatically when the last reference to it is released, which may happen
+/// on any thread, even after the pool itself has been destroyed.
+/// This class is thread safe.
+class BufferPool {
+ public:
+  /// Buffers larger than this are allocated directly and never pooled.
+  static const size_t kMaxPooledBufferSize = 16 << 20;
+
+  /// @param max_pooled_bytes is the maximum total size of the free buffers
+  ///        kept in the pool. Free buffers beyond that are deleted. Specify 0
+  ///        to disable pooling.
+  explicit BufferPool(size_t max_pooled_bytes);
+  ~BufferPool();
+
+  /// @return the process-wide buffer pool used by MediaSample, with its size
+  ///         limited by --media_sample_buffer_pool_size.
+  static BufferPool* GetInstance();
+
+  /// Get a buffer with at least @a size bytes, reusing a free buffer if
+  /// available. The content of the buffer is undefined.
+  /// @return the buffer, which is returned to the pool when the last
+  ///         reference to it is released.
+  std::shared_ptr<uint8_t> Allocate(size_t size);
+
+  /// Delete all the free buffers in the pool.
+  void Purge();
+
+  /// @return the number of allocations served with a free buffer.
+  uint64_t hits() const;
+  /// @return the number of allocations which required a new buffer.
+  uint64_t misses() const;
+  /// @return the total size of the free buffers in the pool.
+  size_t pooled_bytes() const;
+
+ private:
+  class Impl;
+
+  // Shared with the deleters of the buffers handed out, so buffers can still
+  // be released after the pool is destroyed.
+  std::shared_ptr<Impl> impl_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferPool);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_BUFFER_POOL_H_
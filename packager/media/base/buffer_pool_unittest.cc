@@ -0,0 +1,126 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/buffer_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <thread>
+#include <vector>
+
+namespace shaka {
+namespace media {
+
+namespace {
+const size_t kMaxPooledBytes = 1 << 20;
+}  // namespace
+
+TEST(BufferPoolTest, ReuseReleasedBuffer) {
+  BufferPool pool(kMaxPooledBytes);
+
+  std::shared_ptr<uint8_t> buffer = pool.Allocate(1000);
+  ASSERT_TRUE(buffer);
+  memset(buffer.get(), 0xab, 1000);
+  uint8_t* buffer_ptr = buffer.get();
+  EXPECT_EQ(0u, pool.hits());
+  EXPECT_EQ(1u, pool.misses());
+  EXPECT_EQ(0u, pool.pooled_bytes());
+
+  buffer.reset();
+  EXPECT_LT(0u, pool.pooled_bytes());
+
+  // A buffer of a slightly different size in the same size class.
+  buffer = pool.Allocate(900);
+  EXPECT_EQ(buffer_ptr, buffer.get());
+  EXPECT_EQ(1u, pool.hits());
+  EXPECT_EQ(1u, pool.misses());
+  EXPECT_EQ(0u, pool.pooled_bytes());
+}
+
+TEST(BufferPoolTest, DifferentSizeClasses) {
+  BufferPool pool(kMaxPooledBytes);
+
+  std::shared_ptr<uint8_t> small_buffer = pool.Allocate(1000);
+  small_buffer.reset();
+  // Too large for the size class of the released buffer.
+  std::shared_ptr<uint8_t> large_buffer = pool.Allocate(100000);
+  EXPECT_EQ(0u, pool.hits());
+  EXPECT_EQ(2u, pool.misses());
+  memset(large_buffer.get(), 0xcd, 100000);
+}
+
+TEST(BufferPoolTest, MaxPooledBytes) {
+  const size_t kBufferSize = kMaxPooledBytes / 2;
+  BufferPool pool(kMaxPooledBytes);
+
+  std::vector<std::shared_ptr<uint8_t>> buffers;
+  for (int i = 0; i < 4; ++i)
+    buffers.push_back(pool.Allocate(kBufferSize));
+  buffers.clear();
+  // Only two buffers fit in the pool.
+  EXPECT_EQ(kMaxPooledBytes, pool.pooled_bytes());
+
+  for (int i = 0; i < 4; ++i)
+    buffers.push_back(pool.Allocate(kBufferSize));
+  EXPECT_EQ(2u, pool.hits());
+  EXPECT_EQ(6u, pool.misses());
+}
+
+TEST(BufferPoolTest, PoolingDisabled) {
+  BufferPool pool(0);
+  pool.Allocate(1000).reset();
+  std::shared_ptr<uint8_t> buffer = pool.Allocate(1000);
+  EXPECT_EQ(0u, pool.hits());
+  EXPECT_EQ(2u, pool.misses());
+  EXPECT_EQ(0u, pool.pooled_bytes());
+}
+
+TEST(BufferPoolTest, LargeBuffersNotPooled) {
+  BufferPool pool(BufferPool::kMaxPooledBufferSize * 2);
+  pool.Allocate(BufferPool::kMaxPooledBufferSize + 1).reset();
+  EXPECT_EQ(0u, pool.pooled_bytes());
+  pool.Allocate(BufferPool::kMaxPooledBufferSize).reset();
+  EXPECT_EQ(BufferPool::kMaxPooledBufferSize, pool.pooled_bytes());
+}
+
+TEST(BufferPoolTest, Purge) {
+  BufferPool pool(kMaxPooledBytes);
+  pool.Allocate(1000).reset();
+  pool.Allocate(10000).reset();
+  EXPECT_LT(0u, pool.pooled_bytes());
+  pool.Purge();
+  EXPECT_EQ(0u, pool.pooled_bytes());
+}
+
+TEST(BufferPoolTest, BufferOutlivesPool) {
+  std::shared_ptr<uint8_t> buffer;
+  {
+    BufferPool pool(kMaxPooledBytes);
+    buffer = pool.Allocate(1000);
+  }
+  memset(buffer.get(), 0, 1000);
+  buffer.reset();
+}
+
+TEST(BufferPoolTest, ReleaseOnAnotherThread) {
+  const int kNumBuffers = 1000;
+  BufferPool pool(kMaxPooledBytes);
+
+  std::vector<std::shared_ptr<uint8_t>> buffers;
+  for (int i = 0; i < kNumBuffers; ++i)
+    buffers.push_back(pool.Allocate(100 + i));
+  std::thread release_thread([&buffers]() { buffers.clear(); });
+  for (int i = 0; i < kNumBuffers; ++i)
+    pool.Allocate(100 + i).reset();
+  release_thread.join();
+
+  EXPECT_EQ(2u * kNumBuffers, pool.hits() + pool.misses());
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -9,6 +9,9 @@
 #include <curl/curl.h>
 #include <gflags/gflags.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "packager/base/logging.h"
 #include "packager/base/strings/string_number_conversions.h"
 #include "packager/base/strings/stringprintf.h"
@@ -31,6 +34,10 @@ const char kJsonContentTypeHeader[] = "Content-Type: application/json";
 
 const int kMinLogLevelForCurlDebugFunction = 2;
 
+// The maximum number of idle CURL handles, with their open connections, kept
+// for the following requests.
+const size_t kMaxIdleCurlHandles = 4;
+
 int CurlDebugFunction(CURL* /* handle */,
                       curl_infotype type,
                       const char* data,
@@ -81,20 +88,8 @@ int CurlDebugFunction(CURL* /* handle */,
   return 0;
 }
 
-// Scoped CURL implementation which cleans up itself when goes out of scope.
-class ScopedCurl {
- public:
-  ScopedCurl() { ptr_ = curl_easy_init(); }
-  ~ScopedCurl() {
-    if (ptr_)
-      curl_easy_cleanup(ptr_);
-  }
-
-  CURL* get() { return ptr_; }
-
- private:
-  CURL* ptr_;
-  DISALLOW_COPY_AND_ASSIGN(ScopedCurl);
+struct CurlSlistDeleter {
+  void operator()(curl_slist* list) { curl_slist_free_all(list); }
 };
 
 size_t AppendToString(char* ptr, size_t size, size_t nmemb, std::string* response) {
@@ -130,14 +125,108 @@ class LibCurlInitializer {
   DISALLOW_COPY_AND_ASSIGN(LibCurlInitializer);
 };
 
+void InitializeLibCurl() {
+  static LibCurlInitializer lib_curl_initializer;
+}
+
 }  // namespace
 
 namespace media {
 
-HttpKeyFetcher::HttpKeyFetcher() : timeout_in_seconds_(0) {}
+// A pool of CURL handles. A handle keeps its connections open after a request,
+// so that the following requests to the same server made with the handle skip
+// the TCP and TLS handshakes. The handles also share their DNS cache and TLS
+// sessions, so that the TLS handshakes of their new connections are
+// abbreviated.
+class CurlHandlePool {
+ public:
+  CurlHandlePool() {
+    InitializeLibCurl();
+    share_ = curl_share_init();
+    if (share_) {
+      curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, LockSharedData);
+      curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, UnlockSharedData);
+      curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+      curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+      curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+  }
+
+  ~CurlHandlePool() {
+    for (CURL* curl : idle_handles_)
+      curl_easy_cleanup(curl);
+    // The handles using |share_| must be cleaned up first.
+    if (share_)
+      curl_share_cleanup(share_);
+  }
+
+  // @return A handle with default options, or nullptr on failure.
+  CURL* Acquire() {
+    CURL* curl = nullptr;
+    {
+      base::AutoLock auto_lock(lock_);
+      if (!idle_handles_.empty()) {
+        curl = idle_handles_.back();
+        idle_handles_.pop_back();
+      }
+    }
+    if (curl) {
+      // Resets the options of the previous request. The open connections are
+      // kept.
+      curl_easy_reset(curl);
+    } else {
+      curl = curl_easy_init();
+      if (!curl)
+        return nullptr;
+    }
+    if (share_)
+      curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+    return curl;
+  }
+
+  // Returns |curl| to the pool, or cleans it up if the pool is full.
+  void Release(CURL* curl) {
+    {
+      base::AutoLock auto_lock(lock_);
+      if (idle_handles_.size() < kMaxIdleCurlHandles) {
+        idle_handles_.push_back(curl);
+        return;
+      }
+    }
+    curl_easy_cleanup(curl);
+  }
+
+ private:
+  CurlHandlePool(const CurlHandlePool&) = delete;
+  CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+  static void LockSharedData(CURL* /* handle */,
+                             curl_lock_data data,
+                             curl_lock_access /* access */,
+                             void* pool) {
+    DCHECK_LT(data, CURL_LOCK_DATA_LAST);
+    static_cast<CurlHandlePool*>(pool)->share_locks_[data].Acquire();
+  }
+
+  static void UnlockSharedData(CURL* /* handle */,
+                               curl_lock_data data,
+                               void* pool) {
+    DCHECK_LT(data, CURL_LOCK_DATA_LAST);
+    static_cast<CurlHandlePool*>(pool)->share_locks_[data].Release();
+  }
+
+  base::Lock lock_;
+  std::vector<CURL*> idle_handles_;
+  CURLSH* share_ = nullptr;
+  // Protects the data shared by the handles, per type of data.
+  base::Lock share_locks_[CURL_LOCK_DATA_LAST];
+};
+
+HttpKeyFetcher::HttpKeyFetcher() : HttpKeyFetcher(0) {}
 
 HttpKeyFetcher::HttpKeyFetcher(uint32_t timeout_in_seconds)
-    : timeout_in_seconds_(timeout_in_seconds) {}
+    : timeout_in_seconds_(timeout_in_seconds),
+      curl_handle_pool_(new CurlHandlePool) {}
 
 HttpKeyFetcher::~HttpKeyFetcher() {}
 
@@ -157,15 +246,18 @@ Status HttpKeyFetcher::Post(const std::string& path,
   return FetchInternal(POST, path, data, response);
 }
 
+HttpKeyFetcher::Stats HttpKeyFetcher::GetStats() const {
+  base::AutoLock auto_lock(stats_lock_);
+  return stats_;
+}
+
 Status HttpKeyFetcher::FetchInternal(HttpMethod method,
                                      const std::string& path,
                                      const std::string& data,
                                      std::string* response) {
   DCHECK(method == GET || method == POST);
-  static LibCurlInitializer lib_curl_initializer;
 
-  ScopedCurl scoped_curl;
-  CURL* curl = scoped_curl.get();
+  CURL* curl = curl_handle_pool_->Acquire();
   if (!curl) {
     LOG(ERROR) << "curl_easy_init() failed.";
     return Status(error::HTTP_FAILURE, "curl_easy_init() failed.");
@@ -179,6 +271,11 @@ Status HttpKeyFetcher::FetchInternal(HttpMethod method,
   curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, AppendToString);
   curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+  // Keeps the idle connections alive between requests, e.g. between the key
+  // requests of crypto periods.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  if (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2)
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
 
   if (FLAGS_disable_peer_verification)
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
@@ -201,6 +298,7 @@ Status HttpKeyFetcher::FetchInternal(HttpMethod method,
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
     curl_easy_setopt(curl, CURLOPT_CAINFO, ca_file_.data());
   }
+  std::unique_ptr<curl_slist, CurlSlistDeleter> headers;
   if (method == POST) {
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
     curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
@@ -213,6 +311,7 @@ Status HttpKeyFetcher::FetchInternal(HttpMethod method,
     } else {
       chunk = curl_slist_append(chunk, kJsonContentTypeHeader);
     }
+    headers.reset(chunk);
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
   }
 
@@ -222,14 +321,18 @@ Status HttpKeyFetcher::FetchInternal(HttpMethod method,
   }
 
   CURLcode res = curl_easy_perform(curl);
+  UpdateStats(curl, path);
+  long response_code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+  // The handle is reset before being reused, so its options may still refer to
+  // |headers|, |data| and |response|.
+  curl_handle_pool_->Release(curl);
+
   if (res != CURLE_OK) {
     std::string error_message = base::StringPrintf(
         "curl_easy_perform() failed: %s.", curl_easy_strerror(res));
-    if (res == CURLE_HTTP_RETURNED_ERROR) {
-      long response_code = 0;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    if (res == CURLE_HTTP_RETURNED_ERROR)
       error_message += base::StringPrintf(" Response code: %ld.", response_code);
-    }
 
     LOG(ERROR) << error_message;
     return Status(
@@ -239,5 +342,36 @@ Status HttpKeyFetcher::FetchInternal(HttpMethod method,
   return Status::OK;
 }
 
+void HttpKeyFetcher::UpdateStats(void* curl, const std::string& url) {
+  double total_time = 0;
+  double connect_time = 0;
+  double app_connect_time = 0;
+  double start_transfer_time = 0;
+  long num_connects = 0;
+  curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total_time);
+  curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &connect_time);
+  curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &app_connect_time);
+  curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &start_transfer_time);
+  curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &num_connects);
+  if (num_connects > 0) {
+    VLOG(1) << "Request to " << url << " took " << total_time
+            << " seconds on a new connection: connected after " << connect_time
+            << " seconds, TLS handshake done after " << app_connect_time
+            << " seconds, first byte received after " << start_transfer_time
+            << " seconds.";
+  } else {
+    VLOG(1) << "Request to " << url << " took " << total_time
+            << " seconds on a reused connection: first byte received after "
+            << start_transfer_time << " seconds.";
+  }
+
+  base::AutoLock auto_lock(stats_lock_);
+  ++stats_.num_requests;
+  stats_.num_connections += num_connects;
+  stats_.total_latency_in_seconds += total_time;
+  stats_.max_latency_in_seconds =
+      std::max(stats_.max_latency_in_seconds, total_time);
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -11,20 +11,41 @@
 #ifndef PACKAGER_MEDIA_BASE_HTTP_KEY_FETCHER_H_
 #define PACKAGER_MEDIA_BASE_HTTP_KEY_FETCHER_H_
 
+#include <memory>
+
 #include "packager/base/compiler_specific.h"
+#include "packager/base/synchronization/lock.h"
 #include "packager/media/base/key_fetcher.h"
 #include "packager/status.h"
 
 namespace shaka {
 namespace media {
 
+class CurlHandlePool;
+
 /// A KeyFetcher implementation that retrieves keys over HTTP(s).
+/// The connections are kept alive and reused by the following requests, e.g.
+/// the key requests of the following crypto periods, and HTTP/2 is negotiated
+/// if supported by libcurl.
 /// This class is not fully thread safe. It can be used in multi-thread
 /// environment once constructed, but it may not be safe to create a
 /// HttpKeyFetcher object when any other thread is running due to use of
 /// curl_global_init.
 class HttpKeyFetcher : public KeyFetcher {
  public:
+  /// Latency statistics of the requests made by a fetcher.
+  struct Stats {
+    /// The number of requests made, successful or not.
+    uint64_t num_requests = 0;
+    /// The number of connections opened by the requests. The other requests
+    /// reused the connections of the previous ones.
+    uint64_t num_connections = 0;
+    /// The sum of the durations of the requests, in seconds.
+    double total_latency_in_seconds = 0;
+    /// The longest duration of a request, in seconds.
+    double max_latency_in_seconds = 0;
+  };
+
   /// Creates a fetcher with no timeout.
   HttpKeyFetcher();
   /// Create a fetcher with timeout.
@@ -71,6 +92,10 @@ class HttpKeyFetcher : public KeyFetcher {
     ca_file_ = ca_file;
   }
 
+  /// @return The latency statistics of the requests made so far. The
+  ///         latency of each request is also logged with VLOG(1).
+  Stats GetStats() const;
+
  private:
   enum HttpMethod {
     GET,
@@ -81,8 +106,16 @@ class HttpKeyFetcher : public KeyFetcher {
   // Internal implementation of HTTP functions, e.g. Get and Post.
   Status FetchInternal(HttpMethod method, const std::string& url,
                        const std::string& data, std::string* response);
+  // Logs the latency of the request just made with |curl|, which is a CURL
+  // handle, and adds it to |stats_|.
+  void UpdateStats(void* curl, const std::string& url);
 
   const uint32_t timeout_in_seconds_;
+  // The CURL handles, which keep their connections open, are reused by the
+  // following requests.
+  std::unique_ptr<CurlHandlePool> curl_handle_pool_;
+  mutable base::Lock stats_lock_;
+  Stats stats_;
   std::string ca_file_;
   std::string client_cert_file_;
   std::string client_cert_private_key_file_;
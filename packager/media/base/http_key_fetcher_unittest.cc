@@ -6,11 +6,23 @@
 
 #include "packager/media/base/http_key_fetcher.h"
 
+#include <gtest/gtest.h>
+
 #include "packager/base/logging.h"
 #include "packager/base/strings/string_number_conversions.h"
 #include "packager/base/strings/string_util.h"
 #include "packager/status_test_util.h"
 
+#if !defined(OS_WIN)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#endif  // !defined(OS_WIN)
+
 namespace {
 const char kTestUrl[] = "http://packager-test.appspot.com/http_test";
 const char kTestUrlWithPort[] = "http://packager-test.appspot.com:80/http_test";
@@ -95,6 +107,123 @@ TEST(DISABLED_HttpKeyFetcherTest, BigTimeout) {
   EXPECT_OK(status);
 }
 
+#if !defined(OS_WIN)
+// A local HTTP/1.1 server which keeps the connections alive and echoes the
+// request body, or the request path for GET requests.
+class LocalHttpServer {
+ public:
+  LocalHttpServer() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_GE(listen_fd_, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    CHECK_EQ(0, bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                     sizeof(addr)));
+    CHECK_EQ(0, listen(listen_fd_, 4));
+    socklen_t addr_len = sizeof(addr);
+    CHECK_EQ(0, getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                            &addr_len));
+    port_ = ntohs(addr.sin_port);
+    thread_ = std::thread(&LocalHttpServer::Run, this);
+  }
+
+  ~LocalHttpServer() {
+    shutdown(listen_fd_, SHUT_RDWR);
+    close(listen_fd_);
+    thread_.join();
+  }
+
+  std::string GetUrl(const std::string& path) const {
+    return "http://127.0.0.1:" + base::IntToString(port_) + path;
+  }
+
+  int num_connections() const { return num_connections_; }
+
+ private:
+  void Run() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0)
+        return;
+      ++num_connections_;
+      // The client makes one request at a time, so the connections are served
+      // one after the other.
+      while (ServeRequest(fd)) {
+      }
+      close(fd);
+    }
+  }
+
+  bool ServeRequest(int fd) {
+    std::string request;
+    size_t header_end = std::string::npos;
+    while ((header_end = request.find("\r\n\r\n")) == std::string::npos) {
+      if (!Receive(fd, &request))
+        return false;
+    }
+    header_end += 4;
+    const std::string header = base::ToLowerASCII(request.substr(0, header_end));
+    size_t content_length = 0;
+    const char kContentLength[] = "content-length:";
+    const size_t pos = header.find(kContentLength);
+    if (pos != std::string::npos) {
+      std::string value = header.substr(pos + sizeof(kContentLength) - 1);
+      value = value.substr(0, value.find("\r\n"));
+      base::TrimWhitespaceASCII(value, base::TRIM_ALL, &value);
+      if (!base::StringToSizeT(value, &content_length))
+        return false;
+    }
+    while (request.size() < header_end + content_length) {
+      if (!Receive(fd, &request))
+        return false;
+    }
+
+    std::string body = request.substr(header_end, content_length);
+    if (header.compare(0, 4, "get ") == 0)
+      body = request.substr(4, request.find(' ', 4) - 4);
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                                 base::SizeTToString(body.size()) +
+                                 "\r\n\r\n" + body;
+    return send(fd, response.data(), response.size(), 0) ==
+           static_cast<ssize_t>(response.size());
+  }
+
+  static bool Receive(int fd, std::string* data) {
+    char buffer[1024];
+    const ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+    if (size <= 0)
+      return false;
+    data->append(buffer, size);
+    return true;
+  }
+
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::atomic<int> num_connections_{0};
+  std::thread thread_;
+};
+
+TEST(HttpKeyFetcherLocalTest, ReusesConnection) {
+  LocalHttpServer server;
+  HttpKeyFetcher fetcher;
+  std::string response;
+  ASSERT_OK(fetcher.Get(server.GetUrl("/key"), &response));
+  EXPECT_EQ("/key", response);
+  ASSERT_OK(fetcher.Post(server.GetUrl("/keys"), kPostData, &response));
+  EXPECT_EQ(kPostData, response);
+  ASSERT_OK(fetcher.FetchKeys(server.GetUrl("/keys"), kPostData, &response));
+  EXPECT_EQ(kPostData, response);
+
+  EXPECT_EQ(1, server.num_connections());
+  const HttpKeyFetcher::Stats stats = fetcher.GetStats();
+  EXPECT_EQ(3u, stats.num_requests);
+  EXPECT_EQ(1u, stats.num_connections);
+  EXPECT_LE(stats.max_latency_in_seconds, stats.total_latency_in_seconds);
+}
+#endif  // !defined(OS_WIN)
+
 }  // namespace media
 }  // namespace shaka
 
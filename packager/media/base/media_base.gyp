@@ -21,6 +21,8 @@
         'aes_encryptor.h',
         'aes_pattern_cryptor.cc',
         'aes_pattern_cryptor.h',
+        'async_boundary.cc',
+        'async_boundary.h',
         'audio_stream_info.cc',
         'audio_stream_info.h',
         'audio_timestamp_helper.cc',
@@ -29,6 +31,10 @@
         'bit_reader.h',
         'bit_writer.cc',
         'bit_writer.h',
+        'buffer_chain.cc',
+        'buffer_chain.h',
+        'buffer_pool.cc',
+        'buffer_pool.h',
         'buffer_reader.cc',
         'buffer_reader.h',
         'buffer_writer.cc',
@@ -89,6 +95,8 @@
         'pssh_generator_util.cc',
         'pssh_generator_util.h',
         'range.h',
+        'range_merger.cc',
+        'range_merger.h',
         'raw_key_source.cc',
         'raw_key_source.h',
         'rcheck.h',
@@ -169,9 +177,12 @@
       'sources': [
         'aes_cryptor_unittest.cc',
         'aes_pattern_cryptor_unittest.cc',
+        'async_boundary_unittest.cc',
         'audio_timestamp_helper_unittest.cc',
         'bit_reader_unittest.cc',
         'bit_writer_unittest.cc',
+        'buffer_chain_unittest.cc',
+        'buffer_pool_unittest.cc',
         'buffer_writer_unittest.cc',
         'closure_thread_unittest.cc',
         'container_names_unittest.cc',
@@ -183,6 +194,7 @@
         'producer_consumer_queue_unittest.cc',
         'protection_system_specific_info_unittest.cc',
         'pssh_generator_unittest.cc',
+        'range_merger_unittest.cc',
         'raw_key_source_unittest.cc',
         'rsa_key_unittest.cc',
         'status_test_util_unittest.cc',
@@ -200,6 +212,7 @@
         '../../third_party/boringssl/boringssl.gyp:boringssl',
         '../test/media_test.gyp:media_test_support',
         'media_base',
+        'media_handler_test_base',
       ],
     },
   ],
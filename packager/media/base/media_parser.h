@@ -35,11 +35,13 @@ class MediaParser {
 
   /// Called when a new media sample has been parsed.
   /// @param track_id is the track id of the new sample.
-  /// @param media_sample is the new media sample.
+  /// @param media_sample is the new media sample. Parsers should hand over
+  ///        their reference, so that the sample can be modified in place
+  ///        downstream if nothing else refers to it.
   /// @return true if the sample is accepted, false if something was wrong
   ///         with the sample and a parsing error should be signaled.
   typedef base::Callback<bool(uint32_t track_id,
-                              const std::shared_ptr<MediaSample>& media_sample)>
+                              std::shared_ptr<MediaSample> media_sample)>
       NewSampleCB;
 
   /// Initialize the parser with necessary callbacks. Must be called before any
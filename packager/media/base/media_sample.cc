@@ -10,6 +10,7 @@
 
 #include "packager/base/logging.h"
 #include "packager/base/strings/stringprintf.h"
+#include "packager/media/base/buffer_pool.h"
 
 namespace shaka {
 namespace media {
@@ -26,8 +27,8 @@ MediaSample::MediaSample(const uint8_t* data,
 
   SetData(data, data_size);
   if (side_data) {
-    std::shared_ptr<uint8_t> shared_side_data(new uint8_t[side_data_size],
-                                              std::default_delete<uint8_t[]>());
+    std::shared_ptr<uint8_t> shared_side_data =
+        BufferPool::GetInstance()->Allocate(side_data_size);
     memcpy(shared_side_data.get(), side_data, side_data_size);
     side_data_ = std::move(shared_side_data);
     side_data_size_ = side_data_size;
@@ -87,6 +88,7 @@ std::shared_ptr<MediaSample> MediaSample::Clone() const {
   new_media_sample->is_encrypted_ = is_encrypted_;
   new_media_sample->data_ = data_;
   new_media_sample->data_size_ = data_size_;
+  new_media_sample->data_is_read_only_ = data_is_read_only_;
   new_media_sample->side_data_ = side_data_;
   new_media_sample->side_data_size_ = side_data_size_;
   new_media_sample->config_id_ = config_id_;
@@ -100,15 +102,33 @@ std::shared_ptr<MediaSample> MediaSample::Clone() const {
   return new_media_sample;
 }
 
+uint8_t* MediaSample::writable_data() {
+  DCHECK(!end_of_stream());
+  if (data_is_read_only_ || data_.use_count() != 1)
+    return nullptr;
+  // Other than with SetReadOnlyData, the buffer is always allocated as
+  // non-const by SetData or passed in as non-const by TransferData, so it is
+  // safe to cast away the constness.
+  return const_cast<uint8_t*>(data_.get());
+}
+
 void MediaSample::TransferData(std::shared_ptr<uint8_t> data,
                                size_t data_size) {
   data_ = std::move(data);
   data_size_ = data_size;
+  data_is_read_only_ = false;
+}
+
+void MediaSample::SetReadOnlyData(std::shared_ptr<const uint8_t> data,
+                                  size_t data_size) {
+  data_ = std::move(data);
+  data_size_ = data_size;
+  data_is_read_only_ = true;
 }
 
 void MediaSample::SetData(const uint8_t* data, size_t data_size) {
-  std::shared_ptr<uint8_t> shared_data(new uint8_t[data_size],
-                                       std::default_delete<uint8_t[]>());
+  std::shared_ptr<uint8_t> shared_data =
+      BufferPool::GetInstance()->Allocate(data_size);
   memcpy(shared_data.get(), data, data_size);
   TransferData(std::move(shared_data), data_size);
 }
@@ -72,8 +72,15 @@ class MediaSample {
   /// @param data_size is the size of the data to be transferred.
   void TransferData(std::shared_ptr<uint8_t> data, size_t data_size);
 
+  /// Reference read-only data in this media sample, e.g. data in a read-only
+  /// memory mapping. No data copying is involved. Unlike with TransferData(),
+  /// the data is never returned by writable_data().
+  /// @param data points to the data to be referenced.
+  /// @param data_size is the size of the data to be referenced.
+  void SetReadOnlyData(std::shared_ptr<const uint8_t> data, size_t data_size);
+
   /// Set the data in this media sample. Note that this method involves data
-  /// copying.
+  /// copying, into a buffer from BufferPool::GetInstance().
   /// @param data points to the data to be copied.
   /// @param data_size is the size of the data to be copied.
   void SetData(const uint8_t* data, size_t data_size);
@@ -124,6 +131,21 @@ class MediaSample {
     return data_size_;
   }
 
+  /// @return The sample data buffer, for referencing the data beyond the
+  ///         lifetime of this sample without copying it. The data is not
+  ///         modified while it is referenced.
+  std::shared_ptr<const uint8_t> shared_data() const {
+    DCHECK(!end_of_stream());
+    return data_;
+  }
+
+  /// @return a pointer to the sample data which can be modified in place, if
+  ///         this sample is the only owner of the data buffer; nullptr
+  ///         otherwise, e.g. if the buffer is shared with clones of this
+  ///         sample or is read-only, in which case the data must not be
+  ///         modified.
+  uint8_t* writable_data();
+
   const uint8_t* side_data() const { return side_data_.get(); }
 
   size_t side_data_size() const { return side_data_size_; }
@@ -174,6 +196,8 @@ class MediaSample {
   // Main buffer data.
   std::shared_ptr<const uint8_t> data_;
   size_t data_size_ = 0;
+  // Whether |data_| is set by SetReadOnlyData().
+  bool data_is_read_only_ = false;
   // Contain additional buffers to complete the main one. Needed by WebM
   // http://www.matroska.org/technical/specs/index.html BlockAdditional[A5].
   // Not used by mp4 and other containers.
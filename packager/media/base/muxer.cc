@@ -68,7 +68,7 @@ Status Muxer::Process(std::unique_ptr<StreamData> stream_data) {
       return FinalizeSegment(stream_data->stream_index, segment_info);
     }
     case StreamDataType::kMediaSample:
-      return AddSample(stream_data->stream_index, *stream_data->media_sample);
+      return AddSample(stream_data->stream_index, stream_data->media_sample);
     case StreamDataType::kCueEvent:
       if (muxer_listener_) {
         const int64_t time_scale =
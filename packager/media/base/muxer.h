@@ -83,10 +83,11 @@ class Muxer : public MediaHandler {
   // Final clean up.
   virtual Status Finalize() = 0;
 
-  // Add a new sample.
-  virtual Status AddSample(
-      size_t stream_id,
-      const MediaSample& sample) = 0;
+  // Add a new sample. The sample is immutable and may be shared with other
+  // handlers, so a muxer that holds on to it keeps the reference instead of
+  // copying it.
+  virtual Status AddSample(size_t stream_id,
+                           std::shared_ptr<const MediaSample> sample) = 0;
 
   // Finalize the segment or subsegment.
   virtual Status FinalizeSegment(
@@ -11,7 +11,8 @@
 namespace shaka {
 namespace media {
 
-OffsetByteQueue::OffsetByteQueue() : buf_(NULL), size_(0), head_(0) {}
+OffsetByteQueue::OffsetByteQueue()
+    : buf_(NULL), size_(0), head_(0), in_place_(false) {}
 OffsetByteQueue::~OffsetByteQueue() {}
 
 void OffsetByteQueue::Reset() {
@@ -19,22 +20,45 @@ void OffsetByteQueue::Reset() {
   buf_ = NULL;
   size_ = 0;
   head_ = 0;
+  in_place_ = false;
 }
 
 void OffsetByteQueue::Push(const uint8_t* buf, int size) {
+  if (in_place_) {
+    DCHECK_EQ(0, size_) << "Cannot copy data after data pushed in place.";
+    in_place_ = false;
+  }
   queue_.Push(buf, size);
   Sync();
   DVLOG(4) << "Buffer pushed. head=" << head() << " tail=" << tail();
 }
 
+void OffsetByteQueue::PushInPlace(const uint8_t* buf, int size) {
+  if (!in_place_) {
+    DCHECK_EQ(0, size_) << "Cannot push data in place after copied data.";
+    in_place_ = true;
+  }
+  if (size_ == 0)
+    buf_ = buf;
+  DCHECK_EQ(buf_ + size_, buf) << "Data pushed in place must be contiguous.";
+  size_ += size;
+  DVLOG(4) << "Buffer pushed in place. head=" << head() << " tail=" << tail();
+}
+
 void OffsetByteQueue::Peek(const uint8_t** buf, int* size) {
   *buf = size_ > 0 ? buf_ : NULL;
   *size = size_;
 }
 
 void OffsetByteQueue::Pop(int count) {
-  queue_.Pop(count);
   head_ += count;
+  if (in_place_) {
+    DCHECK_LE(count, size_);
+    buf_ += count;
+    size_ -= count;
+    return;
+  }
+  queue_.Pop(count);
   Sync();
 }
 
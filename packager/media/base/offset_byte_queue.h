@@ -29,6 +29,13 @@ class OffsetByteQueue {
   void Pop(int count);
   /// @}
 
+  /// Like Push(), but @a buf is referenced instead of copied, so it must stay
+  /// valid until it is popped. The queue is then a window over a single
+  /// buffer, e.g. a memory-mapped file: unless the queue is empty, @a buf
+  /// must immediately follow the data previously pushed in place. Mixing it
+  /// with Push() is only allowed when the queue is empty.
+  void PushInPlace(const uint8_t* buf, int size);
+
   /// Set @a buf to point at the first buffered byte corresponding to @a offset,
   /// and @a size to the number of bytes available starting from that offset.
   ///
@@ -62,6 +69,8 @@ class OffsetByteQueue {
   const uint8_t* buf_;
   int size_;
   int64_t head_;
+  // Whether the data is pushed in place, in which case |queue_| is not used.
+  bool in_place_;
 
   DISALLOW_COPY_AND_ASSIGN(OffsetByteQueue);
 };
@@ -89,5 +89,40 @@ TEST_F(OffsetByteQueueTest, Trim) {
   EXPECT_TRUE(queue_->Trim(512));
 }
 
+TEST(OffsetByteQueueInPlaceTest, PushInPlace) {
+  uint8_t data[256];
+  for (int i = 0; i < 256; i++) {
+    data[i] = i;
+  }
+  OffsetByteQueue queue;
+  queue.PushInPlace(data, 128);
+  queue.PushInPlace(data + 128, 128);
+  queue.Pop(64);
+  EXPECT_EQ(64, queue.head());
+  EXPECT_EQ(256, queue.tail());
+
+  // The data is referenced instead of copied.
+  const uint8_t* buf;
+  int size;
+  queue.Peek(&buf, &size);
+  EXPECT_EQ(data + 64, buf);
+  EXPECT_EQ(192, size);
+  queue.PeekAt(200, &buf, &size);
+  EXPECT_EQ(data + 200, buf);
+  EXPECT_EQ(56, size);
+
+  EXPECT_TRUE(queue.Trim(256));
+  queue.Peek(&buf, &size);
+  EXPECT_EQ(NULL, buf);
+  EXPECT_FALSE(queue.Trim(257));
+
+  // Data can be copied again once the queue is empty.
+  queue.Push(data, 16);
+  queue.Peek(&buf, &size);
+  EXPECT_NE(data, buf);
+  EXPECT_EQ(16, size);
+  EXPECT_EQ(0, memcmp(data, buf, size));
+}
+
 }  // namespace media
 }  // namespace shaka
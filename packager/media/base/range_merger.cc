@@ -0,0 +1,90 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/range_merger.h"
+
+#include "packager/base/logging.h"
+#include "packager/status_macros.h"
+
+namespace shaka {
+namespace media {
+namespace {
+const size_t kStreamIndex = 0;
+}  // namespace
+
+RangeMerger::RangeMerger() = default;
+
+RangeMerger::~RangeMerger() = default;
+
+Status RangeMerger::InitializeInternal() {
+  if (num_input_streams() == 0 || next_output_stream_index() != 1) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Expects at least one input and exactly one output.");
+  }
+  ranges_ = std::vector<Range>(num_input_streams());
+  return Status::OK;
+}
+
+Status RangeMerger::Process(std::unique_ptr<StreamData> stream_data) {
+  const size_t range_index = stream_data->stream_index;
+  DCHECK_LT(range_index, ranges_.size());
+  if (range_index > 0 &&
+      stream_data->stream_data_type == StreamDataType::kStreamInfo) {
+    return Status::OK;
+  }
+  stream_data->stream_index = kStreamIndex;
+  {
+    base::AutoLock auto_lock(lock_);
+    if (range_index != current_range_ || dispatching_queued_ranges_) {
+      ranges_[range_index].queued_stream_data.push_back(
+          std::move(stream_data));
+      return Status::OK;
+    }
+  }
+  // Only the thread of |current_range_| gets here, so the downstream handlers
+  // are not called concurrently.
+  return Dispatch(std::move(stream_data));
+}
+
+Status RangeMerger::OnFlushRequest(size_t input_stream_index) {
+  DCHECK_LT(input_stream_index, ranges_.size());
+  {
+    base::AutoLock auto_lock(lock_);
+    ranges_[input_stream_index].flushed = true;
+    if (input_stream_index != current_range_ || dispatching_queued_ranges_)
+      return Status::OK;
+    dispatching_queued_ranges_ = true;
+  }
+  return DispatchQueuedRanges();
+}
+
+Status RangeMerger::DispatchQueuedRanges() {
+  while (true) {
+    std::unique_ptr<StreamData> stream_data;
+    {
+      base::AutoLock auto_lock(lock_);
+      DCHECK(dispatching_queued_ranges_);
+      Range& range = ranges_[current_range_];
+      if (!range.queued_stream_data.empty()) {
+        stream_data = std::move(range.queued_stream_data.front());
+        range.queued_stream_data.pop_front();
+      } else if (!range.flushed) {
+        // The thread of the range dispatches its stream data from now on.
+        dispatching_queued_ranges_ = false;
+        return Status::OK;
+      } else if (++current_range_ == ranges_.size()) {
+        break;
+      } else {
+        continue;
+      }
+    }
+    RETURN_IF_ERROR(Dispatch(std::move(stream_data)));
+  }
+  return FlushDownstream(kStreamIndex);
+}
+
+}  // namespace media
+}  // namespace shaka
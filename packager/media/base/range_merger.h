@@ -0,0 +1,73 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_RANGE_MERGER_H_
+#define PACKAGER_MEDIA_BASE_RANGE_MERGER_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "packager/base/synchronization/lock.h"
+#include "packager/media/base/media_handler.h"
+
+namespace shaka {
+namespace media {
+
+/// RangeMerger merges consecutive ranges of a stream, processed in parallel by
+/// separate chains of handlers running on different threads, back into a
+/// single stream. Input i receives the i-th range. The stream data of the
+/// ranges is dispatched downstream in range order: the data of the first
+/// unfinished range is dispatched directly by its thread, while the data of
+/// the following ranges is queued until all the preceding ranges are flushed,
+/// and then dispatched by the thread flushing the last of them.
+/// Only the stream info of the first range is dispatched; the ranges are
+/// expected to have the same stream info. The downstream handlers are flushed
+/// once, after all the ranges are flushed.
+/// Multiple inputs single output.
+class RangeMerger : public MediaHandler {
+ public:
+  RangeMerger();
+  ~RangeMerger() override;
+
+ protected:
+  /// @name MediaHandler implementation overrides.
+  /// @{
+  Status InitializeInternal() override;
+  Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
+  /// @}
+
+ private:
+  RangeMerger(const RangeMerger&) = delete;
+  RangeMerger& operator=(const RangeMerger&) = delete;
+
+  struct Range {
+    // Stream data waiting for the preceding ranges to be flushed.
+    std::deque<std::unique_ptr<StreamData>> queued_stream_data;
+    bool flushed = false;
+  };
+
+  // Dispatches the stream data queued for the ranges following a flushed
+  // current range, until reaching a range which is not flushed yet, whose
+  // thread then dispatches its stream data directly. Flushes downstream after
+  // the last range.
+  Status DispatchQueuedRanges();
+
+  base::Lock lock_;
+  std::vector<Range> ranges_;
+  // The range whose stream data is dispatched downstream.
+  size_t current_range_ = 0;
+  // Whether the queued stream data of |current_range_| is being dispatched by
+  // the thread which flushed the preceding range, in which case the thread of
+  // |current_range_| keeps queuing its stream data.
+  bool dispatching_queued_ranges_ = false;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_RANGE_MERGER_H_
@@ -0,0 +1,117 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/base/range_merger.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "packager/media/base/media_handler_test_base.h"
+#include "packager/status_test_util.h"
+
+using ::testing::_;
+
+namespace shaka {
+namespace media {
+namespace {
+const size_t kOneOutput = 1;
+const size_t kStreamIndex = 0;
+const size_t kNumRanges = 3;
+const uint32_t kTimeScale = 1000;
+const int64_t kDuration = 100;
+const bool kKeyFrame = true;
+const bool kEncrypted = true;
+const int kNumSamplesPerRange = 10;
+}  // namespace
+
+class RangeMergerTest : public MediaHandlerTestBase {
+ protected:
+  std::unique_ptr<StreamData> GetStreamInfoStreamData() {
+    return StreamData::FromStreamInfo(kStreamIndex,
+                                      GetVideoStreamInfo(kTimeScale));
+  }
+
+  std::unique_ptr<StreamData> GetSampleStreamData(size_t range, int index) {
+    const int64_t timestamp =
+        (range * kNumSamplesPerRange + index) * kDuration;
+    return StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(timestamp, kDuration, kKeyFrame));
+  }
+
+  // Dispatches the samples [|begin|, |end|) of |range|.
+  void DispatchSamples(size_t range, int begin, int end) {
+    for (int i = begin; i < end; ++i)
+      ASSERT_OK(Input(range)->Dispatch(GetSampleStreamData(range, i)));
+  }
+
+  void ExpectMergedStream() {
+    testing::InSequence s;
+    EXPECT_CALL(*Output(kStreamIndex),
+                OnProcess(IsStreamInfo(kStreamIndex, kTimeScale, !kEncrypted,
+                                       _)));
+    for (size_t i = 0; i < kNumRanges * kNumSamplesPerRange; ++i) {
+      EXPECT_CALL(*Output(kStreamIndex),
+                  OnProcess(IsMediaSample(kStreamIndex, i * kDuration,
+                                          kDuration, !kEncrypted, _)));
+    }
+    EXPECT_CALL(*Output(kStreamIndex), OnFlush(kStreamIndex));
+  }
+};
+
+TEST_F(RangeMergerTest, DispatchInRangeOrder) {
+  ASSERT_OK(SetUpAndInitializeGraph(std::make_shared<RangeMerger>(),
+                                    kNumRanges, kOneOutput));
+  ExpectMergedStream();
+
+  const int kHalf = kNumSamplesPerRange / 2;
+  // The ranges after the first one are queued, whether they are complete or
+  // not.
+  ASSERT_OK(Input(1)->Dispatch(GetStreamInfoStreamData()));
+  DispatchSamples(1, 0, kHalf);
+  ASSERT_OK(Input(2)->Dispatch(GetStreamInfoStreamData()));
+  DispatchSamples(2, 0, kNumSamplesPerRange);
+  ASSERT_OK(Input(2)->FlushAllDownstreams());
+
+  // The first range is dispatched directly, followed by the queued data of the
+  // second range once flushed.
+  ASSERT_OK(Input(0)->Dispatch(GetStreamInfoStreamData()));
+  DispatchSamples(0, 0, kNumSamplesPerRange);
+  ASSERT_OK(Input(0)->FlushAllDownstreams());
+
+  // The rest of the second range is dispatched directly, followed by the third
+  // range and the flush once flushed.
+  DispatchSamples(1, kHalf, kNumSamplesPerRange);
+  ASSERT_OK(Input(1)->FlushAllDownstreams());
+}
+
+TEST_F(RangeMergerTest, DispatchInRangeOrderFromMultipleThreads) {
+  ASSERT_OK(SetUpAndInitializeGraph(std::make_shared<RangeMerger>(),
+                                    kNumRanges, kOneOutput));
+  ExpectMergedStream();
+
+  std::vector<std::thread> threads;
+  for (size_t range = 0; range < kNumRanges; ++range) {
+    threads.emplace_back([this, range]() {
+      ASSERT_OK(Input(range)->Dispatch(GetStreamInfoStreamData()));
+      DispatchSamples(range, 0, kNumSamplesPerRange);
+      ASSERT_OK(Input(range)->FlushAllDownstreams());
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+TEST_F(RangeMergerTest, MultipleOutputsNotSupported) {
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            SetUpAndInitializeGraph(std::make_shared<RangeMerger>(),
+                                    kNumRanges, 2)
+                .error_code());
+}
+
+}  // namespace media
+}  // namespace shaka
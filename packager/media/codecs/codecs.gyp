@@ -53,6 +53,8 @@
         'nal_unit_to_byte_stream_converter.h',
         'nalu_reader.cc',
         'nalu_reader.h',
+        'start_code_finder.cc',
+        'start_code_finder.h',
         'video_slice_header_parser.cc',
         'video_slice_header_parser.h',
         'vp_codec_configuration_record.cc',
@@ -90,6 +92,7 @@
         'hls_audio_util_unittest.cc',
         'nal_unit_to_byte_stream_converter_unittest.cc',
         'nalu_reader_unittest.cc',
+        'start_code_finder_unittest.cc',
         'video_slice_header_parser_unittest.cc',
         'vp_codec_configuration_record_unittest.cc',
         'vp8_parser_unittest.cc',
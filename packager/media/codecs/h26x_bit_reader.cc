@@ -2,8 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
 #include "packager/base/logging.h"
 #include "packager/media/codecs/h26x_bit_reader.h"
+#include "packager/media/codecs/start_code_finder.h"
 
 namespace shaka {
 namespace media {
@@ -14,6 +17,9 @@ bool CheckAnyBitsSet(int byte, int valid_bits) {
   return (byte & ((1 << valid_bits) - 1)) != 0;
 }
 
+// Shorter skips are not worth a vectorized scan.
+const int kMinBytesToScan = 8;
+
 }  // namespace
 
 H26xBitReader::H26xBitReader()
@@ -96,6 +102,28 @@ bool H26xBitReader::ReadBits(int num_bits, int* out) {
 
 bool H26xBitReader::SkipBits(int num_bits) {
   int bits_left = num_bits;
+
+  // Skip whole bytes in one go if they contain no emulation prevention bytes,
+  // i.e. no pair of zero bytes precedes them. The last byte is loaded by
+  // UpdateCurrByte() below.
+  const int whole_bytes =
+      (bits_left - num_remaining_bits_in_curr_byte_ - 1) / 8;
+  if (whole_bytes >= kMinBytesToScan && (prev_two_bytes_ & 0xff) != 0) {
+    const size_t bytes_to_scan = static_cast<size_t>(
+        std::min(static_cast<off_t>(whole_bytes), bytes_left_));
+    const size_t zero_pair_offset = FindZeroBytePair(data_, bytes_to_scan);
+    const size_t bytes_to_skip = std::min(bytes_to_scan, zero_pair_offset + 2);
+    if (bytes_to_skip >= 2) {
+      bits_left -= num_remaining_bits_in_curr_byte_ +
+                   static_cast<int>(bytes_to_skip) * 8;
+      data_ += bytes_to_skip;
+      bytes_left_ -= bytes_to_skip;
+      curr_byte_ = data_[-1];
+      num_remaining_bits_in_curr_byte_ = 0;
+      prev_two_bytes_ = (data_[-2] << 8) | data_[-1];
+    }
+  }
+
   while (num_remaining_bits_in_curr_byte_ < bits_left) {
     bits_left -= num_remaining_bits_in_curr_byte_;
     if (!UpdateCurrByte())
@@ -4,11 +4,64 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "packager/media/codecs/h26x_bit_reader.h"
 
 namespace shaka {
 namespace media {
 
+namespace {
+
+// Skips |num_bits| by reading them, which loads one byte at a time, as
+// SkipBits() did before it skipped whole bytes at once.
+bool SkipBitsByReading(H26xBitReader* reader, int num_bits) {
+  int dummy;
+  while (num_bits > 0) {
+    const int bits_to_read = std::min(num_bits, 31);
+    if (!reader->ReadBits(bits_to_read, &dummy))
+      return false;
+    num_bits -= bits_to_read;
+  }
+  return true;
+}
+
+// Skips |num_bits| of |data| after |initial_bits|, with SkipBits() and by
+// reading them, and checks that the readers end up in the same state.
+void ExpectSkipBitsSameAsReading(const std::vector<uint8_t>& data,
+                                 int initial_bits,
+                                 int num_bits) {
+  H26xBitReader reader;
+  H26xBitReader expected_reader;
+  ASSERT_TRUE(reader.Initialize(data.data(), data.size()));
+  ASSERT_TRUE(expected_reader.Initialize(data.data(), data.size()));
+  if (!SkipBitsByReading(&expected_reader, initial_bits))
+    return;
+  ASSERT_TRUE(SkipBitsByReading(&reader, initial_bits));
+
+  const bool success = SkipBitsByReading(&expected_reader, num_bits);
+  ASSERT_EQ(success, reader.SkipBits(num_bits));
+  if (!success)
+    return;
+  EXPECT_EQ(expected_reader.NumBitsLeft(), reader.NumBitsLeft());
+  EXPECT_EQ(expected_reader.NumEmulationPreventionBytesRead(),
+            reader.NumEmulationPreventionBytesRead());
+  EXPECT_EQ(expected_reader.HasMoreRBSPData(), reader.HasMoreRBSPData());
+  // The bits after the skipped ones are the same, including across emulation
+  // prevention bytes.
+  int expected_value = 0;
+  int value = 0;
+  while (expected_reader.ReadBits(1, &expected_value)) {
+    ASSERT_TRUE(reader.ReadBits(1, &value));
+    EXPECT_EQ(expected_value, value);
+  }
+  EXPECT_FALSE(reader.ReadBits(1, &value));
+}
+
+}  // namespace
+
 TEST(H26xBitReaderTest, ReadStreamWithoutEscapeAndTrailingZeroBytes) {
   H26xBitReader reader;
   const unsigned char rbsp[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xa0};
@@ -130,5 +183,126 @@ TEST(H26xBitReaderTest, StopBitOccupyFullByte) {
   EXPECT_FALSE(reader.HasMoreRBSPData());
 }
 
+TEST(H26xBitReaderTest, SkipBitsLong) {
+  std::vector<uint8_t> rbsp(64);
+  for (size_t i = 0; i < rbsp.size(); ++i)
+    rbsp[i] = static_cast<uint8_t>(i + 1);
+  H26xBitReader reader;
+  int dummy = 0;
+
+  EXPECT_TRUE(reader.Initialize(rbsp.data(), rbsp.size()));
+  EXPECT_TRUE(reader.SkipBits(4));
+  EXPECT_TRUE(reader.SkipBits(50 * 8 + 2));
+  EXPECT_EQ(64 * 8 - 4 - 50 * 8 - 2, reader.NumBitsLeft());
+  // The last 2 bits of byte 50, 0x33, and the first 6 bits of byte 51, 0x34.
+  EXPECT_TRUE(reader.ReadBits(8, &dummy));
+  EXPECT_EQ(0xcd, dummy);
+  EXPECT_TRUE(reader.SkipBits(reader.NumBitsLeft()));
+  EXPECT_EQ(0, reader.NumBitsLeft());
+  EXPECT_FALSE(reader.SkipBits(1));
+
+  for (int num_bits = 0; num_bits <= 64 * 8 - 3; ++num_bits)
+    ExpectSkipBitsSameAsReading(rbsp, 3, num_bits);
+}
+
+// The emulation prevention byte, or the zero bytes before it, fall on both
+// sides of the boundaries of the blocks scanned for zero byte pairs.
+TEST(H26xBitReaderTest, SkipBitsOverEmulationPreventionByte) {
+  for (size_t position = 0; position < 40; ++position) {
+    std::vector<uint8_t> rbsp(64, 0xff);
+    rbsp[position] = 0x00;
+    rbsp[position + 1] = 0x00;
+    rbsp[position + 2] = 0x03;
+    rbsp[position + 3] = 0x01;
+    SCOPED_TRACE(position);
+
+    H26xBitReader reader;
+    EXPECT_TRUE(reader.Initialize(rbsp.data(), rbsp.size()));
+    EXPECT_TRUE(reader.SkipBits(1));
+    EXPECT_TRUE(reader.SkipBits(48 * 8));
+    EXPECT_EQ(1u, reader.NumEmulationPreventionBytesRead());
+    // The emulation prevention byte is not counted as skipped.
+    EXPECT_EQ(64 * 8 - 1 - 48 * 8 - 8, reader.NumBitsLeft());
+
+    for (int initial_bits : {0, 1, 7, 8}) {
+      for (int num_bits = 0; num_bits < 56 * 8; num_bits += 5)
+        ExpectSkipBitsSameAsReading(rbsp, initial_bits, num_bits);
+    }
+  }
+}
+
+TEST(H26xBitReaderTest, SkipBitsOverZeroBytePair) {
+  for (size_t position = 0; position < 40; ++position) {
+    std::vector<uint8_t> rbsp(64, 0xff);
+    rbsp[position] = 0x00;
+    rbsp[position + 1] = 0x00;
+    rbsp[position + 2] = 0x01;
+    SCOPED_TRACE(position);
+
+    H26xBitReader reader;
+    int dummy = 0;
+    EXPECT_TRUE(reader.Initialize(rbsp.data(), rbsp.size()));
+    EXPECT_TRUE(reader.SkipBits(1));
+    EXPECT_TRUE(reader.SkipBits((position + 2) * 8 - 1));
+    EXPECT_EQ(0u, reader.NumEmulationPreventionBytesRead());
+    EXPECT_TRUE(reader.ReadBits(8, &dummy));
+    EXPECT_EQ(0x01, dummy);
+
+    for (int initial_bits : {0, 1, 7, 8}) {
+      for (int num_bits = 0; num_bits < 56 * 8; num_bits += 5)
+        ExpectSkipBitsSameAsReading(rbsp, initial_bits, num_bits);
+    }
+  }
+}
+
+TEST(H26xBitReaderTest, SkipBitsToStartCodeAtEnd) {
+  std::vector<uint8_t> rbsp(32, 0xff);
+  rbsp.insert(rbsp.end(), {0x00, 0x00, 0x01});
+  H26xBitReader reader;
+
+  EXPECT_TRUE(reader.Initialize(rbsp.data(), rbsp.size()));
+  EXPECT_TRUE(reader.SkipBits(35 * 8));
+  EXPECT_EQ(0, reader.NumBitsLeft());
+  EXPECT_FALSE(reader.SkipBits(1));
+
+  EXPECT_TRUE(reader.Initialize(rbsp.data(), rbsp.size()));
+  EXPECT_FALSE(reader.SkipBits(35 * 8 + 1));
+
+  for (int num_bits = 0; num_bits <= 35 * 8; ++num_bits)
+    ExpectSkipBitsSameAsReading(rbsp, 0, num_bits);
+}
+
+TEST(H26xBitReaderTest, SkipBitsToEmulationPreventionByteAtEnd) {
+  std::vector<uint8_t> rbsp(32, 0xff);
+  rbsp.insert(rbsp.end(), {0x00, 0x00, 0x03});
+  H26xBitReader reader;
+
+  // The emulation prevention byte is not counted as data to skip.
+  EXPECT_TRUE(reader.Initialize(rbsp.data(), rbsp.size()));
+  EXPECT_TRUE(reader.SkipBits(34 * 8));
+  EXPECT_FALSE(reader.SkipBits(1));
+
+  for (int num_bits = 0; num_bits <= 35 * 8; ++num_bits)
+    ExpectSkipBitsSameAsReading(rbsp, 0, num_bits);
+}
+
+// Compares SkipBits() with reading the bits on random data made mostly of the
+// bytes which start codes and emulation prevention sequences are made of.
+TEST(H26xBitReaderTest, RandomSkipBitsSameAsReading) {
+  const uint8_t kBytes[] = {0x00, 0x00, 0x00, 0x01, 0x03, 0x80, 0xff};
+  std::mt19937 random_generator(1);
+  for (int i = 0; i < 2000; ++i) {
+    std::vector<uint8_t> rbsp(1 + random_generator() % 200);
+    for (uint8_t& byte : rbsp)
+      byte = kBytes[random_generator() % sizeof(kBytes)];
+    const int initial_bits = random_generator() % 16;
+    const int num_bits = random_generator() % (rbsp.size() * 8 + 8);
+    SCOPED_TRACE(i);
+    ExpectSkipBitsSameAsReading(rbsp, initial_bits, num_bits);
+    if (HasFatalFailure())
+      return;
+  }
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -14,6 +14,7 @@
 #include "packager/media/base/buffer_writer.h"
 #include "packager/media/base/macros.h"
 #include "packager/media/codecs/nalu_reader.h"
+#include "packager/media/codecs/start_code_finder.h"
 
 namespace shaka {
 namespace media {
@@ -65,8 +66,25 @@ void EscapeNalByteSequence(const uint8_t* input,
   // byte), so that the algorithm doesn't need to go back to check the same
   // bytes.
   int consecutive_zero_count = 0;
-  for (size_t i = 0; i < input_size; ++i) {
-    if (consecutive_zero_count <= 1) {
+  size_t i = 0;
+  while (i < input_size) {
+    if (consecutive_zero_count == 0) {
+      // Nothing needs escaping up to and including the next pair of zero
+      // bytes, so copy them in one go.
+      const size_t bytes_left = input_size - i;
+      const size_t zero_pair_offset = FindZeroBytePair(input + i, bytes_left);
+      if (zero_pair_offset == bytes_left) {
+        output_writer->AppendArray(input + i, bytes_left);
+        consecutive_zero_count = input[input_size - 1] == 0 ? 1 : 0;
+        break;
+      }
+      output_writer->AppendArray(input + i, zero_pair_offset + 2);
+      i += zero_pair_offset + 2;
+      consecutive_zero_count = 2;
+      continue;
+    }
+
+    if (consecutive_zero_count == 1) {
       output_writer->AppendInt(input[i]);
     } else if (consecutive_zero_count == 2) {
       if (input[i] == 0 || input[i] == 1 || input[i] == 2 || input[i] == 3) {
@@ -84,6 +102,7 @@ void EscapeNalByteSequence(const uint8_t* input,
     }
 
     consecutive_zero_count = input[i] == 0 ? consecutive_zero_count + 1 : 0;
+    ++i;
   }
 
   // ISO 14496-10 Section 7.4.1.1 mentions that if the last byte is 0 (which
@@ -11,6 +11,7 @@
 #include "packager/base/logging.h"
 #include "packager/media/base/buffer_reader.h"
 #include "packager/media/codecs/h264_parser.h"
+#include "packager/media/codecs/start_code_finder.h"
 
 namespace shaka {
 namespace media {
@@ -313,31 +314,26 @@ bool NaluReader::FindStartCode(const uint8_t* data,
                                uint64_t data_size,
                                uint64_t* offset,
                                uint8_t* start_code_size) {
-  uint64_t bytes_left = data_size;
-
-  while (bytes_left >= 3) {
-    if (IsStartCode(data)) {
-      // Found three-byte start code, set pointer at its beginning.
-      *offset = data_size - bytes_left;
-      *start_code_size = 3;
-
-      // If there is a zero byte before this start code,
-      // then it's actually a four-byte start code, so backtrack one byte.
-      if (*offset > 0 && *(data - 1) == 0x00) {
-        --(*offset);
-        ++(*start_code_size);
-      }
-
-      return true;
+  const uint64_t start_code_offset =
+      FindStartCodePrefix(data, static_cast<size_t>(data_size));
+  if (start_code_offset < data_size) {
+    // Found three-byte start code, set pointer at its beginning.
+    *offset = start_code_offset;
+    *start_code_size = 3;
+
+    // If there is a zero byte before this start code,
+    // then it's actually a four-byte start code, so backtrack one byte.
+    if (*offset > 0 && data[*offset - 1] == 0x00) {
+      --(*offset);
+      ++(*start_code_size);
     }
 
-    ++data;
-    --bytes_left;
+    return true;
   }
 
   // End of data: offset is pointing to the first byte that was not considered
   // as a possible start of a start code.
-  *offset = data_size - bytes_left;
+  *offset = data_size >= 2 ? data_size - 2 : 0;
   *start_code_size = 0;
   return false;
 }
@@ -0,0 +1,177 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/codecs/start_code_finder.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SHAKA_START_CODE_FINDER_SSE2
+#include <emmintrin.h>
+// AVX2 is selected at runtime, which needs the target attribute and
+// __builtin_cpu_supports().
+#if defined(__GNUC__) || defined(__clang__)
+#define SHAKA_START_CODE_FINDER_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__)
+#define SHAKA_START_CODE_FINDER_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace shaka {
+namespace media {
+namespace {
+
+typedef size_t (*FindFunction)(const uint8_t* data, size_t size);
+
+// The patterns are 0x0000 and, for start code prefixes, 0x000001.
+template <bool kStartCode>
+constexpr size_t PatternSize() {
+  return kStartCode ? 3 : 2;
+}
+
+template <bool kStartCode>
+size_t FindScalar(const uint8_t* data, size_t size, size_t offset) {
+  for (size_t i = offset; i + PatternSize<kStartCode>() <= size; ++i) {
+    if (data[i] == 0 && data[i + 1] == 0 && (!kStartCode || data[i + 2] == 1))
+      return i;
+  }
+  return size;
+}
+
+template <bool kStartCode>
+size_t FindScalar(const uint8_t* data, size_t size) {
+  return FindScalar<kStartCode>(data, size, 0);
+}
+
+#if defined(SHAKA_START_CODE_FINDER_SSE2) || \
+    defined(SHAKA_START_CODE_FINDER_AVX2)
+inline size_t CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+#if defined(SHAKA_START_CODE_FINDER_SSE2)
+// Compares 16 positions at a time, with one load for each byte of the
+// pattern.
+template <bool kStartCode>
+size_t FindSse2(const uint8_t* data, size_t size) {
+  const size_t kBlockSize = 16;
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi8(1);
+  size_t i = 0;
+  for (; i + kBlockSize + PatternSize<kStartCode>() - 1 <= size;
+       i += kBlockSize) {
+    const __m128i byte0 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const __m128i byte1 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+    __m128i matches =
+        _mm_and_si128(_mm_cmpeq_epi8(byte0, zero), _mm_cmpeq_epi8(byte1, zero));
+    if (kStartCode) {
+      const __m128i byte2 =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+      matches = _mm_and_si128(matches, _mm_cmpeq_epi8(byte2, one));
+    }
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return FindScalar<kStartCode>(data, size, i);
+}
+#endif  // defined(SHAKA_START_CODE_FINDER_SSE2)
+
+#if defined(SHAKA_START_CODE_FINDER_AVX2)
+template <bool kStartCode>
+__attribute__((target("avx2"))) size_t FindAvx2(const uint8_t* data,
+                                                 size_t size) {
+  const size_t kBlockSize = 32;
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi8(1);
+  size_t i = 0;
+  for (; i + kBlockSize + PatternSize<kStartCode>() - 1 <= size;
+       i += kBlockSize) {
+    const __m256i byte0 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    const __m256i byte1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+    __m256i matches = _mm256_and_si256(_mm256_cmpeq_epi8(byte0, zero),
+                                       _mm256_cmpeq_epi8(byte1, zero));
+    if (kStartCode) {
+      const __m256i byte2 =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 2));
+      matches = _mm256_and_si256(matches, _mm256_cmpeq_epi8(byte2, one));
+    }
+    const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return FindScalar<kStartCode>(data, size, i);
+}
+#endif  // defined(SHAKA_START_CODE_FINDER_AVX2)
+
+#if defined(SHAKA_START_CODE_FINDER_NEON)
+template <bool kStartCode>
+size_t FindNeon(const uint8_t* data, size_t size) {
+  const size_t kBlockSize = 16;
+  const uint8x16_t zero = vdupq_n_u8(0);
+  const uint8x16_t one = vdupq_n_u8(1);
+  size_t i = 0;
+  for (; i + kBlockSize + PatternSize<kStartCode>() - 1 <= size;
+       i += kBlockSize) {
+    uint8x16_t matches = vandq_u8(vceqq_u8(vld1q_u8(data + i), zero),
+                                  vceqq_u8(vld1q_u8(data + i + 1), zero));
+    if (kStartCode)
+      matches = vandq_u8(matches, vceqq_u8(vld1q_u8(data + i + 2), one));
+    if (vmaxvq_u8(matches) != 0) {
+      // The match is in this block.
+      return FindScalar<kStartCode>(
+          data, i + kBlockSize + PatternSize<kStartCode>() - 1, i);
+    }
+  }
+  return FindScalar<kStartCode>(data, size, i);
+}
+#endif  // defined(SHAKA_START_CODE_FINDER_NEON)
+
+template <bool kStartCode>
+FindFunction SelectFindFunction() {
+#if defined(SHAKA_START_CODE_FINDER_AVX2)
+  if (__builtin_cpu_supports("avx2"))
+    return &FindAvx2<kStartCode>;
+#endif
+#if defined(SHAKA_START_CODE_FINDER_SSE2)
+  return &FindSse2<kStartCode>;
+#elif defined(SHAKA_START_CODE_FINDER_NEON)
+  return &FindNeon<kStartCode>;
+#else
+  return &FindScalar<kStartCode>;
+#endif
+}
+
+}  // namespace
+
+size_t FindStartCodePrefix(const uint8_t* data, size_t size) {
+  static const FindFunction find_function = SelectFindFunction<true>();
+  return find_function(data, size);
+}
+
+size_t FindZeroBytePair(const uint8_t* data, size_t size) {
+  static const FindFunction find_function = SelectFindFunction<false>();
+  return find_function(data, size);
+}
+
+}  // namespace media
+}  // namespace shaka
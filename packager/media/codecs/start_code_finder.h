@@ -0,0 +1,39 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Vectorized byte pattern searches for H.26x Annex B byte streams.
+
+#ifndef PACKAGER_MEDIA_CODECS_START_CODE_FINDER_H_
+#define PACKAGER_MEDIA_CODECS_START_CODE_FINDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace shaka {
+namespace media {
+
+/// Finds the first three-byte start code prefix, i.e. 0x000001.
+/// The search uses SIMD instructions where available, selected at runtime on
+/// x86, with a scalar fallback.
+/// @param data points to the bytes to search.
+/// @param size is the number of bytes to search.
+/// @return The offset of the first start code prefix in @a data, or @a size
+///         if there is none.
+size_t FindStartCodePrefix(const uint8_t* data, size_t size);
+
+/// Finds the first pair of zero bytes. The bytes before it need no emulation
+/// prevention, and contain neither start codes nor emulation prevention
+/// bytes.
+/// @param data points to the bytes to search.
+/// @param size is the number of bytes to search.
+/// @return The offset of the first pair of zero bytes in @a data, or @a size
+///         if there is none.
+size_t FindZeroBytePair(const uint8_t* data, size_t size);
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CODECS_START_CODE_FINDER_H_
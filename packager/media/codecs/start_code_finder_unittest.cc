@@ -0,0 +1,139 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/media/codecs/start_code_finder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "packager/base/logging.h"
+#include "packager/base/time/time.h"
+#include "packager/media/test/test_data_util.h"
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Longer than two AVX2 blocks, so that matches at every position of a block
+// and in the scalar tail are covered.
+const size_t kMaxSize = 80;
+
+size_t ReferenceFindStartCodePrefix(const uint8_t* data, size_t size) {
+  for (size_t i = 0; i + 3 <= size; ++i) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+      return i;
+  }
+  return size;
+}
+
+size_t ReferenceFindZeroBytePair(const uint8_t* data, size_t size) {
+  for (size_t i = 0; i + 2 <= size; ++i) {
+    if (data[i] == 0 && data[i + 1] == 0)
+      return i;
+  }
+  return size;
+}
+
+}  // namespace
+
+TEST(StartCodeFinderTest, EmptyInput) {
+  EXPECT_EQ(0u, FindStartCodePrefix(nullptr, 0));
+  EXPECT_EQ(0u, FindZeroBytePair(nullptr, 0));
+}
+
+TEST(StartCodeFinderTest, NoMatch) {
+  const uint8_t kData[] = {0x00, 0x02, 0x00, 0x00, 0x02, 0x01, 0x00, 0x00};
+  EXPECT_EQ(sizeof(kData), FindStartCodePrefix(kData, sizeof(kData)));
+  // A zero pair cut off by |size| does not match.
+  EXPECT_EQ(3u, FindZeroBytePair(kData, 3));
+}
+
+TEST(StartCodeFinderTest, FindsEachPositionAndSize) {
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t position = 0; position + 3 <= size; ++position) {
+      // Surround the buffer so that the searches must honor |size|.
+      std::vector<uint8_t> buffer(size + 3, 0xff);
+      buffer[size] = buffer[size + 1] = 0x00;
+      buffer[size + 2] = 0x01;
+      buffer[position] = buffer[position + 1] = 0x00;
+      buffer[position + 2] = 0x01;
+
+      EXPECT_EQ(position, FindStartCodePrefix(buffer.data(), size))
+          << "size " << size;
+      EXPECT_EQ(position, FindZeroBytePair(buffer.data(), size))
+          << "size " << size;
+    }
+    std::vector<uint8_t> buffer(size + 3, 0x01);
+    buffer[size] = buffer[size + 1] = 0x00;
+    EXPECT_EQ(size, FindStartCodePrefix(buffer.data(), size));
+    EXPECT_EQ(size, FindZeroBytePair(buffer.data(), size));
+  }
+}
+
+TEST(StartCodeFinderTest, MatchesReferenceOnRandomData) {
+  std::mt19937 generator(2018);
+  // Draw mostly zeros and ones so that partial matches are common.
+  const uint8_t kValues[] = {0x00, 0x01, 0x80};
+  std::discrete_distribution<int> distribution({4, 2, 1});
+  std::vector<uint8_t> data(4096);
+  for (uint8_t& byte : data)
+    byte = kValues[distribution(generator)];
+
+  const size_t kSizes[] = {1, 5, 17, 33, 200};
+  for (size_t offset = 0; offset < data.size(); offset += 7) {
+    for (size_t max_size : kSizes) {
+      const size_t size = std::min(max_size, data.size() - offset);
+      const uint8_t* begin = data.data() + offset;
+      EXPECT_EQ(ReferenceFindStartCodePrefix(begin, size),
+                FindStartCodePrefix(begin, size));
+      EXPECT_EQ(ReferenceFindZeroBytePair(begin, size),
+                FindZeroBytePair(begin, size));
+    }
+  }
+}
+
+// Run with --gtest_also_run_disabled_tests to compare the SIMD search against
+// the byte-by-byte reference on the test streams.
+TEST(StartCodeFinderBenchmark, DISABLED_TestStreams) {
+  const int kIterations = 2000;
+  for (const char* file_name :
+       {"bear-640x360.ts", "bear-640x360-hevc.ts", "bear.h264"}) {
+    const std::vector<uint8_t> data = ReadTestDataFile(file_name);
+    ASSERT_FALSE(data.empty());
+
+    size_t num_start_codes = 0;
+    size_t reference_num_start_codes = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      for (size_t offset = 0; offset < data.size(); offset += 3) {
+        offset += FindStartCodePrefix(data.data() + offset,
+                                      data.size() - offset);
+        ++num_start_codes;
+      }
+    }
+    const base::TimeDelta time = base::TimeTicks::Now() - start;
+    start = base::TimeTicks::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      for (size_t offset = 0; offset < data.size(); offset += 3) {
+        offset += ReferenceFindStartCodePrefix(data.data() + offset,
+                                               data.size() - offset);
+        ++reference_num_start_codes;
+      }
+    }
+    const base::TimeDelta reference_time = base::TimeTicks::Now() - start;
+
+    EXPECT_EQ(reference_num_start_codes, num_start_codes);
+    LOG(INFO) << file_name << ": " << time.InMilliseconds()
+              << " ms, reference: " << reference_time.InMilliseconds()
+              << " ms.";
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -13,6 +13,7 @@
 
 #include "packager/media/base/aes_encryptor.h"
 #include "packager/media/base/audio_stream_info.h"
+#include "packager/media/base/buffer_pool.h"
 #include "packager/media/base/common_pssh_generator.h"
 #include "packager/media/base/key_source.h"
 #include "packager/media/base/macros.h"
@@ -227,7 +228,10 @@ Status EncryptionHandler::ProcessStreamInfo(const StreamInfo& clear_info) {
       subsample_generator_->Initialize(protection_scheme_, *stream_info));
 
   remaining_clear_lead_ =
-      encryption_params_.clear_lead_in_seconds * stream_info->time_scale();
+      range_start_
+          ? range_start_->remaining_clear_lead
+          : static_cast<int64_t>(encryption_params_.clear_lead_in_seconds *
+                                 stream_info->time_scale());
   crypto_period_duration_ =
       encryption_params_.crypto_period_duration_in_seconds *
       stream_info->time_scale();
@@ -251,8 +255,18 @@ Status EncryptionHandler::ProcessStreamInfo(const StreamInfo& clear_info) {
   } else {
     RETURN_IF_ERROR(key_source_->GetKey(stream_label_, &encryption_key));
   }
+  if (range_start_) {
+    if (key_rotation_enabled) {
+      return Status(error::UNIMPLEMENTED,
+                    "Key rotation is not supported when encrypting a range.");
+    }
+    if (encryption_key.iv.empty())
+      encryption_key.iv = range_start_->iv;
+  }
   if (!CreateEncryptor(encryption_key))
     return Status(error::ENCRYPTION_FAILURE, "Failed to create encryptor");
+  if (range_start_)
+    RETURN_IF_ERROR(AdvanceIvToRangeStart());
 
   stream_info->set_is_encrypted(true);
   stream_info->set_has_clear_lead(encryption_params_.clear_lead_in_seconds > 0);
@@ -299,22 +313,44 @@ Status EncryptionHandler::ProcessMediaSample(
     return DispatchMediaSample(kStreamIndex, std::move(clear_sample));
   }
 
-  std::shared_ptr<uint8_t> cipher_sample_data(
-      new uint8_t[clear_sample->data_size()], std::default_delete<uint8_t[]>());
+  // If the handler holds the only reference to |clear_sample|, i.e. there is
+  // no fan-out upstream, the sample is reused and, if it is also the only
+  // owner of its data, encrypted in place. Otherwise the encrypted data goes
+  // to a new buffer, leaving the clear data untouched for the other owners.
+  std::shared_ptr<MediaSample> cipher_sample;
+  uint8_t* dest = nullptr;
+  if (clear_sample.use_count() == 1) {
+    // All MediaSample factory methods create mutable samples.
+    cipher_sample = std::const_pointer_cast<MediaSample>(clear_sample);
+    dest = cipher_sample->writable_data();
+  } else {
+    cipher_sample = clear_sample->Clone();
+  }
+  std::shared_ptr<uint8_t> cipher_sample_data;
+  if (!dest) {
+    cipher_sample_data =
+        BufferPool::GetInstance()->Allocate(clear_sample->data_size());
+    dest = cipher_sample_data.get();
+  }
+  const bool in_place = !cipher_sample_data;
 
   const uint8_t* source = clear_sample->data();
-  uint8_t* dest = cipher_sample_data.get();
+  // The encrypted bytes of all the subsamples are passed to the encryptor
+  // together, so independent cipher block chains, e.g. subsamples with
+  // constant iv, can be interleaved.
+  AesCryptor::CryptChain crypt_chain;
   if (!subsamples.empty()) {
     size_t total_size = 0;
     for (const SubsampleEntry& subsample : subsamples) {
       if (subsample.clear_bytes > 0) {
-        memcpy(dest, source, subsample.clear_bytes);
+        if (!in_place)
+          memcpy(dest, source, subsample.clear_bytes);
         source += subsample.clear_bytes;
         dest += subsample.clear_bytes;
         total_size += subsample.clear_bytes;
       }
       if (subsample.cipher_bytes > 0) {
-        EncryptBytes(source, subsample.cipher_bytes, dest);
+        crypt_chain.push_back({source, subsample.cipher_bytes, dest});
         source += subsample.cipher_bytes;
         dest += subsample.cipher_bytes;
         total_size += subsample.cipher_bytes;
@@ -322,12 +358,17 @@ Status EncryptionHandler::ProcessMediaSample(
     }
     DCHECK_EQ(total_size, clear_sample->data_size());
   } else {
-    EncryptBytes(source, clear_sample->data_size(), dest);
+    crypt_chain.push_back({source, clear_sample->data_size(), dest});
   }
+  EncryptChain(crypt_chain);
 
-  std::shared_ptr<MediaSample> cipher_sample(clear_sample->Clone());
-  cipher_sample->TransferData(std::move(cipher_sample_data),
-                              clear_sample->data_size());
+  if (!in_place) {
+    cipher_sample->TransferData(std::move(cipher_sample_data),
+                                clear_sample->data_size());
+  }
+  // Release the reference to the clear sample, so |cipher_sample| is uniquely
+  // owned downstream if it was reused.
+  clear_sample.reset();
 
   // Finish initializing the sample before sending it downstream. We must
   // wait until now to finish the initialization as we will lose access to
@@ -384,13 +425,30 @@ bool EncryptionHandler::CreateEncryptor(const EncryptionKey& encryption_key) {
   return status.ok();
 }
 
-void EncryptionHandler::EncryptBytes(const uint8_t* source,
-                                     size_t source_size,
-                                     uint8_t* dest) {
-  DCHECK(source);
-  DCHECK(dest);
+Status EncryptionHandler::AdvanceIvToRangeStart() {
+  DCHECK(encryptor_);
+  DCHECK(range_start_);
+  if (range_start_->num_encrypted_samples == 0 ||
+      encryptor_->use_constant_iv()) {
+    return Status::OK;
+  }
+  // 16-byte ivs are advanced by the number of blocks encrypted in each sample,
+  // which depends on the sample data, see AesCryptor::UpdateIv().
+  std::vector<uint8_t> iv = encryptor_->iv();
+  if (iv.size() != 8) {
+    return Status(error::UNIMPLEMENTED,
+                  "Only 8-byte per-sample ivs can be advanced to the start of "
+                  "a range.");
+  }
+  AesCryptor::IncrementIv(range_start_->num_encrypted_samples, &iv);
+  if (!encryptor_->SetIv(iv))
+    return Status(error::ENCRYPTION_FAILURE, "Failed to set iv.");
+  return Status::OK;
+}
+
+void EncryptionHandler::EncryptChain(const AesCryptor::CryptChain& chain) {
   DCHECK(encryptor_);
-  CHECK(encryptor_->Crypt(source, source_size, dest));
+  CHECK(encryptor_->CryptChains(std::vector<AesCryptor::CryptChain>(1, chain)));
 }
 
 void EncryptionHandler::InjectSubsampleGeneratorForTesting(
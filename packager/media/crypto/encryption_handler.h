@@ -7,6 +7,10 @@
 #ifndef PACKAGER_MEDIA_CRYPTO_ENCRYPTION_HANDLER_H_
 #define PACKAGER_MEDIA_CRYPTO_ENCRYPTION_HANDLER_H_
 
+#include <vector>
+
+#include "packager/base/optional.h"
+#include "packager/media/base/aes_cryptor.h"
 #include "packager/media/base/key_source.h"
 #include "packager/media/base/media_handler.h"
 #include "packager/media/public/crypto_params.h"
@@ -14,11 +18,25 @@
 namespace shaka {
 namespace media {
 
-class AesCryptor;
 class AesEncryptorFactory;
 class SubsampleGenerator;
 struct EncryptionKey;
 
+/// The encryption state of a stream at the start of a range of its segments.
+/// It allows encrypting the range separately from the preceding segments, e.g.
+/// in parallel with them, with the same result as encrypting the whole stream.
+struct EncryptionRangeStart {
+  /// The number of samples encrypted before the range, by which the per-sample
+  /// iv is advanced.
+  uint64_t num_encrypted_samples = 0;
+  /// The clear lead remaining at the start of the range, in the stream's time
+  /// scale.
+  int64_t remaining_clear_lead = 0;
+  /// The iv to use if the encryption key does not come with one, instead of a
+  /// random iv. It must be the same for all the ranges of a stream.
+  std::vector<uint8_t> iv;
+};
+
 class EncryptionHandler : public MediaHandler {
  public:
   EncryptionHandler(const EncryptionParams& encryption_params,
@@ -26,6 +44,14 @@ class EncryptionHandler : public MediaHandler {
 
   ~EncryptionHandler() override;
 
+  /// Encrypt a range of segments of the stream instead of the whole stream.
+  /// Must be called before the stream info is received. Key rotation is not
+  /// supported, nor are 16-byte per-sample ivs unless the range starts with
+  /// the first encrypted sample.
+  void set_range_start(const EncryptionRangeStart& range_start) {
+    range_start_ = range_start;
+  }
+
  protected:
   /// @name MediaHandler implementation overrides.
   /// @{
@@ -46,14 +72,17 @@ class EncryptionHandler : public MediaHandler {
 
   void SetupProtectionPattern(StreamType stream_type);
   bool CreateEncryptor(const EncryptionKey& encryption_key);
+  // Advances the iv of the encryptor to the start of |range_start_|.
+  Status AdvanceIvToRangeStart();
   // Encrypt an E-AC3 frame with size |source_size| according to SAMPLE-AES
   // specification. |dest| should have at least |source_size| bytes.
   bool SampleAesEncryptEac3Frame(const uint8_t* source,
                                  size_t source_size,
                                  uint8_t* dest);
-  // Encrypt an array with size |source_size|. |dest| should have at
-  // least |source_size| bytes.
-  void EncryptBytes(const uint8_t* source, size_t source_size, uint8_t* dest);
+  // Encrypt the segments in |chain| as if SetIv(iv()) was called and Crypt
+  // was then called on each of them in order, i.e. the chain restarts from the
+  // encryptor iv, see AesCryptor::CryptChains.
+  void EncryptChain(const AesCryptor::CryptChain& chain);
 
   // An E-AC3 frame comprises of one or more syncframes. This function extracts
   // the syncframe sizes from the source bytes.
@@ -83,6 +112,8 @@ class EncryptionHandler : public MediaHandler {
   // Previous crypto period index if key rotation is enabled.
   int64_t prev_crypto_period_index_ = -1;
   bool check_new_crypto_period_ = false;
+  // Set if only a range of the stream is encrypted.
+  base::Optional<EncryptionRangeStart> range_start_;
 
   std::unique_ptr<SubsampleGenerator> subsample_generator_;
   std::unique_ptr<AesEncryptorFactory> encryptor_factory_;
@@ -559,6 +559,210 @@ TEST_P(EncryptionHandlerSubsampleTest, SubsampleTest) {
   EXPECT_EQ(GetParam().subsamples, decrypt_config.subsamples());
 }
 
+class EncryptionHandlerInPlaceTest : public EncryptionHandlerTest {
+ public:
+  void SetUp() override {
+    EncryptionHandlerTest::SetUp();
+
+    std::unique_ptr<MockAesCryptor> mock_encryptor(new MockAesCryptor);
+    EXPECT_CALL(*mock_encryptor, CryptInternal(_, _, _, _))
+        .WillRepeatedly(Invoke(MockEncrypt));
+    ASSERT_TRUE(mock_encryptor->SetIv(
+        std::vector<uint8_t>(std::begin(kIv), std::end(kIv))));
+
+    std::unique_ptr<MockAesEncryptorFactory> mock_encryptor_factory(
+        new MockAesEncryptorFactory);
+    EXPECT_CALL(*mock_encryptor_factory, CreateEncryptor(_, _, _, _, _, _))
+        .WillOnce(Return(ByMove(std::move(mock_encryptor))));
+    InjectEncryptorFactoryForTesting(std::move(mock_encryptor_factory));
+
+    EXPECT_CALL(mock_key_source_, GetKey(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(GetMockEncryptionKey()),
+                        Return(Status::OK)));
+    ASSERT_OK(Process(StreamData::FromStreamInfo(
+        kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+    ClearOutputStreamDataVector();
+  }
+
+  const std::vector<uint8_t> kExpectedOutput = {
+      0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19};
+};
+
+TEST_F(EncryptionHandlerInPlaceTest, UniquelyOwnedSampleEncryptedInPlace) {
+  std::shared_ptr<MediaSample> sample =
+      GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize);
+  const MediaSample* sample_ptr = sample.get();
+  const uint8_t* data_ptr = sample->data();
+  ASSERT_OK(Process(StreamData::FromMediaSample(kStreamIndex,
+                                                std::move(sample))));
+
+  const auto& output_stream_data = GetOutputStreamDataVector();
+  ASSERT_EQ(1u, output_stream_data.size());
+  const MediaSample& output_sample = *output_stream_data[0]->media_sample;
+  EXPECT_EQ(sample_ptr, &output_sample);
+  EXPECT_EQ(data_ptr, output_sample.data());
+  EXPECT_TRUE(output_sample.is_encrypted());
+  EXPECT_EQ(kExpectedOutput,
+            std::vector<uint8_t>(output_sample.data(),
+                                 output_sample.data() +
+                                     output_sample.data_size()));
+}
+
+TEST_F(EncryptionHandlerInPlaceTest, SharedSampleNotModified) {
+  std::shared_ptr<MediaSample> sample =
+      GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize);
+  ASSERT_OK(Process(StreamData::FromMediaSample(kStreamIndex, sample)));
+
+  const auto& output_stream_data = GetOutputStreamDataVector();
+  ASSERT_EQ(1u, output_stream_data.size());
+  const MediaSample& output_sample = *output_stream_data[0]->media_sample;
+  EXPECT_NE(sample.get(), &output_sample);
+  EXPECT_TRUE(output_sample.is_encrypted());
+  EXPECT_EQ(kExpectedOutput,
+            std::vector<uint8_t>(output_sample.data(),
+                                 output_sample.data() +
+                                     output_sample.data_size()));
+
+  // The original sample is left untouched.
+  EXPECT_FALSE(sample->is_encrypted());
+  EXPECT_EQ(std::vector<uint8_t>(kData, kData + kDataSize),
+            std::vector<uint8_t>(sample->data(),
+                                 sample->data() + sample->data_size()));
+}
+
+TEST_F(EncryptionHandlerInPlaceTest, SharedSampleDataNotModified) {
+  std::shared_ptr<MediaSample> sample =
+      GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize);
+  std::shared_ptr<MediaSample> clone = sample->Clone();
+  const MediaSample* sample_ptr = sample.get();
+  ASSERT_OK(Process(StreamData::FromMediaSample(kStreamIndex,
+                                                std::move(sample))));
+
+  const auto& output_stream_data = GetOutputStreamDataVector();
+  ASSERT_EQ(1u, output_stream_data.size());
+  const MediaSample& output_sample = *output_stream_data[0]->media_sample;
+  // The sample object is reused, but not its data, which is shared with
+  // |clone|.
+  EXPECT_EQ(sample_ptr, &output_sample);
+  EXPECT_NE(clone->data(), output_sample.data());
+  EXPECT_EQ(kExpectedOutput,
+            std::vector<uint8_t>(output_sample.data(),
+                                 output_sample.data() +
+                                     output_sample.data_size()));
+  EXPECT_EQ(std::vector<uint8_t>(kData, kData + kDataSize),
+            std::vector<uint8_t>(clone->data(),
+                                 clone->data() + clone->data_size()));
+}
+
+class EncryptionHandlerRangeTest : public EncryptionHandlerTest {
+ protected:
+  EncryptionKey GetEncryptionKey(size_t iv_size) {
+    EncryptionKey encryption_key = GetMockEncryptionKey();
+    encryption_key.iv.resize(iv_size);
+    return encryption_key;
+  }
+
+  // Encrypts the samples [|first_sample|, |end_sample|) of a stream, as a range
+  // if |range_start| is not null, and returns the encrypted samples.
+  std::vector<std::shared_ptr<const MediaSample>> EncryptSamples(
+      size_t first_sample,
+      size_t end_sample,
+      const EncryptionRangeStart* range_start) {
+    SetUpEncryptionHandler(EncryptionParams());
+    if (range_start)
+      encryption_handler_->set_range_start(*range_start);
+    EXPECT_OK(Process(StreamData::FromStreamInfo(
+        kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+    for (size_t i = first_sample; i < end_sample; ++i) {
+      EXPECT_OK(Process(StreamData::FromMediaSample(
+          kStreamIndex, GetMediaSample(i * kSampleDuration, kSampleDuration,
+                                       kIsKeyFrame, kData, kDataSize))));
+    }
+    std::vector<std::shared_ptr<const MediaSample>> samples;
+    for (const auto& stream_data : GetOutputStreamDataVector()) {
+      if (stream_data->stream_data_type == StreamDataType::kMediaSample)
+        samples.push_back(stream_data->media_sample);
+    }
+    return samples;
+  }
+
+  void ExpectSameEncryptedSamples(
+      const std::vector<std::shared_ptr<const MediaSample>>& expected_samples,
+      const std::vector<std::shared_ptr<const MediaSample>>& samples) {
+    ASSERT_EQ(expected_samples.size(), samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+      ASSERT_TRUE(samples[i]->is_encrypted());
+      EXPECT_EQ(expected_samples[i]->decrypt_config()->iv(),
+                samples[i]->decrypt_config()->iv());
+      EXPECT_EQ(std::vector<uint8_t>(expected_samples[i]->data(),
+                                     expected_samples[i]->data() +
+                                         expected_samples[i]->data_size()),
+                std::vector<uint8_t>(samples[i]->data(),
+                                     samples[i]->data() +
+                                         samples[i]->data_size()));
+    }
+  }
+};
+
+TEST_F(EncryptionHandlerRangeTest, AdvancesIv) {
+  const size_t kIvSize = 8;
+  EXPECT_CALL(mock_key_source_, GetKey(_, _))
+      .WillRepeatedly(DoAll(SetArgPointee<1>(GetEncryptionKey(kIvSize)),
+                            Return(Status::OK)));
+  const auto stream_samples = EncryptSamples(0, 5, nullptr);
+  ASSERT_EQ(5u, stream_samples.size());
+
+  EncryptionRangeStart range_start;
+  range_start.num_encrypted_samples = 3;
+  ExpectSameEncryptedSamples(
+      std::vector<std::shared_ptr<const MediaSample>>(
+          stream_samples.begin() + 3, stream_samples.end()),
+      EncryptSamples(3, 5, &range_start));
+}
+
+TEST_F(EncryptionHandlerRangeTest, UsesRangeIvIfKeyHasNoIv) {
+  const size_t kNoIv = 0;
+  EXPECT_CALL(mock_key_source_, GetKey(_, _))
+      .WillRepeatedly(DoAll(SetArgPointee<1>(GetEncryptionKey(kNoIv)),
+                            Return(Status::OK)));
+  EncryptionRangeStart range_start;
+  range_start.iv.assign(kIv, kIv + 8);
+  const auto stream_samples = EncryptSamples(0, 5, &range_start);
+  ASSERT_EQ(5u, stream_samples.size());
+  EXPECT_EQ(range_start.iv, stream_samples[0]->decrypt_config()->iv());
+
+  range_start.num_encrypted_samples = 2;
+  ExpectSameEncryptedSamples(
+      std::vector<std::shared_ptr<const MediaSample>>(
+          stream_samples.begin() + 2, stream_samples.end()),
+      EncryptSamples(2, 5, &range_start));
+}
+
+TEST_F(EncryptionHandlerRangeTest, RemainingClearLead) {
+  const size_t kIvSize = 8;
+  EXPECT_CALL(mock_key_source_, GetKey(_, _))
+      .WillRepeatedly(DoAll(SetArgPointee<1>(GetEncryptionKey(kIvSize)),
+                            Return(Status::OK)));
+  EncryptionRangeStart range_start;
+  range_start.remaining_clear_lead = kSampleDuration;
+  const auto samples = EncryptSamples(3, 5, &range_start);
+  ASSERT_EQ(2u, samples.size());
+  EXPECT_FALSE(samples[0]->is_encrypted());
+  EXPECT_FALSE(samples[1]->is_encrypted());
+}
+
+TEST_F(EncryptionHandlerRangeTest, SixteenByteIvNotAdvanced) {
+  const size_t kIvSize = 16;
+  EXPECT_CALL(mock_key_source_, GetKey(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(GetEncryptionKey(kIvSize)),
+                      Return(Status::OK)));
+  EncryptionRangeStart range_start;
+  range_start.num_encrypted_samples = 3;
+  encryption_handler_->set_range_start(range_start);
+  ASSERT_NOT_OK(Process(StreamData::FromStreamInfo(
+      kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+}
+
 class EncryptionHandlerTrackTypeTest : public EncryptionHandlerTest {};
 
 TEST_F(EncryptionHandlerTrackTypeTest, AudioTrackType) {
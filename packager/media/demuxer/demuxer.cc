@@ -6,7 +6,10 @@
 
 #include "packager/media/demuxer/demuxer.h"
 
+#include <gflags/gflags.h>
+
 #include <algorithm>
+#include <set>
 
 #include "packager/base/bind.h"
 #include "packager/base/logging.h"
@@ -22,6 +25,19 @@
 #include "packager/media/formats/webm/webm_media_parser.h"
 #include "packager/media/formats/wvm/wvm_media_parser.h"
 
+DEFINE_bool(mmap_input,
+            false,
+            "Map local MP4 input files into memory and parse them in place, "
+            "with the media samples referencing the mapped file instead of "
+            "copies of the data. Input files must not be truncated while "
+            "being packaged.");
+DEFINE_bool(mp4_random_access,
+            false,
+            "Read the samples of local non-fragmented MP4 input files at "
+            "their offsets in the sample tables instead of reading the files "
+            "sequentially. Only the data of the selected streams is read. "
+            "Ignored with --mmap_input.");
+
 namespace {
 // 65KB, sufficient to determine the container and likely all init data.
 const size_t kInitBufSize = 0x10000;
@@ -109,6 +125,26 @@ Status Demuxer::Run() {
     }
   }
 
+  // Reading the whole file to demux a range of it is wasteful, so ranges imply
+  // random access.
+  if (container_name_ == CONTAINER_MOV &&
+      (FLAGS_mp4_random_access || !dts_ranges_.empty()) && !mapped_file_ &&
+      File::IsLocalRegularFile(file_name_.c_str())) {
+    std::set<uint32_t> track_ids;
+    for (const auto& pair : track_id_to_stream_index_map_) {
+      if (pair.second != kInvalidStreamIndex)
+        track_ids.insert(pair.first);
+    }
+    mp4::MP4MediaParser* mp4_parser =
+        static_cast<mp4::MP4MediaParser*>(parser_.get());
+    random_access_ = mp4_parser->EnableRandomAccess(file_name_, track_ids);
+    if (random_access_) {
+      for (const auto& pair : dts_ranges_)
+        mp4_parser->SetDtsRange(pair.first, pair.second.first,
+                                pair.second.second);
+    }
+  }
+
   while (!cancelled_ && status.ok())
     status.Update(Parse());
   if (cancelled_ && status.ok())
@@ -139,6 +175,13 @@ Status Demuxer::SetHandler(const std::string& stream_label,
   return MediaHandler::SetHandler(stream_index, std::move(handler));
 }
 
+void Demuxer::SetDtsRange(uint32_t track_id,
+                          int64_t start_dts,
+                          int64_t end_dts) {
+  DCHECK_LE(start_dts, end_dts);
+  dts_ranges_[track_id] = std::make_pair(start_dts, end_dts);
+}
+
 void Demuxer::SetLanguageOverride(const std::string& stream_label,
                                   const std::string& language_override) {
   size_t stream_index = kInvalidStreamIndex;
@@ -149,7 +192,7 @@ void Demuxer::SetLanguageOverride(const std::string& stream_label,
 
 Demuxer::QueuedSample::QueuedSample(uint32_t local_track_id,
                                     std::shared_ptr<MediaSample> local_sample)
-    : track_id(local_track_id), sample(local_sample) {}
+    : track_id(local_track_id), sample(std::move(local_sample)) {}
 
 Demuxer::QueuedSample::~QueuedSample() {}
 
@@ -223,6 +266,19 @@ Status Demuxer::InitializeParser() {
     // TODO(kqyang): Investigate whether we can reuse the existing file
     // descriptor |media_file_| instead of opening the same file again.
     static_cast<mp4::MP4MediaParser*>(parser_.get())->LoadMoov(file_name_);
+
+    if (FLAGS_mmap_input) {
+      mapped_file_ =
+          File::MapLocalFile(file_name_.c_str(), &mapped_file_size_);
+      if (mapped_file_) {
+        static_cast<mp4::MP4MediaParser*>(parser_.get())
+            ->SetMappedInput(mapped_file_);
+        // Parse() will start from the beginning of the mapped file.
+        return Status::OK;
+      }
+      LOG(WARNING) << "Cannot map file " << file_name_
+                   << ". Reading it instead.";
+    }
   }
   if (!parser_->Parse(buffer_.get(), bytes_read)) {
     return Status(error::PARSER_FAILURE,
@@ -295,30 +351,31 @@ void Demuxer::ParserInitEvent(
 }
 
 bool Demuxer::NewSampleEvent(uint32_t track_id,
-                             const std::shared_ptr<MediaSample>& sample) {
+                             std::shared_ptr<MediaSample> sample) {
   if (!all_streams_ready_) {
     if (queued_samples_.size() >= kQueuedSamplesLimit) {
       LOG(ERROR) << "Queued samples limit reached: " << kQueuedSamplesLimit;
       return false;
     }
-    queued_samples_.push_back(QueuedSample(track_id, sample));
+    queued_samples_.push_back(QueuedSample(track_id, std::move(sample)));
     return true;
   }
   if (!init_event_status_.ok()) {
     return false;
   }
   while (!queued_samples_.empty()) {
-    if (!PushSample(queued_samples_.front().track_id,
-                    queued_samples_.front().sample)) {
-      return false;
-    }
+    const uint32_t queued_track_id = queued_samples_.front().track_id;
+    std::shared_ptr<MediaSample> queued_sample =
+        std::move(queued_samples_.front().sample);
     queued_samples_.pop_front();
+    if (!PushSample(queued_track_id, std::move(queued_sample)))
+      return false;
   }
-  return PushSample(track_id, sample);
+  return PushSample(track_id, std::move(sample));
 }
 
 bool Demuxer::PushSample(uint32_t track_id,
-                         const std::shared_ptr<MediaSample>& sample) {
+                         std::shared_ptr<MediaSample> sample) {
   auto stream_index_iter = track_id_to_stream_index_map_.find(track_id);
   if (stream_index_iter == track_id_to_stream_index_map_.end()) {
     LOG(ERROR) << "Track " << track_id << " not found.";
@@ -326,7 +383,16 @@ bool Demuxer::PushSample(uint32_t track_id,
   }
   if (stream_index_iter->second == kInvalidStreamIndex)
     return true;
-  Status status = DispatchMediaSample(stream_index_iter->second, sample);
+  // The samples read while initializing the parser, or by parsers without
+  // random access, may be outside of the range.
+  auto dts_range = dts_ranges_.find(track_id);
+  if (dts_range != dts_ranges_.end() &&
+      (sample->dts() < dts_range->second.first ||
+       sample->dts() >= dts_range->second.second)) {
+    return true;
+  }
+  Status status =
+      DispatchMediaSample(stream_index_iter->second, std::move(sample));
   if (!status.ok()) {
     LOG(ERROR) << "Failed to process sample " << stream_index_iter->second
                << " " << status;
@@ -339,7 +405,31 @@ Status Demuxer::Parse() {
   DCHECK(parser_);
   DCHECK(buffer_);
 
-  int64_t bytes_read = media_file_->Read(buffer_.get(), kBufSize);
+  if (random_access_) {
+    bool end_of_stream = false;
+    if (!static_cast<mp4::MP4MediaParser*>(parser_.get())
+             ->ReadSamples(&end_of_stream)) {
+      return Status(error::PARSER_FAILURE,
+                    "Cannot parse media file " + file_name_);
+    }
+    if (!end_of_stream)
+      return Status::OK;
+    if (!parser_->Flush())
+      return Status(error::PARSER_FAILURE, "Failed to flush.");
+    return Status(error::END_OF_STREAM, "");
+  }
+
+  const uint8_t* data = buffer_.get();
+  int64_t bytes_read = 0;
+  if (mapped_file_) {
+    // No need to read: the parser references the mapped file in place.
+    data = mapped_file_.get() + mapped_file_position_;
+    bytes_read = std::min(static_cast<uint64_t>(kBufSize),
+                          mapped_file_size_ - mapped_file_position_);
+    mapped_file_position_ += bytes_read;
+  } else {
+    bytes_read = media_file_->Read(buffer_.get(), kBufSize);
+  }
   if (bytes_read == 0) {
     if (!parser_->Flush())
       return Status(error::PARSER_FAILURE, "Failed to flush.");
@@ -348,7 +438,7 @@ Status Demuxer::Parse() {
     return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
   }
 
-  return parser_->Parse(buffer_.get(), bytes_read)
+  return parser_->Parse(data, bytes_read)
              ? Status::OK
              : Status(error::PARSER_FAILURE,
                       "Cannot parse media file " + file_name_);
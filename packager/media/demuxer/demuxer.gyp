@@ -17,6 +17,7 @@
         'demuxer.h',
       ],
       'dependencies': [
+        '../../third_party/gflags/gflags.gyp:gflags',
         '../base/media_base.gyp:media_base',
         '../formats/mp2t/mp2t.gyp:mp2t',
         '../formats/mp4/mp4.gyp:mp4',
@@ -35,7 +36,9 @@
       'dependencies': [
         '../../testing/gmock.gyp:gmock',
         '../../testing/gtest.gyp:gtest',
+        '../../third_party/gflags/gflags.gyp:gflags',
         '../base/media_base.gyp:media_handler_test_base',
+        '../crypto/crypto.gyp:crypto',
         '../test/media_test.gyp:media_test_support',
         'demuxer',
       ]
@@ -8,7 +8,9 @@
 #define PACKAGER_MEDIA_BASE_DEMUXER_H_
 
 #include <deque>
+#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "packager/base/compiler_specific.h"
@@ -71,6 +73,14 @@ class Demuxer : public OriginHandler {
   void SetLanguageOverride(const std::string& stream_label,
                            const std::string& language_override);
 
+  /// Only demux the samples of the specified track with decoding timestamps in
+  /// [@a start_dts, @a end_dts), e.g. to package a range of the input in
+  /// parallel with the rest of it. Local non-fragmented MP4 files are then
+  /// read in random access mode, see --mp4_random_access, so the data outside
+  /// of the ranges is not read.
+  /// @param track_id is the id of the track in the input.
+  void SetDtsRange(uint32_t track_id, int64_t start_dts, int64_t end_dts);
+
   void set_dump_stream_info(bool dump_stream_info) {
     dump_stream_info_ = dump_stream_info;
   }
@@ -112,11 +122,11 @@ class Demuxer : public OriginHandler {
   // Parser new sample event handler. Queues the samples if init event has not
   // been received, otherwise calls PushSample() to push the sample to
   // corresponding stream.
-  bool NewSampleEvent(uint32_t track_id,
-                      const std::shared_ptr<MediaSample>& sample);
-  // Helper function to push the sample to corresponding stream.
-  bool PushSample(uint32_t track_id,
-                  const std::shared_ptr<MediaSample>& sample);
+  bool NewSampleEvent(uint32_t track_id, std::shared_ptr<MediaSample> sample);
+  // Helper function to push the sample to corresponding stream. The demuxer
+  // keeps no reference to the dispatched sample, so that downstream handlers
+  // can modify it in place.
+  bool PushSample(uint32_t track_id, std::shared_ptr<MediaSample> sample);
 
   // Read from the source and send it to the parser.
   Status Parse();
@@ -137,6 +147,18 @@ class Demuxer : public OriginHandler {
   std::map<size_t, std::string> language_overrides_;
   MediaContainerName container_name_ = CONTAINER_UNKNOWN;
   std::unique_ptr<uint8_t[]> buffer_;
+  // The memory-mapped input file, parsed in place instead of being read into
+  // |buffer_|, if enabled with --mmap_input.
+  std::shared_ptr<const uint8_t> mapped_file_;
+  uint64_t mapped_file_size_ = 0;
+  // Position of the next byte in |mapped_file_| to pass to the parser.
+  uint64_t mapped_file_position_ = 0;
+  // Whether the MP4 parser reads the samples itself, if enabled with
+  // --mp4_random_access.
+  bool random_access_ = false;
+  // TrackId -> [start, end) decoding timestamps of the samples to demux, for
+  // the tracks set with SetDtsRange().
+  std::map<uint32_t, std::pair<int64_t, int64_t>> dts_ranges_;
   std::unique_ptr<KeySource> key_source_;
   bool cancelled_ = false;
   // Whether to dump stream info when it is received.
@@ -6,14 +6,20 @@
 
 #include "packager/media/demuxer/demuxer.h"
 
+#include <gflags/gflags.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "packager/media/base/media_handler_test_base.h"
 #include "packager/media/base/raw_key_source.h"
+#include "packager/media/crypto/encryption_handler.h"
 #include "packager/media/test/test_data_util.h"
+#include "packager/status_macros.h"
 #include "packager/status_test_util.h"
 
+DECLARE_bool(mmap_input);
+DECLARE_bool(mp4_random_access);
+
 namespace shaka {
 namespace media {
 namespace {
@@ -27,6 +33,31 @@ class MockKeySource : public RawKeySource {
   MOCK_METHOD2(GetKey,
                Status(const std::vector<uint8_t>& key_id, EncryptionKey* key));
 };
+
+// Records the samples passing through, without holding references to them.
+class SampleRecordingHandler : public MediaHandler {
+ public:
+  struct Record {
+    const MediaSample* sample;
+    const uint8_t* data;
+  };
+
+  const std::vector<Record>& records() const { return records_; }
+
+ protected:
+  Status InitializeInternal() override { return Status::OK; }
+
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    if (stream_data->stream_data_type == StreamDataType::kMediaSample) {
+      records_.push_back({stream_data->media_sample.get(),
+                          stream_data->media_sample->data()});
+    }
+    return Dispatch(std::move(stream_data));
+  }
+
+ private:
+  std::vector<Record> records_;
+};
 }  // namespace
 
 class DemuxerTest : public MediaHandlerGraphTestBase {
@@ -45,6 +76,35 @@ class DemuxerTest : public MediaHandlerGraphTestBase {
     encryption_key.key.assign(kKey, kKey + sizeof(kKey));
     return encryption_key;
   }
+
+  Status Demux(const std::string& file_name,
+               const std::string& stream_label,
+               std::shared_ptr<MediaHandler> output) {
+    Demuxer demuxer(file_name);
+    RETURN_IF_ERROR(demuxer.SetHandler(stream_label, output));
+    return demuxer.Run();
+  }
+
+  void ExpectSameSamples(const CachingMediaHandler& expected_output,
+                         const CachingMediaHandler& output) {
+    const auto& expected_data = expected_output.Cache();
+    const auto& data = output.Cache();
+    ASSERT_EQ(expected_data.size(), data.size());
+    size_t num_samples = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+      ASSERT_EQ(expected_data[i]->stream_data_type, data[i]->stream_data_type);
+      if (data[i]->stream_data_type != StreamDataType::kMediaSample)
+        continue;
+      ++num_samples;
+      const MediaSample& expected_sample = *expected_data[i]->media_sample;
+      const MediaSample& sample = *data[i]->media_sample;
+      EXPECT_EQ(expected_sample.dts(), sample.dts());
+      ASSERT_EQ(expected_sample.data_size(), sample.data_size());
+      EXPECT_EQ(0, memcmp(expected_sample.data(), sample.data(),
+                          sample.data_size()));
+    }
+    EXPECT_GT(num_samples, 0u);
+  }
 };
 
 TEST_F(DemuxerTest, FileNotFound) {
@@ -72,6 +132,84 @@ TEST_F(DemuxerTest, EncryptedContentWithKeySource) {
   EXPECT_OK(demuxer.Run());
 }
 
+TEST_F(DemuxerTest, MappedInput) {
+  const std::string file_name =
+      GetTestDataFilePath("bear-640x360-trailing-moov.mp4").AsUTF8Unsafe();
+  auto read_output = std::make_shared<CachingMediaHandler>();
+  ASSERT_OK(Demux(file_name, "video", read_output));
+
+  google::FlagSaver flag_saver;
+  FLAGS_mmap_input = true;
+  auto mapped_output = std::make_shared<CachingMediaHandler>();
+  ASSERT_OK(Demux(file_name, "video", mapped_output));
+
+  ExpectSameSamples(*read_output, *mapped_output);
+  for (const auto& stream_data : mapped_output->Cache()) {
+    if (stream_data->stream_data_type != StreamDataType::kMediaSample)
+      continue;
+    // The mapped file is read-only.
+    EXPECT_FALSE(std::const_pointer_cast<MediaSample>(stream_data->media_sample)
+                     ->writable_data());
+  }
+}
+
+TEST_F(DemuxerTest, RandomAccess) {
+  const std::string file_name =
+      GetTestDataFilePath("bear-640x360.mp4").AsUTF8Unsafe();
+  for (const std::string stream_label : {"audio", "video"}) {
+    auto read_output = std::make_shared<CachingMediaHandler>();
+    ASSERT_OK(Demux(file_name, stream_label, read_output));
+
+    google::FlagSaver flag_saver;
+    FLAGS_mp4_random_access = true;
+    auto random_access_output = std::make_shared<CachingMediaHandler>();
+    ASSERT_OK(Demux(file_name, stream_label, random_access_output));
+
+    ExpectSameSamples(*read_output, *random_access_output);
+  }
+}
+
+TEST_F(DemuxerTest, SamplesEncryptedInPlace) {
+  const EncryptionKey encryption_key = GetMockEncryptionKey();
+  EncryptionParams encryption_params;
+  encryption_params.key_provider = KeyProvider::kRawKey;
+  RawKeyParams::KeyInfo& key_info = encryption_params.raw_key.key_map[""];
+  key_info.key_id = encryption_key.key_id;
+  key_info.key = encryption_key.key;
+  encryption_params.stream_label_func =
+      [](const EncryptionParams::EncryptedStreamAttributes&) {
+        return std::string();
+      };
+  std::unique_ptr<RawKeySource> key_source =
+      RawKeySource::Create(encryption_params.raw_key);
+  ASSERT_TRUE(key_source);
+
+  auto recorder = std::make_shared<SampleRecordingHandler>();
+  auto encryptor =
+      std::make_shared<EncryptionHandler>(encryption_params, key_source.get());
+  auto output = std::make_shared<CachingMediaHandler>();
+  ASSERT_OK(MediaHandler::Chain({recorder, encryptor, output}));
+  ASSERT_OK(Demux(GetTestDataFilePath("bear-640x360.mp4").AsUTF8Unsafe(),
+                  "video", recorder));
+
+  // The demuxer hands the samples over, so the encryption handler owns them
+  // exclusively and encrypts them without copying.
+  size_t num_samples = 0;
+  for (const auto& stream_data : output->Cache()) {
+    if (stream_data->stream_data_type != StreamDataType::kMediaSample)
+      continue;
+    ASSERT_LT(num_samples, recorder->records().size());
+    const SampleRecordingHandler::Record& record =
+        recorder->records()[num_samples++];
+    const MediaSample& sample = *stream_data->media_sample;
+    EXPECT_TRUE(sample.is_encrypted());
+    EXPECT_EQ(record.sample, &sample);
+    EXPECT_EQ(record.data, sample.data());
+  }
+  EXPECT_EQ(recorder->records().size(), num_samples);
+  EXPECT_GT(num_samples, 0u);
+}
+
 // TODO(kqyang): Add more tests.
 
 }  // namespace media
@@ -180,7 +180,7 @@ void MpdNotifyMuxerListener::OnNewSegment(const std::string& file_name,
     mpd_notifier_->NotifyNewSegment(notification_id_.value(), start_time,
                                     duration, segment_file_size);
     if (mpd_notifier_->mpd_type() == MpdType::kDynamic)
-      mpd_notifier_->Flush();
+      mpd_notifier_->FlushAsync();
   } else {
     EventInfo event_info;
     event_info.type = EventInfoType::kSegment;
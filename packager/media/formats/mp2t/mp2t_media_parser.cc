@@ -417,7 +417,7 @@ bool Mp2tMediaParser::EmitRemainingSamples() {
     for (SampleQueue::iterator sample_iter = sample_queue.begin();
          sample_iter != sample_queue.end();
          ++sample_iter) {
-      if (!new_sample_cb_.Run(pid_iter->first, *sample_iter)) {
+      if (!new_sample_cb_.Run(pid_iter->first, std::move(*sample_iter))) {
         // Error processing sample. Propagate error condition.
         return false;
       }
@@ -70,7 +70,7 @@ class Mp2tMediaParserTest : public testing::Test {
   }
 
   bool OnNewSample(uint32_t track_id,
-                   const std::shared_ptr<MediaSample>& sample) {
+                   std::shared_ptr<MediaSample> sample) {
     StreamMap::const_iterator stream = stream_map_.find(track_id);
     EXPECT_NE(stream_map_.end(), stream);
     if (stream != stream_map_.end()) {
@@ -32,9 +32,10 @@ Status TsMuxer::Finalize() {
   return segmenter_->Finalize();
 }
 
-Status TsMuxer::AddSample(size_t stream_id, const MediaSample& sample) {
+Status TsMuxer::AddSample(size_t stream_id,
+                          std::shared_ptr<const MediaSample> sample) {
   DCHECK_EQ(stream_id, 0u);
-  return segmenter_->AddSample(sample);
+  return segmenter_->AddSample(*sample);
 }
 
 Status TsMuxer::FinalizeSegment(size_t stream_id,
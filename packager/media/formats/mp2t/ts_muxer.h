@@ -27,7 +27,7 @@ class TsMuxer : public Muxer {
   Status InitializeMuxer() override;
   Status Finalize() override;
   Status AddSample(size_t stream_id,
-                   const MediaSample& sample) override;
+                   std::shared_ptr<const MediaSample> sample) override;
   Status FinalizeSegment(size_t stream_id,
                          const SegmentInfo& sample) override;
 
@@ -181,8 +181,8 @@ Status TsSegmenter::FinalizeSegment(uint64_t start_timestamp,
                        segment_number_++, muxer_options_.bandwidth);
 
   const int64_t file_size = segment_buffer_.Size();
-  std::unique_ptr<File, FileCloser> segment_file;	  
-  segment_file.reset(File::Open(segment_path.c_str(), "w"));
+  std::unique_ptr<File, FileCloser> segment_file;
+  segment_file.reset(File::OpenWithNoBuffering(segment_path.c_str(), "w"));
   if (!segment_file) {
     return Status(error::FILE_FAILURE,
                   "Cannot open file for write " + segment_path);  
@@ -16,7 +16,7 @@
 namespace shaka {
 namespace media {
 
-class BufferWriter;
+class BufferChain;
 class MediaSample;
 class StreamInfo;
 
@@ -66,7 +66,7 @@ class Fragmenter {
   }
   bool fragment_initialized() const { return fragment_initialized_; }
   bool fragment_finalized() const { return fragment_finalized_; }
-  BufferWriter* data() { return data_.get(); }
+  BufferChain* data() { return data_.get(); }
   const std::vector<KeyFrameInfo>& key_frame_infos() const {
     return key_frame_infos_;
   }
@@ -94,7 +94,8 @@ class Fragmenter {
   int64_t fragment_duration_ = 0;
   int64_t earliest_presentation_time_ = 0;
   int64_t first_sap_time_ = 0;
-  std::unique_ptr<BufferWriter> data_;
+  // References the sample data without copying it.
+  std::unique_ptr<BufferChain> data_;
   // Saves key frames information, for Video.
   std::vector<KeyFrameInfo> key_frame_infos_;
 
@@ -13,6 +13,7 @@
 #include "packager/file/file.h"
 #include "packager/file/file_closer.h"
 #include "packager/media/base/audio_stream_info.h"
+#include "packager/media/base/buffer_pool.h"
 #include "packager/media/base/buffer_reader.h"
 #include "packager/media/base/decrypt_config.h"
 #include "packager/media/base/key_source.h"
@@ -168,6 +169,9 @@ bool UpdateCodecStringForDolbyVision(
 
 const uint64_t kNanosecondsPerSecond = 1000000000ull;
 
+// Maximum size of the sample data read at once in random access mode.
+const int64_t kMaxRandomAccessReadSize = 0x200000;  // 2MB
+
 }  // namespace
 
 MP4MediaParser::MP4MediaParser()
@@ -214,7 +218,12 @@ bool MP4MediaParser::Parse(const uint8_t* buf, int size) {
   if (state_ == kError)
     return false;
 
-  queue_.Push(buf, size);
+  DCHECK(!random_access_file_) << "Parse() is not used in random access mode.";
+
+  if (mapped_file_)
+    queue_.PushInPlace(buf, size);
+  else
+    queue_.Push(buf, size);
 
   bool result, err = false;
 
@@ -317,6 +326,145 @@ bool MP4MediaParser::LoadMoov(const std::string& file_path) {
   return true;
 }
 
+bool MP4MediaParser::EnableRandomAccess(const std::string& file_path,
+                                        const std::set<uint32_t>& track_ids) {
+  // Only the sample tables of non-fragmented files describe all the samples.
+  if (state_ != kEmittingSamples || !moov_->extends.tracks.empty())
+    return false;
+  DCHECK_EQ(0, moof_head_);
+
+  // Seeks and reads are done on demand, so the file is not buffered.
+  random_access_file_.reset(
+      File::OpenWithNoBuffering(file_path.c_str(), "r"));
+  if (!random_access_file_) {
+    LOG(ERROR) << "Unable to open media file '" << file_path << "'";
+    return false;
+  }
+  random_access_track_ids_ = track_ids;
+  // The data already queued is not needed anymore; the remaining samples are
+  // read from the file.
+  queue_.Reset();
+  return true;
+}
+
+bool MP4MediaParser::ReadSamples(bool* end_of_stream) {
+  DCHECK(random_access_file_);
+  DCHECK(end_of_stream);
+
+  *end_of_stream = !SkipToNextSampleToRead();
+  if (*end_of_stream)
+    return true;
+
+  // Read the data of as many samples as possible at once.
+  const int64_t start_offset = runs_->sample_offset();
+  const int64_t end_offset = runs_->GetContiguousSampleDataEnd(
+      random_access_track_ids_, start_offset + kMaxRandomAccessReadSize);
+  random_access_buffer_.resize(end_offset - start_offset);
+  if (!random_access_file_->Seek(start_offset)) {
+    LOG(ERROR) << "Cannot seek to " << start_offset << " in '"
+               << random_access_file_->file_name() << "'";
+    return false;
+  }
+  size_t bytes_read = 0;
+  while (bytes_read < random_access_buffer_.size()) {
+    const int64_t result =
+        random_access_file_->Read(&random_access_buffer_[bytes_read],
+                                  random_access_buffer_.size() - bytes_read);
+    if (result <= 0) {
+      LOG(ERROR) << "Cannot read samples at " << start_offset << " from '"
+                 << random_access_file_->file_name() << "'";
+      return false;
+    }
+    bytes_read += result;
+  }
+
+  // Emit the samples read, which may span multiple runs.
+  while (runs_->IsRunValid()) {
+    if (!runs_->IsSampleValid()) {
+      runs_->AdvanceRun();
+      continue;
+    }
+    const int64_t sample_offset = runs_->sample_offset();
+    if (random_access_track_ids_.count(runs_->track_id()) == 0 ||
+        !IsSampleInDtsRange() || sample_offset < start_offset ||
+        sample_offset + runs_->sample_size() > end_offset) {
+      break;
+    }
+    if (!EmitSample(&random_access_buffer_[sample_offset - start_offset]))
+      return false;
+  }
+  return true;
+}
+
+void MP4MediaParser::SetDtsRange(uint32_t track_id,
+                                 int64_t start_dts,
+                                 int64_t end_dts) {
+  DCHECK_LE(start_dts, end_dts);
+  dts_ranges_[track_id] = std::make_pair(start_dts, end_dts);
+}
+
+bool MP4MediaParser::GetSampleTimings(
+    std::map<uint32_t, std::vector<SampleTiming>>* sample_timings) const {
+  DCHECK(sample_timings);
+  // Only the sample tables of non-fragmented files describe all the samples.
+  if (!moov_ || !moov_->extends.tracks.empty())
+    return false;
+
+  // Iterate over the sample tables independently of |runs_|, which may have
+  // advanced already.
+  TrackRunIterator runs(moov_.get());
+  RCHECK(runs.Init());
+  sample_timings->clear();
+  for (; runs.IsRunValid(); runs.AdvanceRun()) {
+    std::vector<SampleTiming>& track_sample_timings =
+        (*sample_timings)[runs.track_id()];
+    for (; runs.IsSampleValid(); runs.AdvanceSample()) {
+      track_sample_timings.push_back(
+          {runs.dts(), runs.cts(), runs.duration(), runs.is_keyframe()});
+    }
+  }
+  return true;
+}
+
+bool MP4MediaParser::SkipToNextSampleToRead() {
+  while (runs_->IsRunValid() && !random_access_track_ids_.empty()) {
+    const uint32_t track_id = runs_->track_id();
+    if (!runs_->IsSampleValid() ||
+        random_access_track_ids_.count(track_id) == 0) {
+      runs_->AdvanceRun();
+      continue;
+    }
+    auto dts_range = dts_ranges_.find(track_id);
+    if (dts_range == dts_ranges_.end())
+      return true;
+    if (runs_->dts() >= dts_range->second.second) {
+      // The samples of a track are in decoding order, so none of the remaining
+      // samples of the track are in the range.
+      random_access_track_ids_.erase(track_id);
+      runs_->AdvanceRun();
+      continue;
+    }
+    if (runs_->dts() >= dts_range->second.first)
+      return true;
+    runs_->AdvanceSample();
+  }
+  return false;
+}
+
+bool MP4MediaParser::IsSampleInDtsRange() const {
+  auto dts_range = dts_ranges_.find(runs_->track_id());
+  return dts_range == dts_ranges_.end() ||
+         (runs_->dts() >= dts_range->second.first &&
+          runs_->dts() < dts_range->second.second);
+}
+
+void MP4MediaParser::SetMappedInput(
+    std::shared_ptr<const uint8_t> mapped_file) {
+  DCHECK(mapped_file);
+  DCHECK_EQ(0, queue_.tail()) << "Parse() must not be called before.";
+  mapped_file_ = std::move(mapped_file);
+}
+
 bool MP4MediaParser::ParseBox(bool* err) {
   const uint8_t* buf;
   int size;
@@ -823,7 +971,14 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
     return false;
   }
 
-  const uint8_t* media_data = buf;
+  if (!EmitSample(buf)) {
+    *err = true;
+    return false;
+  }
+  return true;
+}
+
+bool MP4MediaParser::EmitSample(const uint8_t* media_data) {
   const size_t media_data_size = runs_->sample_size();
   // Use a dummy data size of 0 to avoid copying overhead.
   // Actual media data is set later.
@@ -832,26 +987,24 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
       MediaSample::CopyFrom(media_data, kDummyDataSize, runs_->is_keyframe()));
 
   if (runs_->is_encrypted()) {
-    std::shared_ptr<uint8_t> decrypted_media_data(
-        new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
     std::unique_ptr<DecryptConfig> decrypt_config = runs_->GetDecryptConfig();
     if (!decrypt_config) {
-      *err = true;
       LOG(ERROR) << "Missing decrypt config.";
       return false;
     }
 
     if (!decryptor_source_) {
-      stream_sample->SetData(media_data, media_data_size);
+      SetSampleData(media_data, media_data_size, stream_sample.get());
       // If the demuxer does not have the decryptor_source_, store
       // decrypt_config so that the demuxed sample can be decrypted later.
       stream_sample->set_decrypt_config(std::move(decrypt_config));
       stream_sample->set_is_encrypted(true);
     } else {
+      std::shared_ptr<uint8_t> decrypted_media_data =
+          BufferPool::GetInstance()->Allocate(media_data_size);
       if (!decryptor_source_->DecryptSampleBuffer(decrypt_config.get(),
                                                   media_data, media_data_size,
                                                   decrypted_media_data.get())) {
-        *err = true;
         LOG(ERROR) << "Cannot decrypt samples.";
         return false;
       }
@@ -859,7 +1012,7 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
                                   media_data_size);
     }
   } else {
-    stream_sample->SetData(media_data, media_data_size);
+    SetSampleData(media_data, media_data_size, stream_sample.get());
   }
 
   stream_sample->set_dts(runs_->dts());
@@ -873,8 +1026,7 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
            << ", cts=" << runs_->cts()
            << ", size=" << runs_->sample_size();
 
-  if (!new_sample_cb_.Run(runs_->track_id(), stream_sample)) {
-    *err = true;
+  if (!new_sample_cb_.Run(runs_->track_id(), std::move(stream_sample))) {
     LOG(ERROR) << "Failed to process the sample.";
     return false;
   }
@@ -883,6 +1035,19 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
   return true;
 }
 
+void MP4MediaParser::SetSampleData(const uint8_t* data,
+                                   size_t data_size,
+                                   MediaSample* sample) {
+  if (!mapped_file_) {
+    sample->SetData(data, data_size);
+    return;
+  }
+  // |data| is in the mapped file. Share the ownership of the mapping instead of
+  // copying the data.
+  sample->SetReadOnlyData(std::shared_ptr<const uint8_t>(mapped_file_, data),
+                          data_size);
+}
+
 bool MP4MediaParser::ReadAndDiscardMDATsUntil(const int64_t offset) {
   bool err = false;
   while (mdat_tail_ < offset) {
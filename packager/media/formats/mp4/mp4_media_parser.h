@@ -11,9 +11,13 @@
 
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "packager/base/callback_forward.h"
+#include "packager/file/file_closer.h"
 #include "packager/media/base/decryptor_source.h"
 #include "packager/media/base/media_parser.h"
 #include "packager/media/base/offset_byte_queue.h"
@@ -29,6 +33,14 @@ struct ProtectionSystemSpecificHeader;
 
 class MP4MediaParser : public MediaParser {
  public:
+  /// The timing of a sample, as given by the sample tables.
+  struct SampleTiming {
+    int64_t dts;
+    int64_t pts;
+    int64_t duration;
+    bool is_key_frame;
+  };
+
   MP4MediaParser();
   ~MP4MediaParser() override;
 
@@ -49,6 +61,53 @@ class MP4MediaParser : public MediaParser {
   /// @return true if successful, false otherwise.
   bool LoadMoov(const std::string& file_path);
 
+  /// Makes Parse() reference its input in place instead of copying it. The
+  /// media samples reference the input directly too. The input must then be
+  /// passed to Parse() in consecutive ranges of @a mapped_file, starting from
+  /// the beginning of the file. Must be called after LoadMoov(), if needed,
+  /// and before any other call to Parse().
+  /// @param mapped_file is the memory-mapped media file, see
+  ///        File::MapLocalFile(). It stays mapped while any sample references
+  ///        it.
+  void SetMappedInput(std::shared_ptr<const uint8_t> mapped_file);
+
+  /// Switches to reading the remaining samples of a non-fragmented file at
+  /// their offsets in the file, as given by the sample tables, instead of
+  /// parsing the data passed to Parse(). Only the samples of the selected
+  /// tracks are read, and the data of adjacent chunks is read at once, so
+  /// neither interleaving nor unused tracks cost extra buffering or reads.
+  /// Must be called after the init event. If it succeeds, ReadSamples() must
+  /// be called instead of Parse() until the end of stream.
+  /// @param file_path is the path to the media file being parsed. It must be
+  ///        seekable.
+  /// @param track_ids contains the ids of the tracks to be read.
+  /// @return true if random access is enabled, false otherwise, e.g. if the
+  ///         file is fragmented, in which case Parse() must be used.
+  bool EnableRandomAccess(const std::string& file_path,
+                          const std::set<uint32_t>& track_ids);
+
+  /// Reads and emits the next samples in random access mode. See
+  /// EnableRandomAccess().
+  /// @param end_of_stream is set to true if all the samples have been read.
+  /// @return true if successful, false otherwise.
+  bool ReadSamples(bool* end_of_stream) WARN_UNUSED_RESULT;
+
+  /// Limits the samples of a track read in random access mode to the ones
+  /// with decoding timestamps in [@a start_dts, @a end_dts). The reading ends
+  /// once all the selected tracks are past their ranges. Must be called
+  /// before ReadSamples().
+  void SetDtsRange(uint32_t track_id, int64_t start_dts, int64_t end_dts);
+
+  /// Gets the timing of all the samples of a non-fragmented file from its
+  /// sample tables, without reading the samples. Must be called after the
+  /// init event.
+  /// @param sample_timings receives the timing of the samples of each track,
+  ///        in decoding order, keyed by track id.
+  /// @return true if successful, false otherwise, e.g. if the file is
+  ///         fragmented.
+  bool GetSampleTimings(
+      std::map<uint32_t, std::vector<SampleTiming>>* sample_timings) const;
+
  private:
   enum State {
     kWaitingForInit,
@@ -78,6 +137,23 @@ class MP4MediaParser : public MediaParser {
 
   bool EnqueueSample(bool* err);
 
+  // Emits the current sample of |runs_|, whose data is at |media_data|, and
+  // advances to the next sample.
+  bool EmitSample(const uint8_t* media_data);
+
+  // Advances |runs_| to the next sample to be read in random access mode.
+  // Returns false if there are no samples left to be read.
+  bool SkipToNextSampleToRead();
+  // Returns true if the current sample of |runs_| is in the dts range of its
+  // track, if any.
+  bool IsSampleInDtsRange() const;
+
+  // Set the data of |sample| to |data|, which is copied unless the input is
+  // mapped.
+  void SetSampleData(const uint8_t* data,
+                     size_t data_size,
+                     MediaSample* sample);
+
   void Reset();
 
   State state_;
@@ -87,6 +163,17 @@ class MP4MediaParser : public MediaParser {
   std::unique_ptr<DecryptorSource> decryptor_source_;
 
   OffsetByteQueue queue_;
+  // The memory-mapped media file set by SetMappedInput(), if any, in which
+  // case the data in |queue_| references it.
+  std::shared_ptr<const uint8_t> mapped_file_;
+
+  // Set in random access mode, see EnableRandomAccess().
+  std::unique_ptr<File, FileCloser> random_access_file_;
+  std::set<uint32_t> random_access_track_ids_;
+  std::vector<uint8_t> random_access_buffer_;
+  // Track id -> [start, end) decoding timestamps of the samples to be read, for
+  // the tracks set with SetDtsRange().
+  std::map<uint32_t, std::pair<int64_t, int64_t>> dts_ranges_;
 
   // These two parameters are only valid in the |kEmittingSegments| state.
   //
@@ -83,7 +83,7 @@ class MP4MediaParserTest : public testing::Test {
   }
 
   bool NewSampleF(uint32_t track_id,
-                  const std::shared_ptr<MediaSample>& sample) {
+                  std::shared_ptr<MediaSample> sample) {
     DVLOG(2) << "Track Id: " << track_id << " "
              << sample->ToString();
     ++num_samples_;
@@ -181,14 +181,15 @@ Status MP4Muxer::Finalize() {
   return Status::OK;
 }
 
-Status MP4Muxer::AddSample(size_t stream_id, const MediaSample& sample) {
+Status MP4Muxer::AddSample(size_t stream_id,
+                           std::shared_ptr<const MediaSample> sample) {
   if (to_be_initialized_) {
-    RETURN_IF_ERROR(UpdateEditListOffsetFromSample(sample));
+    RETURN_IF_ERROR(UpdateEditListOffsetFromSample(*sample));
     RETURN_IF_ERROR(DelayInitializeMuxer());
     to_be_initialized_ = false;
   }
   DCHECK(segmenter_);
-  return segmenter_->AddSample(stream_id, sample);
+  return segmenter_->AddSample(stream_id, *sample);
 }
 
 Status MP4Muxer::FinalizeSegment(size_t stream_id,
@@ -12,6 +12,7 @@
 #include "packager/base/strings/string_util.h"
 #include "packager/file/file.h"
 #include "packager/file/file_closer.h"
+#include "packager/media/base/buffer_chain.h"
 #include "packager/media/base/buffer_writer.h"
 #include "packager/media/base/muxer_options.h"
 #include "packager/media/base/muxer_util.h"
@@ -104,7 +105,7 @@ Status MultiSegmentSegmenter::WriteSegment() {
   if (options().segment_template.empty()) {
     // Append the segment to output file if segment template is not specified.
     file_name = options().output_file_name.c_str();
-    file.reset(File::Open(file_name.c_str(), "a"));
+    file.reset(File::OpenWithNoBuffering(file_name.c_str(), "a"));
     if (!file) {
       return Status(error::FILE_FAILURE, "Cannot open file for append " +
                                              options().output_file_name);
@@ -113,7 +114,7 @@ Status MultiSegmentSegmenter::WriteSegment() {
     file_name = GetSegmentName(options().segment_template,
                                sidx()->earliest_presentation_time,
                                num_segments_++, options().bandwidth);
-    file.reset(File::Open(file_name.c_str(), "w"));
+    file.reset(File::OpenWithNoBuffering(file_name.c_str(), "w"));
     if (!file) {
       return Status(error::FILE_FAILURE,
                     "Cannot open file for write " + file_name);
@@ -128,7 +129,11 @@ Status MultiSegmentSegmenter::WriteSegment() {
   const size_t segment_size = segment_header_size + fragment_buffer()->Size();
   DCHECK_NE(segment_size, 0u);
 
-  RETURN_IF_ERROR(buffer->WriteToFile(file.get()));
+  // Write the segment header and the fragments with a single vectored write.
+  BufferChain segment;
+  segment.AppendBuffer(*buffer);
+  segment.AppendChain(fragment_buffer());
+  RETURN_IF_ERROR(segment.WriteToFile(file.get()));
   if (muxer_listener()) {
     for (const KeyFrameInfo& key_frame_info : key_frame_infos()) {
       muxer_listener()->OnKeyFrame(
@@ -137,7 +142,6 @@ Status MultiSegmentSegmenter::WriteSegment() {
           key_frame_info.size);
     }
   }
-  RETURN_IF_ERROR(fragment_buffer()->WriteToFile(file.get()));
 
   // Close the file, which also does flushing, to make sure the file is written
   // before manifest is updated.
@@ -24,7 +24,7 @@ struct EncryptionConfig;
 struct MuxerOptions;
 struct SegmentInfo;
 
-class BufferWriter;
+class BufferChain;
 class MediaSample;
 class MuxerListener;
 class ProgressListener;
@@ -109,7 +109,7 @@ class Segmenter {
   const MuxerOptions& options() const { return options_; }
   FileType* ftyp() { return ftyp_.get(); }
   Movie* moov() { return moov_.get(); }
-  BufferWriter* fragment_buffer() { return fragment_buffer_.get(); }
+  BufferChain* fragment_buffer() { return fragment_buffer_.get(); }
   SegmentIndex* sidx() { return sidx_.get(); }
   MuxerListener* muxer_listener() { return muxer_listener_; }
   uint64_t progress_target() { return progress_target_; }
@@ -137,7 +137,9 @@ class Segmenter {
   std::unique_ptr<FileType> ftyp_;
   std::unique_ptr<Movie> moov_;
   std::unique_ptr<MovieFragment> moof_;
-  std::unique_ptr<BufferWriter> fragment_buffer_;
+  // Fragments made of the moof and mdat headers, and references to the sample
+  // data.
+  std::unique_ptr<BufferChain> fragment_buffer_;
   std::unique_ptr<SegmentIndex> sidx_;
   std::vector<std::unique_ptr<Fragmenter>> fragmenters_;
   MuxerListener* muxer_listener_ = nullptr;
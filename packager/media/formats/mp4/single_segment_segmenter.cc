@@ -10,6 +10,7 @@
 
 #include "packager/file/file.h"
 #include "packager/file/file_util.h"
+#include "packager/media/base/buffer_chain.h"
 #include "packager/media/base/buffer_writer.h"
 #include "packager/media/base/muxer_options.h"
 #include "packager/media/event/progress_listener.h"
@@ -116,6 +117,43 @@ Status SingleSegmentSegmenter::DoFinalize() {
   if (!status.ok())
     return status;
 
+  // The target of 2nd stage of single segment segmentation.
+  const uint64_t re_segment_progress_target = progress_target() * 0.5;
+
+  // Append the subsegments in the temp file to the output file in the kernel
+  // if both are local regular files, so they are not read into and written
+  // from user space. Otherwise they are copied through |file|.
+  if (!file->Flush()) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot flush file " + options().output_file_name);
+  }
+  const int64_t bytes_appended = File::AppendFileInKernel(
+      temp_file_name_.c_str(), 0, options().output_file_name.c_str());
+  if (bytes_appended < 0) {
+    return Status(error::FILE_FAILURE,
+                  "Failed to append " + temp_file_name_ + " to " +
+                      options().output_file_name);
+  }
+  if (bytes_appended > 0) {
+    UpdateProgress(re_segment_progress_target);
+  } else {
+    status = CopyTempFile(file.get(), re_segment_progress_target);
+    if (!status.ok())
+      return status;
+  }
+
+  if (!file.release()->Close()) {
+    return Status(
+        error::FILE_FAILURE,
+        "Cannot close file " + options().output_file_name +
+            ", possibly file permission issue or running out of disk space.");
+  }
+  SetComplete();
+  return Status::OK;
+}
+
+Status SingleSegmentSegmenter::CopyTempFile(File* file,
+                                            uint64_t progress_target) {
   // Load the temp file and write to output file.
   std::unique_ptr<File, FileCloser> temp_file(
       File::Open(temp_file_name_.c_str(), "r"));
@@ -124,9 +162,6 @@ Status SingleSegmentSegmenter::DoFinalize() {
                   "Cannot open file to read " + temp_file_name_);
   }
 
-  // The target of 2nd stage of single segment segmentation.
-  const uint64_t re_segment_progress_target = progress_target() * 0.5;
-
   const int kBufSize = 0x200000;  // 2MB.
   std::unique_ptr<uint8_t[]> buf(new uint8_t[kBufSize]);
   while (true) {
@@ -143,19 +178,12 @@ Status SingleSegmentSegmenter::DoFinalize() {
                     "Failed to write file " + options().output_file_name);
     }
     UpdateProgress(static_cast<double>(size) / temp_file->Size() *
-                   re_segment_progress_target);
+                   progress_target);
   }
   if (!temp_file.release()->Close()) {
     return Status(error::FILE_FAILURE, "Cannot close the temp file " +
                                            temp_file_name_ + " after reading.");
   }
-  if (!file.release()->Close()) {
-    return Status(
-        error::FILE_FAILURE,
-        "Cannot close file " + options().output_file_name +
-            ", possibly file permission issue or running out of disk space.");
-  }
-  SetComplete();
   return Status::OK;
 }
 
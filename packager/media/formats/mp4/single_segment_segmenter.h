@@ -46,6 +46,10 @@ class SingleSegmentSegmenter : public Segmenter {
   Status DoFinalize() override;
   Status DoFinalizeSegment() override;
 
+  // Copies the temp file to the end of |file| through user space, updating
+  // the progress up to |progress_target|.
+  Status CopyTempFile(File* file, uint64_t progress_target);
+
   std::unique_ptr<SegmentIndex> vod_sidx_;
   std::string temp_file_name_;
   std::unique_ptr<File, FileCloser> temp_file_;
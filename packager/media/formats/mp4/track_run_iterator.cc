@@ -521,6 +521,31 @@ int64_t TrackRunIterator::GetMaxClearOffset() {
   return offset;
 }
 
+int64_t TrackRunIterator::GetContiguousSampleDataEnd(
+    const std::set<uint32_t>& track_ids,
+    int64_t max_offset) const {
+  DCHECK(IsSampleValid());
+
+  int64_t end_offset = sample_offset_;
+  for (auto sample = sample_itr_; sample != run_itr_->samples.end(); ++sample) {
+    if (end_offset > sample_offset_ && end_offset + sample->size > max_offset)
+      return end_offset;
+    end_offset += sample->size;
+  }
+  for (auto run = run_itr_ + 1; run != runs_.end(); ++run) {
+    if (run->sample_start_offset != end_offset ||
+        track_ids.find(run->track_id) == track_ids.end()) {
+      break;
+    }
+    for (const SampleInfo& sample : run->samples) {
+      if (end_offset + sample.size > max_offset)
+        return end_offset;
+      end_offset += sample.size;
+    }
+  }
+  return end_offset;
+}
+
 uint32_t TrackRunIterator::track_id() const {
   DCHECK(IsRunValid());
   return run_itr_->track_id;
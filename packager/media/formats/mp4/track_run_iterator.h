@@ -7,6 +7,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "packager/media/formats/mp4/box_definitions.h"
@@ -72,6 +73,19 @@ class TrackRunIterator {
   ///         head of the MOOF box).
   int64_t GetMaxClearOffset();
 
+  /// Get the end of the sample data which can be read together with the data
+  /// of the current sample, for reading it with as few reads as possible. It
+  /// covers the rest of the current run and the following runs of
+  /// @a track_ids, as long as their data immediately follows.
+  /// Only valid if IsSampleValid().
+  /// @param track_ids contains the ids of the tracks to be read.
+  /// @param max_offset is the offset the data should not extend past. The
+  ///        data of the current sample is included regardless.
+  /// @return The end offset (exclusive) of the data, in the same units as
+  ///         sample_offset().
+  int64_t GetContiguousSampleDataEnd(const std::set<uint32_t>& track_ids,
+                                     int64_t max_offset) const;
+
   /// @name Properties of the current run. Only valid if IsRunValid().
   /// @{
   uint32_t track_id() const;
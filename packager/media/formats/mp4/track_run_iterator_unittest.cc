@@ -7,6 +7,7 @@
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
 #include <stdint.h>
+#include <limits>
 #include <memory>
 #include "packager/base/logging.h"
 #include "packager/media/formats/mp4/box_definitions.h"
@@ -351,6 +352,31 @@ TEST_F(TrackRunIteratorTest, BasicOperationTest) {
   EXPECT_FALSE(iter_->IsRunValid());
 }
 
+TEST_F(TrackRunIteratorTest, GetContiguousSampleDataEndTest) {
+  iter_.reset(new TrackRunIterator(&moov_));
+  MovieFragment moof = CreateFragment();
+  // Make the run of track 2 immediately follow the first run of track 1.
+  moof.tracks[1].runs[0].data_offset = 100 + kSumAscending1 + 10;
+  ASSERT_TRUE(iter_->Init(moof));
+  ASSERT_EQ(1u, iter_->track_id());
+
+  const int64_t kNoLimit = std::numeric_limits<int64_t>::max();
+  // The first runs of both tracks, but not the second run of track 1.
+  EXPECT_EQ(100 + 2 * (kSumAscending1 + 10),
+            iter_->GetContiguousSampleDataEnd({1, 2}, kNoLimit));
+  // Track 2 is not read.
+  EXPECT_EQ(100 + kSumAscending1 + 10,
+            iter_->GetContiguousSampleDataEnd({1}, kNoLimit));
+  // The first two samples fit.
+  EXPECT_EQ(103, iter_->GetContiguousSampleDataEnd({1, 2}, 103));
+  // The current sample is always included.
+  EXPECT_EQ(101, iter_->GetContiguousSampleDataEnd({1, 2}, 0));
+
+  iter_->AdvanceSample();
+  EXPECT_EQ(100 + kSumAscending1 + 10,
+            iter_->GetContiguousSampleDataEnd({1}, kNoLimit));
+}
+
 TEST_F(TrackRunIteratorTest, TrackExtendsDefaultsTest) {
   moov_.extends.tracks[0].default_sample_duration = 50;
   moov_.extends.tracks[0].default_sample_size = 3;
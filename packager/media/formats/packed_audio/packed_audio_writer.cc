@@ -59,9 +59,9 @@ Status PackedAudioWriter::Finalize() {
 }
 
 Status PackedAudioWriter::AddSample(size_t stream_id,
-                                    const MediaSample& sample) {
+                                    std::shared_ptr<const MediaSample> sample) {
   DCHECK_EQ(stream_id, 0u);
-  return segmenter_->AddSample(sample);
+  return segmenter_->AddSample(*sample);
 }
 
 Status PackedAudioWriter::FinalizeSegment(size_t stream_id,
@@ -107,7 +107,7 @@ Status PackedAudioWriter::WriteSegment(const std::string& segment_path,
     range.end = range.start + segment_buffer->Size() - 1;
     media_ranges_.subsegment_ranges.push_back(range);
   } else {
-    file.reset(File::Open(segment_path.c_str(), "w"));
+    file.reset(File::OpenWithNoBuffering(segment_path.c_str(), "w"));
     if (!file) {
       return Status(error::FILE_FAILURE,
                     "Cannot open file for write " + segment_path);
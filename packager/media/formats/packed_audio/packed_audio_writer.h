@@ -35,7 +35,8 @@ class PackedAudioWriter : public Muxer {
   // Muxer implementations.
   Status InitializeMuxer() override;
   Status Finalize() override;
-  Status AddSample(size_t stream_id, const MediaSample& sample) override;
+  Status AddSample(size_t stream_id,
+                   std::shared_ptr<const MediaSample> sample) override;
   Status FinalizeSegment(size_t stream_id, const SegmentInfo& sample) override;
 
   Status WriteSegment(const std::string& segment_path,
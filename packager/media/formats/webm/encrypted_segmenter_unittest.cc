@@ -237,7 +237,7 @@ TEST_F(EncryptedSegmenterTest, BasicSupport) {
                             std::vector<SubsampleEntry>()));
       sample->set_decrypt_config(std::move(decrypt_config));
     }
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(
       segmenter_->FinalizeSegment(3 * kDuration, 2 * kDuration, !kSubsegment));
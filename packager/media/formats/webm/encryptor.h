@@ -24,9 +24,13 @@ namespace webm {
 Status UpdateTrackForEncryption(const std::vector<uint8_t>& key_id,
                                 mkvmuxer::Track* track);
 
-/// Update the frame with signal bytes and encryption information if it is
-/// encrypted.
-void UpdateFrameForEncryption(MediaSample* sample);
+/// Write the frame of a sample of an encrypted track, i.e. the sample data
+/// prefixed with signal bytes and, if the sample is encrypted, encryption
+/// information.
+/// @param sample is the sample to write the frame of.
+/// @param frame receives the frame. Its capacity is reused.
+void WriteFrameForEncryption(const MediaSample& sample,
+                             std::vector<uint8_t>* frame);
 
 }  // namespace webm
 }  // namespace media
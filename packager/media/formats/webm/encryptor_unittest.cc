@@ -47,12 +47,14 @@ TEST(EncryptionUtilTest, UpdateTrackWithEmptyKeyId) {
 
 TEST(EncryptionUtilTest, SampleNotEncrypted) {
   auto sample = MediaSample::CopyFrom(kData, sizeof(kData), kKeyFrame);
-  UpdateFrameForEncryption(sample.get());
-  ASSERT_EQ(sizeof(kData) + 1, sample->data_size());
-  EXPECT_EQ(0u, sample->data()[0]);
+  std::vector<uint8_t> frame;
+  WriteFrameForEncryption(*sample, &frame);
+  ASSERT_EQ(sizeof(kData) + 1, frame.size());
+  EXPECT_EQ(0u, frame[0]);
   EXPECT_EQ(std::vector<uint8_t>(kData, kData + sizeof(kData)),
-            std::vector<uint8_t>(sample->data() + 1,
-                                 sample->data() + sample->data_size()));
+            std::vector<uint8_t>(frame.begin() + 1, frame.end()));
+  // The sample is left untouched.
+  EXPECT_EQ(sizeof(kData), sample->data_size());
 }
 
 namespace {
@@ -112,27 +114,28 @@ TEST_P(EncryptionUtilEncryptedTest, SampleEncrypted) {
                             test_case.subsamples + test_case.num_subsamples)));
   sample->set_decrypt_config(std::move(decrypt_config));
 
-  UpdateFrameForEncryption(sample.get());
+  std::vector<uint8_t> frame;
+  WriteFrameForEncryption(*sample, &frame);
   ASSERT_EQ(
       sizeof(kData) + sizeof(kIv) + test_case.subsample_partition_data_size + 1,
-      sample->data_size());
+      frame.size());
   if (test_case.num_subsamples > 0)
-    EXPECT_EQ(kWebMEncryptedSignal | kWebMPartitionedSignal, sample->data()[0]);
+    EXPECT_EQ(kWebMEncryptedSignal | kWebMPartitionedSignal, frame[0]);
   else
-    EXPECT_EQ(kWebMEncryptedSignal, sample->data()[0]);
+    EXPECT_EQ(kWebMEncryptedSignal, frame[0]);
   EXPECT_EQ(std::vector<uint8_t>(kIv, kIv + sizeof(kIv)),
-            std::vector<uint8_t>(sample->data() + 1,
-                                 sample->data() + 1 + sizeof(kIv)));
+            std::vector<uint8_t>(frame.begin() + 1,
+                                 frame.begin() + 1 + sizeof(kIv)));
   EXPECT_EQ(std::vector<uint8_t>(test_case.subsample_partition_data,
                                  test_case.subsample_partition_data +
                                      test_case.subsample_partition_data_size),
-            std::vector<uint8_t>(sample->data() + 1 + sizeof(kIv),
-                                 sample->data() + 1 + sizeof(kIv) +
+            std::vector<uint8_t>(frame.begin() + 1 + sizeof(kIv),
+                                 frame.begin() + 1 + sizeof(kIv) +
                                      test_case.subsample_partition_data_size));
   EXPECT_EQ(std::vector<uint8_t>(kData, kData + sizeof(kData)),
-            std::vector<uint8_t>(sample->data() + 1 + sizeof(kIv) +
+            std::vector<uint8_t>(frame.begin() + 1 + sizeof(kIv) +
                                      test_case.subsample_partition_data_size,
-                                 sample->data() + sample->data_size()));
+                                 frame.end()));
 }
 
 namespace {
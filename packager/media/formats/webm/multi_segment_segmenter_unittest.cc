@@ -124,7 +124,7 @@ TEST_F(MultiSegmentSegmenterTest, BasicSupport) {
   for (int i = 0; i < 5; i++) {
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, kNoSideData);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(segmenter_->FinalizeSegment(0, 8 * kDuration, !kSubsegment));
   ASSERT_OK(segmenter_->Finalize());
@@ -149,7 +149,7 @@ TEST_F(MultiSegmentSegmenterTest, SplitsFilesOnSegment) {
     }
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, kNoSideData);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(
       segmenter_->FinalizeSegment(5 * kDuration, 8 * kDuration, !kSubsegment));
@@ -180,7 +180,7 @@ TEST_F(MultiSegmentSegmenterTest, SplitsClustersOnSubsegment) {
     }
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, kNoSideData);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(segmenter_->FinalizeSegment(0, 8 * kDuration, !kSubsegment));
   ASSERT_OK(segmenter_->Finalize());
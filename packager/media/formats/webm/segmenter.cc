@@ -158,9 +158,7 @@ Status Segmenter::Finalize() {
   return DoFinalize();
 }
 
-Status Segmenter::AddSample(const MediaSample& source_sample) {
-  std::shared_ptr<MediaSample> sample(source_sample.Clone());
-
+Status Segmenter::AddSample(std::shared_ptr<const MediaSample> sample) {
   if (sample_duration_ == 0) {
     first_timestamp_ = sample->pts();
     sample_duration_ = sample->duration();
@@ -185,12 +183,9 @@ Status Segmenter::AddSample(const MediaSample& source_sample) {
   if (!status.ok())
     return status;
 
-  if (is_encrypted_)
-    UpdateFrameForEncryption(sample.get());
-
   new_subsegment_ = false;
   new_segment_ = false;
-  prev_sample_ = sample;
+  prev_sample_ = std::move(sample);
   return Status::OK;
 }
 
@@ -379,7 +374,15 @@ Status Segmenter::WriteFrame(bool write_duration) {
   // is not set, then a SimpleBlock will still be written.
   mkvmuxer::Frame frame;
 
-  if (!frame.Init(prev_sample_->data(), prev_sample_->data_size())) {
+  const uint8_t* frame_data = prev_sample_->data();
+  size_t frame_size = prev_sample_->data_size();
+  if (is_encrypted_) {
+    // The encryption header is prepended here, as the sample is shared.
+    WriteFrameForEncryption(*prev_sample_, &encrypted_frame_);
+    frame_data = encrypted_frame_.data();
+    frame_size = encrypted_frame_.size();
+  }
+  if (!frame.Init(frame_data, frame_size)) {
     return Status(error::MUXER_FAILURE,
                   "Error adding sample to segment: Frame::Init failed");
   }
@@ -8,6 +8,7 @@
 #define PACKAGER_MEDIA_FORMATS_WEBM_SEGMENTER_H_
 
 #include <memory>
+#include <vector>
 
 #include "packager/base/optional.h"
 #include "packager/media/base/range.h"
@@ -50,9 +51,10 @@ class Segmenter {
   Status Finalize();
 
   /// Add sample to the indicated stream.
-  /// @param sample points to the sample to be added.
+  /// @param sample points to the sample to be added. It is kept until the
+  ///        next sample is added, without being copied.
   /// @return OK on success, an error status otherwise.
-  Status AddSample(const MediaSample& sample);
+  Status AddSample(std::shared_ptr<const MediaSample> sample);
 
   /// Finalize the (sub)segment.
   virtual Status FinalizeSegment(uint64_t start_timestamp,
@@ -122,6 +124,9 @@ class Segmenter {
 
   // Store the previous sample so we know which one is the last frame.
   std::shared_ptr<const MediaSample> prev_sample_;
+  // Holds the frame of an encrypted sample, with the encryption header, while
+  // it is written. Reused across frames.
+  std::vector<uint8_t> encrypted_frame_;
   // The reference frame timestamp; used to populate the ReferenceBlock element
   // when writing non-keyframe BlockGroups.
   uint64_t reference_frame_timestamp_ = 0;
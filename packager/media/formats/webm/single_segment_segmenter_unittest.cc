@@ -161,7 +161,7 @@ TEST_F(SingleSegmentSegmenterTest, BasicSupport) {
         i == 3 ? kGenerateSideData : kNoSideData;
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, side_data_flag);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(segmenter_->FinalizeSegment(0, 5 * kDuration, !kSubsegment));
   ASSERT_OK(segmenter_->Finalize());
@@ -180,7 +180,7 @@ TEST_F(SingleSegmentSegmenterTest, SplitsClustersOnSegment) {
     }
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, kNoSideData);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(
       segmenter_->FinalizeSegment(5 * kDuration, 8 * kDuration, !kSubsegment));
@@ -205,7 +205,7 @@ TEST_F(SingleSegmentSegmenterTest, IgnoresSubsegment) {
     }
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, kNoSideData);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(segmenter_->FinalizeSegment(0, 8 * kDuration, !kSubsegment));
   ASSERT_OK(segmenter_->Finalize());
@@ -231,7 +231,7 @@ TEST_F(SingleSegmentSegmenterTest, LargeTimestamp) {
         i == 3 ? kGenerateSideData : kNoSideData;
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, side_data_flag);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(segmenter_->FinalizeSegment(kLargeTimestamp, 5 * kDuration,
                                         !kSubsegment));
@@ -267,7 +267,7 @@ TEST_F(SingleSegmentSegmenterTest, ReallyLargeTimestamp) {
         i == 3 ? kGenerateSideData : kNoSideData;
     std::shared_ptr<MediaSample> sample =
         CreateSample(kKeyFrame, kDuration, side_data_flag);
-    ASSERT_OK(segmenter_->AddSample(*sample));
+    ASSERT_OK(segmenter_->AddSample(sample));
   }
   ASSERT_OK(segmenter_->FinalizeSegment(kReallyLargeTimestamp, 5 * kDuration,
                                         !kSubsegment));
@@ -111,8 +111,30 @@ Status TwoPassSingleSegmentSegmenter::DoFinalize() {
   DCHECK_EQ(real_writer->Position(),
             static_cast<int64_t>(segment_payload_pos() + cues_pos + cues_size));
 
-  // Close the temp file and open it for reading.
+  // The clusters in a seekable temp file are finalized with their sizes, so
+  // they can be copied as is.
+  const bool clusters_finalized = writer()->Seekable();
+  // Close the temp file.
   set_writer(std::unique_ptr<MkvWriter>());
+
+  if (clusters_finalized) {
+    // Append the clusters in the kernel if possible, so they are not read
+    // into and written from user space.
+    if (!real_writer->file()->Flush())
+      return Status(error::FILE_FAILURE, "Error flushing the output file.");
+    const int64_t bytes_appended =
+        File::AppendFileInKernel(temp_file_name_.c_str(), header_size,
+                                 options().output_file_name.c_str());
+    if (bytes_appended < 0)
+      return Status(error::FILE_FAILURE, "Error copying temp file.");
+    if (bytes_appended > 0) {
+      UpdateProgressForClusters();
+      DeleteTempFile();
+      return real_writer->Close();
+    }
+  }
+
+  // Open the temp file for reading.
   std::unique_ptr<File, FileCloser> temp_reader(
       File::Open(temp_file_name_.c_str(), "r"));
   if (!temp_reader)
@@ -123,18 +145,35 @@ Status TwoPassSingleSegmentSegmenter::DoFinalize() {
     return Status(error::FILE_FAILURE, "Error reading temp file.");
 
   // Copy the rest of the data over.
-  if (!CopyFileWithClusterRewrite(temp_reader.get(), real_writer.get(),
-                                  cluster()->Size())) {
+  if (clusters_finalized) {
+    if (real_writer->WriteFromFile(temp_reader.get()) < 0)
+      return Status(error::FILE_FAILURE, "Error copying temp file.");
+    UpdateProgressForClusters();
+  } else if (!CopyFileWithClusterRewrite(temp_reader.get(), real_writer.get(),
+                                         cluster()->Size())) {
     return Status(error::FILE_FAILURE, "Error copying temp file.");
   }
 
   // Close and delete the temp file.
   temp_reader.reset();
+  DeleteTempFile();
+
+  return real_writer->Close();
+}
+
+void TwoPassSingleSegmentSegmenter::UpdateProgressForClusters() {
+  // Need to convert from WebM timecode to ISO BMFF.
+  for (int i = 0; i < cues()->cue_entries_size() - 1; ++i) {
+    const uint64_t webm_delta_time =
+        cues()->GetCueByIndex(i + 1)->time() - cues()->GetCueByIndex(i)->time();
+    UpdateProgress(FromWebMTimecode(webm_delta_time));
+  }
+}
+
+void TwoPassSingleSegmentSegmenter::DeleteTempFile() {
   if (!File::Delete(temp_file_name_.c_str())) {
     LOG(WARNING) << "Unable to delete temporary file " << temp_file_name_;
   }
-
-  return real_writer->Close();
 }
 
 bool TwoPassSingleSegmentSegmenter::CopyFileWithClusterRewrite(
@@ -40,6 +40,9 @@ class TwoPassSingleSegmentSegmenter : public SingleSegmentSegmenter {
   bool CopyFileWithClusterRewrite(File* source,
                                   MkvWriter* dest,
                                   uint64_t last_size);
+  // Updates the progress for the clusters copied from the temp file at once.
+  void UpdateProgressForClusters();
+  void DeleteTempFile();
 
   std::string temp_file_name_;
 
@@ -9,6 +9,7 @@
 
 #include "packager/base/logging.h"
 #include "packager/base/sys_byteorder.h"
+#include "packager/media/base/buffer_pool.h"
 #include "packager/media/base/decrypt_config.h"
 #include "packager/media/base/timestamp.h"
 #include "packager/media/codecs/vp8_parser.h"
@@ -392,8 +393,8 @@ bool WebMClusterParser::OnBlock(bool is_simple_block,
         buffer->set_decrypt_config(std::move(decrypt_config));
         buffer->set_is_encrypted(true);
       } else {
-        std::shared_ptr<uint8_t> decrypted_media_data(
-            new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
+        std::shared_ptr<uint8_t> decrypted_media_data =
+            BufferPool::GetInstance()->Allocate(media_data_size);
         if (!decryptor_source_->DecryptSampleBuffer(
                 decrypt_config.get(), media_data, media_data_size,
                 decrypted_media_data.get())) {
@@ -479,7 +480,7 @@ bool WebMClusterParser::OnBlock(bool is_simple_block,
     }
   }
 
-  return track->EmitBuffer(buffer);
+  return track->EmitBuffer(std::move(buffer));
 }
 
 WebMClusterParser::Track::Track(int track_num,
@@ -497,7 +498,7 @@ WebMClusterParser::Track::Track(int track_num,
 WebMClusterParser::Track::~Track() {}
 
 bool WebMClusterParser::Track::EmitBuffer(
-    const std::shared_ptr<MediaSample>& buffer) {
+    std::shared_ptr<MediaSample> buffer) {
   DVLOG(2) << "EmitBuffer() : " << track_num_
            << " ts " << buffer->pts()
            << " dur " << buffer->duration()
@@ -517,19 +518,19 @@ bool WebMClusterParser::Track::EmitBuffer(
              << " kf " << last_added_buffer_missing_duration_->is_key_frame()
              << " size " << last_added_buffer_missing_duration_->data_size();
     std::shared_ptr<MediaSample> updated_buffer =
-        last_added_buffer_missing_duration_;
+        std::move(last_added_buffer_missing_duration_);
     last_added_buffer_missing_duration_ = NULL;
-    if (!EmitBufferHelp(updated_buffer))
+    if (!EmitBufferHelp(std::move(updated_buffer)))
       return false;
   }
 
   if (buffer->duration() == kNoTimestamp) {
-    last_added_buffer_missing_duration_ = buffer;
+    last_added_buffer_missing_duration_ = std::move(buffer);
     DVLOG(2) << "EmitBuffer() : holding back buffer that is missing duration";
     return true;
   }
 
-  return EmitBufferHelp(buffer);
+  return EmitBufferHelp(std::move(buffer));
 }
 
 bool WebMClusterParser::Track::ApplyDurationEstimateIfNeeded() {
@@ -552,7 +553,8 @@ bool WebMClusterParser::Track::ApplyDurationEstimateIfNeeded() {
 
   // Don't use the applied duration as a future estimation (don't use
   // EmitBufferHelp() here.)
-  if (!new_sample_cb_.Run(track_num_, last_added_buffer_missing_duration_))
+  if (!new_sample_cb_.Run(track_num_,
+                          std::move(last_added_buffer_missing_duration_)))
     return false;
   last_added_buffer_missing_duration_ = NULL;
   return true;
@@ -563,7 +565,7 @@ void WebMClusterParser::Track::Reset() {
 }
 
 bool WebMClusterParser::Track::EmitBufferHelp(
-    const std::shared_ptr<MediaSample>& buffer) {
+    std::shared_ptr<MediaSample> buffer) {
   DCHECK(!last_added_buffer_missing_duration_.get());
 
   int64_t duration = buffer->duration();
@@ -593,7 +595,7 @@ bool WebMClusterParser::Track::EmitBufferHelp(
     }
   }
 
-  return new_sample_cb_.Run(track_num_, buffer);
+  return new_sample_cb_.Run(track_num_, std::move(buffer));
 }
 
 int64_t WebMClusterParser::Track::GetDurationEstimate() {
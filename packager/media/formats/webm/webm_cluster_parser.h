@@ -50,7 +50,7 @@ class WebMClusterParser : public WebMParserClient {
     // relative to |buffer|'s timestamp, and emits it and unsets
     // |last_added_buffer_missing_duration_|. Otherwise, if |buffer| is missing
     // duration, saves |buffer| into |last_added_buffer_missing_duration_|.
-    bool EmitBuffer(const std::shared_ptr<MediaSample>& buffer);
+    bool EmitBuffer(std::shared_ptr<MediaSample> buffer);
 
     // If |last_added_buffer_missing_duration_| is set, estimate the duration
     // for this buffer using helper function GetDurationEstimate() then emits it
@@ -67,7 +67,7 @@ class WebMClusterParser : public WebMParserClient {
     // |estimated_next_frame_duration_|, and emits |buffer|.
     // Returns false if |buffer| failed sanity check and therefore was not
     // emitted. Returns true otherwise.
-    bool EmitBufferHelp(const std::shared_ptr<MediaSample>& buffer);
+    bool EmitBufferHelp(std::shared_ptr<MediaSample> buffer);
 
     // Helper function that calculates the buffer duration to use in
     // ApplyDurationEstimateIfNeeded().
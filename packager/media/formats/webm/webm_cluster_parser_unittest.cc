@@ -378,7 +378,7 @@ class WebMClusterParserTest : public testing::Test {
   }
 
   bool NewSampleEvent(uint32_t track_id,
-                      const std::shared_ptr<MediaSample>& sample) {
+                      std::shared_ptr<MediaSample> sample) {
     switch (track_id) {
       case kAudioTrackNum:
         audio_buffers_.push_back(sample);
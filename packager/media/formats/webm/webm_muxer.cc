@@ -58,14 +58,15 @@ Status WebMMuxer::Finalize() {
   return Status::OK;
 }
 
-Status WebMMuxer::AddSample(size_t stream_id, const MediaSample& sample) {
+Status WebMMuxer::AddSample(size_t stream_id,
+                            std::shared_ptr<const MediaSample> sample) {
   DCHECK(segmenter_);
   DCHECK_EQ(stream_id, 0u);
-  if (sample.pts() < 0) {
-    LOG(ERROR) << "Seeing negative timestamp " << sample.pts();
+  if (sample->pts() < 0) {
+    LOG(ERROR) << "Seeing negative timestamp " << sample->pts();
     return Status(error::MUXER_FAILURE, "Unsupported negative timestamp.");
   }
-  return segmenter_->AddSample(sample);
+  return segmenter_->AddSample(std::move(sample));
 }
 
 Status WebMMuxer::FinalizeSegment(size_t stream_id,
@@ -26,7 +26,8 @@ class WebMMuxer : public Muxer {
   // Muxer implementation overrides.
   Status InitializeMuxer() override;
   Status Finalize() override;
-  Status AddSample(size_t stream_id, const MediaSample& sample) override;
+  Status AddSample(size_t stream_id,
+                   std::shared_ptr<const MediaSample> sample) override;
   Status FinalizeSegment(size_t stream_id,
                          const SegmentInfo& segment_info) override;
 
@@ -6,11 +6,20 @@
 
 #include "packager/media/formats/webvtt/text_readers.h"
 
+#include <algorithm>
+
 #include "packager/base/logging.h"
 #include "packager/file/file.h"
 
 namespace shaka {
 namespace media {
+namespace {
+const size_t kFileReaderBufferSize = 64 * 1024;
+
+bool IsLineTerminator(char c) {
+  return c == '\n' || c == '\r';
+}
+}  // namespace
 
 Status FileReader::Open(const std::string& filename,
                         std::unique_ptr<FileReader>* out) {
@@ -30,38 +39,46 @@ Status FileReader::Open(const std::string& filename,
 }
 
 bool FileReader::Next(char* out) {
-  // TODO(vaage): If file reading performance is poor, change this to buffer
-  //              data and read from the buffer.
-  return file_->Read(out, 1) == 1;
+  DCHECK(out);
+  if (!Peek(out))
+    return false;
+  Consume(1);
+  return true;
 }
 
-FileReader::FileReader(std::unique_ptr<File, FileCloser> file)
-    : file_(std::move(file)) {
-  DCHECK(file_);
+bool FileReader::Peek(char* out) {
+  DCHECK(out);
+  const char* data;
+  size_t size;
+  if (!GetBufferedData(&data, &size))
+    return false;
+  *out = data[0];
+  return true;
 }
 
-PeekingReader::PeekingReader(std::unique_ptr<FileReader> source)
-    : source_(std::move(source)) {}
-
-bool PeekingReader::Next(char* out) {
-  DCHECK(out);
-  if (Peek(out)) {
-    has_cached_next_ = false;
-    return true;
+bool FileReader::GetBufferedData(const char** data, size_t* size) {
+  DCHECK(data);
+  DCHECK(size);
+  if (buffer_pos_ == buffer_end_) {
+    const int64_t bytes_read = file_->Read(buffer_.data(), buffer_.size());
+    if (bytes_read <= 0)
+      return false;
+    buffer_pos_ = 0;
+    buffer_end_ = static_cast<size_t>(bytes_read);
   }
-  return false;
+  *data = buffer_.data() + buffer_pos_;
+  *size = buffer_end_ - buffer_pos_;
+  return true;
 }
 
-bool PeekingReader::Peek(char* out) {
-  DCHECK(out);
-  if (!has_cached_next_ && source_->Next(&cached_next_)) {
-    has_cached_next_ = true;
-  }
-  if (has_cached_next_) {
-    *out = cached_next_;
-    return true;
-  }
-  return false;
+void FileReader::Consume(size_t size) {
+  DCHECK_LE(size, buffer_end_ - buffer_pos_);
+  buffer_pos_ += size;
+}
+
+FileReader::FileReader(std::unique_ptr<File, FileCloser> file)
+    : file_(std::move(file)), buffer_(kFileReaderBufferSize) {
+  DCHECK(file_);
 }
 
 LineReader::LineReader(std::unique_ptr<FileReader> source)
@@ -72,22 +89,25 @@ bool LineReader::Next(std::string* out) {
   DCHECK(out);
   out->clear();
   bool read_something = false;
-  char now;
-  while (source_.Next(&now)) {
+  const char* data;
+  size_t size;
+  // Copy the line from the buffer a buffered block at a time, as a line may
+  // span multiple blocks.
+  while (source_->GetBufferedData(&data, &size)) {
     read_something = true;
-    // handle \n
-    if (now == '\n') {
-      break;
+    const char* end = data + size;
+    const char* terminator = std::find_if(data, end, IsLineTerminator);
+    out->append(data, terminator - data);
+    if (terminator == end) {
+      source_->Consume(size);
+      continue;
     }
-    // handle \r and \r\n
-    if (now == '\r') {
-      char next;
-      if (source_.Peek(&next) && next == '\n') {
-        source_.Next(&next);  // Read in the '\n' that was just seen via |Peek|
-      }
-      break;
-    }
-    out->push_back(now);
+    source_->Consume(terminator - data + 1);
+    // handle \r\n
+    char next;
+    if (*terminator == '\r' && source_->Peek(&next) && next == '\n')
+      source_->Consume(1);
+    break;
   }
   return read_something;
 }
@@ -98,23 +118,29 @@ BlockReader::BlockReader(std::unique_ptr<FileReader> source)
 bool BlockReader::Next(std::vector<std::string>* out) {
   DCHECK(out);
 
-  out->clear();
-
   bool in_block = false;
 
   // Read through lines until a non-empty line is found. With a non-empty
   // line is found, start adding the lines to the output and once an empty
   // line if found again, stop adding lines and exit.
-  std::string line;
-  while (source_.Next(&line)) {
-    if (in_block && line.empty()) {
+  // The lines are read directly into the strings of |out|, so their storage
+  // is reused when the same vector is used to read every block.
+  size_t num_lines = 0;
+  while (true) {
+    if (out->size() == num_lines)
+      out->emplace_back();
+    std::string& line = (*out)[num_lines];
+    if (!source_.Next(&line))
       break;
+    if (line.empty()) {
+      if (in_block)
+        break;
+      continue;
     }
-    if (in_block || !line.empty()) {
-      out->push_back(line);
-      in_block = true;
-    }
+    ++num_lines;
+    in_block = true;
   }
+  out->resize(num_lines);
 
   return in_block;
 }
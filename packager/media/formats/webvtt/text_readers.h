@@ -19,7 +19,8 @@ class File;
 
 namespace media {
 
-/// Class to read character-by-character from a file.
+/// Class to read from a file through a buffer, so the file is read in large
+/// blocks even when the data is consumed character-by-character.
 class FileReader {
  public:
   /// Create a new file reader by opening a file. If the file fails to open (in
@@ -34,6 +35,22 @@ class FileReader {
   /// character false will be returned.
   bool Next(char* out);
 
+  /// Read the next character from the file without consuming it. If there is
+  /// a next character, |out| will be set and true will be returned. If there
+  /// is no next character false will be returned.
+  bool Peek(char* out);
+
+  /// Get the buffered data which has not been consumed yet, reading the next
+  /// block of the file if all of the buffered data has been consumed. The
+  /// data stays valid until the next call to a non-const method.
+  /// @param data will be set to point to the buffered data.
+  /// @param size will be set to the size of the buffered data.
+  /// @return false if there is no more data.
+  bool GetBufferedData(const char** data, size_t* size);
+
+  /// Consume @a size bytes of the data returned by GetBufferedData().
+  void Consume(size_t size);
+
  private:
   explicit FileReader(std::unique_ptr<File, FileCloser> file);
 
@@ -41,22 +58,10 @@ class FileReader {
   FileReader operator=(const FileReader& reader) = delete;
 
   std::unique_ptr<File, FileCloser> file_;
-};
-
-class PeekingReader {
- public:
-  explicit PeekingReader(std::unique_ptr<FileReader> source);
-
-  bool Peek(char* out);
-  bool Next(char* out);
-
- private:
-  PeekingReader(const PeekingReader&) = delete;
-  PeekingReader operator=(const PeekingReader&) = delete;
-
-  std::unique_ptr<FileReader> source_;
-  char cached_next_ = 0;
-  bool has_cached_next_ = false;
+  std::vector<char> buffer_;
+  // The buffered data not consumed yet is [buffer_pos_, buffer_end_).
+  size_t buffer_pos_ = 0;
+  size_t buffer_end_ = 0;
 };
 
 class LineReader {
@@ -69,7 +74,7 @@ class LineReader {
   LineReader(const LineReader&) = delete;
   LineReader operator=(const LineReader&) = delete;
 
-  PeekingReader source_;
+  std::unique_ptr<FileReader> source_;
 };
 
 class BlockReader {
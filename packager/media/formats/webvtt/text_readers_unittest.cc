@@ -6,6 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 #include "packager/file/file.h"
 #include "packager/media/formats/webvtt/text_readers.h"
 #include "packager/status_test_util.h"
@@ -41,26 +44,24 @@ TEST(TextReadersTest, Peeking) {
 
   ASSERT_TRUE(File::WriteStringToFile(kFilename, text));
 
-  std::unique_ptr<FileReader> source;
-  ASSERT_OK(FileReader::Open(kFilename, &source));
-
-  PeekingReader reader(std::move(source));
+  std::unique_ptr<FileReader> reader;
+  ASSERT_OK(FileReader::Open(kFilename, &reader));
 
   char c;
-  ASSERT_TRUE(reader.Peek(&c));
+  ASSERT_TRUE(reader->Peek(&c));
   ASSERT_EQ(c, 'a');
-  ASSERT_TRUE(reader.Next(&c));
+  ASSERT_TRUE(reader->Next(&c));
   ASSERT_EQ(c, 'a');
-  ASSERT_TRUE(reader.Peek(&c));
+  ASSERT_TRUE(reader->Peek(&c));
   ASSERT_EQ(c, 'b');
-  ASSERT_TRUE(reader.Next(&c));
+  ASSERT_TRUE(reader->Next(&c));
   ASSERT_EQ(c, 'b');
-  ASSERT_TRUE(reader.Peek(&c));
+  ASSERT_TRUE(reader->Peek(&c));
   ASSERT_EQ(c, 'c');
-  ASSERT_TRUE(reader.Next(&c));
+  ASSERT_TRUE(reader->Next(&c));
   ASSERT_EQ(c, 'c');
-  ASSERT_FALSE(reader.Peek(&c));
-  ASSERT_FALSE(reader.Next(&c));
+  ASSERT_FALSE(reader->Peek(&c));
+  ASSERT_FALSE(reader->Next(&c));
 }
 
 TEST(TextReadersTest, ReadLinesWithNewLine) {
@@ -198,6 +199,94 @@ TEST(TextReadersTest, ReadBlocksSkipBlankLinesBeforeBlocks) {
   ASSERT_FALSE(reader.Next(&block));
 }
 
+TEST(TextReadersTest, GetBufferedData) {
+  const char* text = "abcd";
+
+  ASSERT_TRUE(File::WriteStringToFile(kFilename, text));
+
+  std::unique_ptr<FileReader> source;
+  ASSERT_OK(FileReader::Open(kFilename, &source));
+
+  const char* data;
+  size_t size;
+  ASSERT_TRUE(source->GetBufferedData(&data, &size));
+  ASSERT_EQ("abcd", std::string(data, size));
+  source->Consume(1);
+  ASSERT_TRUE(source->GetBufferedData(&data, &size));
+  ASSERT_EQ("bcd", std::string(data, size));
+
+  char c;
+  ASSERT_TRUE(source->Next(&c));
+  ASSERT_EQ(c, 'b');
+  source->Consume(2);
+  ASSERT_FALSE(source->GetBufferedData(&data, &size));
+  ASSERT_FALSE(source->Next(&c));
+}
+
+// Lines longer than the buffer of FileReader, and "\r\n" split across the
+// boundaries of the buffered blocks.
+TEST(TextReadersTest, ReadLinesAcrossBufferedBlocks) {
+  // The size of the blocks FileReader reads.
+  const size_t kBlockSize = 64 * 1024;
+  // The "\r" is the last byte of the first block.
+  const std::string first_line(kBlockSize - 1, 'a');
+  // The line spans the second and third blocks, and its "\r" is the last byte
+  // of the third block.
+  const std::string second_line(2 * kBlockSize - 2, 'b');
+  const std::string last_line = "c";
+  const std::string text =
+      first_line + "\r\n" + second_line + "\r\n" + last_line;
+  ASSERT_EQ('\r', text[kBlockSize - 1]);
+  ASSERT_EQ('\r', text[3 * kBlockSize - 1]);
+
+  ASSERT_TRUE(File::WriteStringToFile(kFilename, text.c_str()));
+
+  std::unique_ptr<FileReader> source;
+  ASSERT_OK(FileReader::Open(kFilename, &source));
+
+  LineReader reader(std::move(source));
+
+  std::vector<std::string> lines;
+  std::string s;
+  while (reader.Next(&s))
+    lines.push_back(s);
+  ASSERT_EQ(3u, lines.size());
+  EXPECT_EQ(first_line, lines[0]);
+  EXPECT_EQ(second_line, lines[1]);
+  EXPECT_EQ(last_line, lines[2]);
+}
+
+// A multi-megabyte file read with the same block vector, as WebVttParser
+// does.
+TEST(TextReadersTest, ReadBlocksFromLargeFile) {
+  const int kNumCues = 50000;
+  std::string text = "WEBVTT\n\n";
+  for (int i = 0; i < kNumCues; ++i) {
+    text += "cue " + std::to_string(i) + "\n";
+    text += "00:00:00.000 --> 00:00:01.000\n";
+    text += "Some cue payload which is long enough to be realistic\n\n";
+  }
+
+  ASSERT_TRUE(File::WriteStringToFile(kFilename, text.c_str()));
+
+  std::unique_ptr<FileReader> source;
+  ASSERT_OK(FileReader::Open(kFilename, &source));
+
+  BlockReader reader(std::move(source));
+
+  std::vector<std::string> block;
+  ASSERT_TRUE(reader.Next(&block));
+  ASSERT_EQ(1u, block.size());
+  ASSERT_EQ("WEBVTT", block[0]);
+
+  for (int i = 0; i < kNumCues; ++i) {
+    ASSERT_TRUE(reader.Next(&block));
+    ASSERT_EQ(3u, block.size());
+    ASSERT_EQ("cue " + std::to_string(i), block[0]);
+  }
+  ASSERT_FALSE(reader.Next(&block));
+}
+
 TEST(TextReadersTest, ReadBlocksWithOnlyBlankLines) {
   const char* text = "\n\n\n\n";
 
@@ -486,9 +486,8 @@ bool WvmMediaParser::Parse(const uint8_t* buf, int size) {
   return true;
 }
 
-bool WvmMediaParser::EmitLastSample(
-    uint32_t stream_id,
-    const std::shared_ptr<MediaSample>& new_sample) {
+bool WvmMediaParser::EmitLastSample(uint32_t stream_id,
+                                    std::shared_ptr<MediaSample> new_sample) {
   std::string key = base::UintToString(current_program_id_)
                         .append(":")
                         .append(base::UintToString(stream_id));
@@ -496,7 +495,7 @@ bool WvmMediaParser::EmitLastSample(
       program_demux_stream_map_.find(key);
   if (it == program_demux_stream_map_.end())
     return false;
-  return EmitSample(stream_id, (*it).second, new_sample, true);
+  return EmitSample(stream_id, (*it).second, std::move(new_sample), true);
 }
 
 bool WvmMediaParser::EmitPendingSamples() {
@@ -506,7 +505,7 @@ bool WvmMediaParser::EmitPendingSamples() {
         media_sample_queue_.front();
     if (!EmitSample(demux_stream_media_sample.parsed_audio_or_video_stream_id,
                     demux_stream_media_sample.demux_stream_id,
-                    demux_stream_media_sample.media_sample,
+                    std::move(demux_stream_media_sample.media_sample),
                     false)) {
       return false;
     }
@@ -520,7 +519,7 @@ bool WvmMediaParser::Flush() {
   // Reset the streamID when successfully emitted.
   if (prev_media_sample_data_.audio_sample != NULL) {
     if (!EmitLastSample(prev_pes_stream_id_,
-                        prev_media_sample_data_.audio_sample)) {
+                        std::move(prev_media_sample_data_.audio_sample))) {
       LOG(ERROR) << "Did not emit last sample for audio stream with ID = "
                  << prev_pes_stream_id_;
       return false;
@@ -528,7 +527,7 @@ bool WvmMediaParser::Flush() {
   }
   if (prev_media_sample_data_.video_sample != NULL) {
     if (!EmitLastSample(prev_pes_stream_id_,
-                        prev_media_sample_data_.video_sample)) {
+                        std::move(prev_media_sample_data_.video_sample))) {
       LOG(ERROR) << "Did not emit last sample for video stream with ID = "
                  << prev_pes_stream_id_;
       return false;
@@ -976,14 +975,14 @@ bool WvmMediaParser::Output(bool output_encrypted_sample) {
     // this method.
     return false;
   }
-  DemuxStreamIdMediaSample demux_stream_media_sample;
-  demux_stream_media_sample.parsed_audio_or_video_stream_id =
-      prev_pes_stream_id_;
-  demux_stream_media_sample.demux_stream_id = (*it).second;
-  demux_stream_media_sample.media_sample = media_sample_;
   // Check if sample can be emitted.
   if (!is_initialized_) {
-    media_sample_queue_.push_back(demux_stream_media_sample);
+    DemuxStreamIdMediaSample demux_stream_media_sample;
+    demux_stream_media_sample.parsed_audio_or_video_stream_id =
+        prev_pes_stream_id_;
+    demux_stream_media_sample.demux_stream_id = (*it).second;
+    demux_stream_media_sample.media_sample = std::move(media_sample_);
+    media_sample_queue_.push_back(std::move(demux_stream_media_sample));
   } else {
     // flush the sample queue and emit all queued samples.
     while (!media_sample_queue_.empty()) {
@@ -991,15 +990,17 @@ bool WvmMediaParser::Output(bool output_encrypted_sample) {
         return false;
     }
     // Emit current sample.
-    if (!EmitSample(prev_pes_stream_id_, (*it).second, media_sample_, false))
+    if (!EmitSample(prev_pes_stream_id_, (*it).second,
+                    std::move(media_sample_), false)) {
       return false;
+    }
   }
   return true;
 }
 
 bool WvmMediaParser::EmitSample(uint32_t parsed_audio_or_video_stream_id,
                                 uint32_t stream_id,
-                                const std::shared_ptr<MediaSample>& new_sample,
+                                std::shared_ptr<MediaSample> new_sample,
                                 bool isLastSample) {
   DCHECK(new_sample);
   if (isLastSample) {
@@ -1010,7 +1011,7 @@ bool WvmMediaParser::EmitSample(uint32_t parsed_audio_or_video_stream_id,
                kPesStreamIdAudio) {
       new_sample->set_duration(prev_media_sample_data_.audio_sample_duration);
     }
-    if (!new_sample_cb_.Run(stream_id, new_sample)) {
+    if (!new_sample_cb_.Run(stream_id, std::move(new_sample))) {
       LOG(ERROR) << "Failed to process the last sample.";
       return false;
     }
@@ -1022,7 +1023,7 @@ bool WvmMediaParser::EmitSample(uint32_t parsed_audio_or_video_stream_id,
   if ((parsed_audio_or_video_stream_id & kPesStreamIdVideoMask) ==
       kPesStreamIdVideo) {
     if (prev_media_sample_data_.video_sample == NULL) {
-      prev_media_sample_data_.video_sample = new_sample;
+      prev_media_sample_data_.video_sample = std::move(new_sample);
       prev_media_sample_data_.video_stream_id = stream_id;
       return true;
     }
@@ -1031,16 +1032,16 @@ bool WvmMediaParser::EmitSample(uint32_t parsed_audio_or_video_stream_id,
     prev_media_sample_data_.video_sample_duration =
         prev_media_sample_data_.video_sample->duration();
     if (!new_sample_cb_.Run(prev_media_sample_data_.video_stream_id,
-                            prev_media_sample_data_.video_sample)) {
+                            std::move(prev_media_sample_data_.video_sample))) {
       LOG(ERROR) << "Failed to process the video sample.";
       return false;
     }
-    prev_media_sample_data_.video_sample = new_sample;
+    prev_media_sample_data_.video_sample = std::move(new_sample);
     prev_media_sample_data_.video_stream_id = stream_id;
   } else if ((parsed_audio_or_video_stream_id & kPesStreamIdAudioMask) ==
              kPesStreamIdAudio) {
     if (prev_media_sample_data_.audio_sample == NULL) {
-      prev_media_sample_data_.audio_sample = new_sample;
+      prev_media_sample_data_.audio_sample = std::move(new_sample);
       prev_media_sample_data_.audio_stream_id = stream_id;
       return true;
     }
@@ -1049,11 +1050,11 @@ bool WvmMediaParser::EmitSample(uint32_t parsed_audio_or_video_stream_id,
     prev_media_sample_data_.audio_sample_duration =
         prev_media_sample_data_.audio_sample->duration();
     if (!new_sample_cb_.Run(prev_media_sample_data_.audio_stream_id,
-                            prev_media_sample_data_.audio_sample)) {
+                            std::move(prev_media_sample_data_.audio_sample))) {
       LOG(ERROR) << "Failed to process the audio sample.";
       return false;
     }
-    prev_media_sample_data_.audio_sample = new_sample;
+    prev_media_sample_data_.audio_sample = std::move(new_sample);
     prev_media_sample_data_.audio_stream_id = stream_id;
   }
   return true;
@@ -206,13 +206,13 @@ class WvmMediaParser : public MediaParser {
   // to emit a new audio/video access unit.
   bool EmitSample(uint32_t parsed_audio_or_video_stream_id,
                   uint32_t stream_id,
-                  const std::shared_ptr<MediaSample>& new_sample,
+                  std::shared_ptr<MediaSample> new_sample,
                   bool isLastSample);
 
   bool EmitPendingSamples();
 
   bool EmitLastSample(uint32_t stream_id,
-                      const std::shared_ptr<MediaSample>& new_sample);
+                      std::shared_ptr<MediaSample> new_sample);
 
   // List of callbacks.t
   InitCB init_cb_;
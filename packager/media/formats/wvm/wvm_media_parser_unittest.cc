@@ -100,7 +100,7 @@ class WvmMediaParserTest : public testing::Test {
   }
 
   bool OnNewSample(uint32_t track_id,
-                   const std::shared_ptr<MediaSample>& sample) {
+                   std::shared_ptr<MediaSample> sample) {
     std::string stream_type;
     if (static_cast<int32_t>(track_id) != current_track_id_) {
       // onto next track.
@@ -16,6 +16,8 @@ namespace media {
 /// downstream handlers. The messages that are sent downstream are not copies,
 /// they are the original message. It is the responsibility of downstream
 /// handlers to make a copy before modifying the message.
+/// The downstream handlers are called one after another. To run them in
+/// parallel, connect each of them through an AsyncBoundary.
 class Replicator : public MediaHandler {
  private:
   Status InitializeInternal() override;
@@ -0,0 +1,105 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/mpd/base/manifest_writer.h"
+
+#include <gflags/gflags.h>
+
+#include "packager/base/logging.h"
+
+DEFINE_double(manifest_write_delay,
+              0.1,
+              "Maximum delay, in seconds, before an updated live manifest is "
+              "written. Updates within the delay are coalesced into a single "
+              "write. Specify 0 to write the manifest as soon as possible.");
+
+namespace shaka {
+
+ManifestWriter::ManifestWriter(const WriteFunction& write_function)
+    : write_function_(write_function),
+      write_delay_(base::TimeDelta::FromMicroseconds(
+          static_cast<int64_t>(FLAGS_manifest_write_delay *
+                               base::Time::kMicrosecondsPerSecond))),
+      write_scheduled_cv_(&lock_) {
+  DCHECK(write_function_);
+}
+
+ManifestWriter::~ManifestWriter() {
+  {
+    base::AutoLock auto_lock(lock_);
+    stopped_ = true;
+    write_scheduled_cv_.Signal();
+  }
+  if (thread_)
+    thread_->Join();
+  FlushScheduledWrite();
+}
+
+void ManifestWriter::ScheduleWrite() {
+  base::AutoLock auto_lock(lock_);
+  DCHECK(!stopped_);
+  if (write_scheduled_)
+    return;
+  write_scheduled_ = true;
+  write_scheduled_time_ = base::TimeTicks::Now();
+  if (!thread_) {
+    thread_.reset(new base::DelegateSimpleThread(this, "ManifestWriter"));
+    thread_->Start();
+  }
+  write_scheduled_cv_.Signal();
+}
+
+bool ManifestWriter::Flush() {
+  {
+    base::AutoLock auto_lock(lock_);
+    write_scheduled_ = false;
+  }
+  return Write();
+}
+
+bool ManifestWriter::FlushScheduledWrite() {
+  bool write_scheduled = false;
+  {
+    base::AutoLock auto_lock(lock_);
+    write_scheduled = write_scheduled_;
+    write_scheduled_ = false;
+  }
+  if (!write_scheduled) {
+    // Wait for the in-progress write, if any.
+    base::AutoLock auto_lock(write_lock_);
+    return true;
+  }
+  return Write();
+}
+
+void ManifestWriter::Run() {
+  base::AutoLock auto_lock(lock_);
+  while (!stopped_) {
+    if (!write_scheduled_) {
+      write_scheduled_cv_.Wait();
+      continue;
+    }
+    const base::TimeTicks write_time = write_scheduled_time_ + write_delay_;
+    const base::TimeTicks now = base::TimeTicks::Now();
+    if (now < write_time) {
+      // Give the updates arriving in the meantime a chance to be coalesced.
+      write_scheduled_cv_.TimedWait(write_time - now);
+      continue;
+    }
+    write_scheduled_ = false;
+
+    base::AutoUnlock auto_unlock(lock_);
+    if (!Write())
+      LOG(ERROR) << "Failed to write manifest asynchronously.";
+  }
+}
+
+bool ManifestWriter::Write() {
+  base::AutoLock auto_lock(write_lock_);
+  return write_function_();
+}
+
+}  // namespace shaka
@@ -0,0 +1,84 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef MPD_BASE_MANIFEST_WRITER_H_
+#define MPD_BASE_MANIFEST_WRITER_H_
+
+#include <functional>
+#include <memory>
+
+#include "packager/base/synchronization/condition_variable.h"
+#include "packager/base/synchronization/lock.h"
+#include "packager/base/threading/simple_thread.h"
+#include "packager/base/time/time.h"
+
+namespace shaka {
+
+/// Publishes manifests on a dedicated thread, so the threads updating the
+/// manifests do not wait for them to be serialized and written. Writes
+/// scheduled before the pending write starts are coalesced into one write,
+/// which starts no later than --manifest_write_delay after the first of them
+/// was scheduled. Used by both MPD and HLS notifiers.
+/// This class is thread safe.
+class ManifestWriter : public base::DelegateSimpleThread::Delegate {
+ public:
+  /// Writes the manifests. Called on the writer thread for scheduled writes,
+  /// or on the calling thread for Flush() and FlushScheduledWrite(), but never
+  /// concurrently.
+  /// @return true on success, false otherwise.
+  typedef std::function<bool()> WriteFunction;
+
+  /// @param write_function is called to write the manifests.
+  explicit ManifestWriter(const WriteFunction& write_function);
+
+  /// Stops the writer thread and runs the scheduled write, if any, on the
+  /// calling thread.
+  ~ManifestWriter() override;
+
+  /// Schedule an asynchronous write. The writer thread is started on the
+  /// first call.
+  void ScheduleWrite();
+
+  /// Write the manifests on the calling thread, cancelling the scheduled
+  /// write, if any. Waits for the in-progress asynchronous write to complete
+  /// first, so the manifests written here are never overwritten by an older
+  /// version.
+  /// @return The result of the write.
+  bool Flush();
+
+  /// Run the scheduled write, if any, on the calling thread, after waiting for
+  /// the in-progress asynchronous write to complete.
+  /// @return The result of the write, or true if no write was scheduled.
+  bool FlushScheduledWrite();
+
+ private:
+  ManifestWriter(const ManifestWriter&) = delete;
+  ManifestWriter& operator=(const ManifestWriter&) = delete;
+
+  // base::DelegateSimpleThread::Delegate implementation.
+  void Run() override;
+
+  // Calls |write_function_| with |write_lock_| held.
+  bool Write();
+
+  const WriteFunction write_function_;
+  const base::TimeDelta write_delay_;
+
+  base::Lock lock_;
+  base::ConditionVariable write_scheduled_cv_;
+  bool write_scheduled_ = false;
+  bool stopped_ = false;
+  // The time the first of the coalesced writes was scheduled.
+  base::TimeTicks write_scheduled_time_;
+  std::unique_ptr<base::DelegateSimpleThread> thread_;
+
+  // Serializes calls to |write_function_|.
+  base::Lock write_lock_;
+};
+
+}  // namespace shaka
+
+#endif  // MPD_BASE_MANIFEST_WRITER_H_
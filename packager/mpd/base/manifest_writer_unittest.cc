@@ -0,0 +1,109 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "packager/base/synchronization/waitable_event.h"
+#include "packager/base/time/time.h"
+#include "packager/mpd/base/manifest_writer.h"
+
+DECLARE_double(manifest_write_delay);
+
+namespace shaka {
+
+namespace {
+const double kLongWriteDelayInSeconds = 3600;
+const int64_t kTimeoutInSeconds = 10;
+}  // namespace
+
+class ManifestWriterTest : public ::testing::Test {
+ public:
+  ManifestWriterTest()
+      : write_event_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                     base::WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  void SetUp() override { saved_write_delay_ = FLAGS_manifest_write_delay; }
+  void TearDown() override { FLAGS_manifest_write_delay = saved_write_delay_; }
+
+ protected:
+  ManifestWriter::WriteFunction GetWriteFunction() {
+    return [this]() {
+      ++num_writes_;
+      write_event_.Signal();
+      return write_result_;
+    };
+  }
+
+  std::atomic<int> num_writes_{0};
+  bool write_result_ = true;
+  base::WaitableEvent write_event_;
+
+ private:
+  double saved_write_delay_ = 0;
+};
+
+TEST_F(ManifestWriterTest, ScheduledWriteRunsAsynchronously) {
+  FLAGS_manifest_write_delay = 0;
+  ManifestWriter writer(GetWriteFunction());
+  writer.ScheduleWrite();
+  ASSERT_TRUE(write_event_.TimedWait(
+      base::TimeDelta::FromSeconds(kTimeoutInSeconds)));
+  EXPECT_EQ(1, num_writes_);
+}
+
+TEST_F(ManifestWriterTest, ScheduledWritesAreCoalesced) {
+  FLAGS_manifest_write_delay = kLongWriteDelayInSeconds;
+  ManifestWriter writer(GetWriteFunction());
+  for (int i = 0; i < 10; ++i)
+    writer.ScheduleWrite();
+  EXPECT_EQ(0, num_writes_);
+
+  EXPECT_TRUE(writer.FlushScheduledWrite());
+  EXPECT_EQ(1, num_writes_);
+  // Nothing scheduled any more.
+  EXPECT_TRUE(writer.FlushScheduledWrite());
+  EXPECT_EQ(1, num_writes_);
+}
+
+TEST_F(ManifestWriterTest, FlushCancelsScheduledWrite) {
+  FLAGS_manifest_write_delay = kLongWriteDelayInSeconds;
+  ManifestWriter writer(GetWriteFunction());
+  writer.ScheduleWrite();
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(1, num_writes_);
+  EXPECT_TRUE(writer.FlushScheduledWrite());
+  EXPECT_EQ(1, num_writes_);
+}
+
+TEST_F(ManifestWriterTest, FlushWithoutScheduledWrite) {
+  ManifestWriter writer(GetWriteFunction());
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(1, num_writes_);
+
+  write_result_ = false;
+  EXPECT_FALSE(writer.Flush());
+  EXPECT_EQ(2, num_writes_);
+}
+
+TEST_F(ManifestWriterTest, ScheduledWriteCompletedOnDestruction) {
+  FLAGS_manifest_write_delay = kLongWriteDelayInSeconds;
+  {
+    ManifestWriter writer(GetWriteFunction());
+    writer.ScheduleWrite();
+    EXPECT_EQ(0, num_writes_);
+  }
+  EXPECT_EQ(1, num_writes_);
+}
+
+TEST_F(ManifestWriterTest, NoWriteOnDestructionIfNothingScheduled) {
+  { ManifestWriter writer(GetWriteFunction()); }
+  EXPECT_EQ(0, num_writes_);
+}
+
+}  // namespace shaka
@@ -21,6 +21,7 @@
 #include "packager/mpd/base/period.h"
 #include "packager/mpd/base/representation.h"
 #include "packager/mpd/base/xml/xml_node.h"
+#include "packager/mpd/base/xml/xml_serializer.h"
 #include "packager/version/version.h"
 
 namespace shaka {
@@ -164,16 +165,7 @@ bool MpdBuilder::ToString(std::string* output) {
   if (!doc)
     return false;
 
-  static const int kNiceFormat = 1;
-  int doc_str_size = 0;
-  xmlChar* doc_str = nullptr;
-  xmlDocDumpFormatMemoryEnc(doc.get(), &doc_str, &doc_str_size, "UTF-8",
-                            kNiceFormat);
-  output->assign(doc_str, doc_str + doc_str_size);
-  xmlFree(doc_str);
-
-  // Cleanup, free the doc.
-  doc.reset();
+  xml::SerializeDocument(doc.get(), output);
   return true;
 }
 
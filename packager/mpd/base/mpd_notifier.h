@@ -104,6 +104,12 @@ class MpdNotifier {
   /// forces a flush.
   virtual bool Flush() = 0;
 
+  /// Call this method to publish an update of the MPD, e.g. a new segment in
+  /// live. Unlike Flush(), implementations may write out the MPD
+  /// asynchronously, and coalesce it with later updates.
+  /// @return true on success, false otherwise.
+  virtual bool FlushAsync() { return Flush(); }
+
   /// @return include_mspr_pro option flag
   bool include_mspr_pro() const { return mpd_options_.mpd_params.include_mspr_pro; }
 
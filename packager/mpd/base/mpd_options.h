@@ -13,6 +13,8 @@
 
 namespace shaka {
 
+class IoOperationGroup;
+
 enum class DashProfile {
   kUnknown,
   kOnDemand,
@@ -26,6 +28,10 @@ struct MpdOptions {
   DashProfile dash_profile = DashProfile::kOnDemand;
   MpdType mpd_type = MpdType::kStatic;
   MpdParams mpd_params;
+  /// The group of the asynchronous deletions of the segments outside of the
+  /// live window, so that they can be waited for. They are submitted to the
+  /// process-wide IoService directly if NULL.
+  IoOperationGroup* io_operations = nullptr;
 };
 
 }  // namespace shaka
@@ -13,6 +13,7 @@
 #include "packager/base/logging.h"
 #include "packager/base/strings/stringprintf.h"
 #include "packager/file/file.h"
+#include "packager/file/io_service.h"
 #include "packager/media/base/muxer_util.h"
 #include "packager/mpd/base/mpd_options.h"
 #include "packager/mpd/base/mpd_utils.h"
@@ -88,6 +89,7 @@ Representation::Representation(
     uint32_t id,
     std::unique_ptr<RepresentationStateChangeListener> state_change_listener)
     : media_info_(media_info),
+      failed_deletions_(new FailedDeletions),
       id_(id),
       mpd_options_(mpd_options),
       state_change_listener_(std::move(state_change_listener)),
@@ -270,7 +272,8 @@ xml::scoped_xml_ptr<xmlNode> Representation::GetXml() {
 
   if (HasLiveOnlyFields(media_info_) &&
       !representation.AddLiveOnlyInfo(media_info_, segment_infos_,
-                                      start_number_)) {
+                                      start_number_,
+                                      &segment_timeline_cache_)) {
     LOG(ERROR) << "Failed to add Live info.";
     return xml::scoped_xml_ptr<xmlNode>();
   }
@@ -452,18 +455,42 @@ void Representation::RemoveOldSegment(SegmentInfo* segment_info) {
   if (mpd_options_.mpd_params.preserved_segments_outside_live_window == 0)
     return;
 
+  {
+    // The segments which failed to be deleted are retried first.
+    base::AutoLock auto_lock(failed_deletions_->lock);
+    segments_to_be_removed_.splice(segments_to_be_removed_.begin(),
+                                   failed_deletions_->segment_names);
+  }
   segments_to_be_removed_.push_back(
       media::GetSegmentName(media_info_.segment_template(), segment_start_time,
                             start_number_ - 1, media_info_.bandwidth()));
   while (segments_to_be_removed_.size() >
          mpd_options_.mpd_params.preserved_segments_outside_live_window) {
-    VLOG(2) << "Deleting " << segments_to_be_removed_.front();
-    if (!File::Delete(segments_to_be_removed_.front().c_str())) {
-      LOG(WARNING) << "Failed to delete " << segments_to_be_removed_.front()
+    const std::string segment_name = segments_to_be_removed_.front();
+    segments_to_be_removed_.pop_front();
+    VLOG(2) << "Deleting " << segment_name;
+    // Deleted asynchronously, so that the manifest update is not held up by
+    // the file system.
+    std::shared_ptr<FailedDeletions> failed_deletions = failed_deletions_;
+    IoService::Operation operation = [segment_name]() {
+      return File::Delete(segment_name.c_str());
+    };
+    IoService::CompletionCallback callback = [segment_name,
+                                              failed_deletions](bool success) {
+      if (success)
+        return;
+      LOG(WARNING) << "Failed to delete " << segment_name
                    << "; Will retry later.";
-      break;
+      base::AutoLock auto_lock(failed_deletions->lock);
+      failed_deletions->segment_names.push_back(segment_name);
+    };
+    if (mpd_options_.io_operations) {
+      mpd_options_.io_operations->Submit(segment_name, std::move(operation),
+                                         std::move(callback));
+    } else {
+      IoService::GetInstance()->Submit(segment_name, std::move(operation),
+                                       std::move(callback));
     }
-    segments_to_be_removed_.pop_front();
   }
 }
 
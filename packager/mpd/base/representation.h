@@ -9,10 +9,12 @@
 #ifndef PACKAGER_MPD_BASE_REPRESENTATION_H_
 #define PACKAGER_MPD_BASE_REPRESENTATION_H_
 
+#include "packager/base/synchronization/lock.h"
 #include "packager/mpd/base/bandwidth_estimator.h"
 #include "packager/mpd/base/media_info.pb.h"
 #include "packager/mpd/base/segment_info.h"
 #include "packager/mpd/base/xml/scoped_xml_ptr.h"
+#include "packager/mpd/base/xml/xml_node.h"
 
 #include <stdint.h>
 
@@ -24,11 +26,6 @@ namespace shaka {
 struct ContentProtectionElement;
 struct MpdOptions;
 
-namespace xml {
-class XmlNode;
-class RepresentationXmlNode;
-}  // namespace xml
-
 class RepresentationStateChangeListener {
  public:
   RepresentationStateChangeListener() {}
@@ -217,9 +214,20 @@ class Representation {
   int64_t current_buffer_depth_ = 0;
   // TODO(kqyang): Address sliding window issue with multiple periods.
   std::list<SegmentInfo> segment_infos_;
+  // Serialized SegmentTimeline entries of |segment_infos_|, which are reused by
+  // the next GetXml() calls.
+  xml::SegmentTimelineCache segment_timeline_cache_;
   // A list to hold the file names of the segments to be removed temporarily.
-  // Once a file is actually removed, it is removed from the list.
+  // Once a file is submitted for deletion, it is removed from the list.
   std::list<std::string> segments_to_be_removed_;
+  // The segments which failed to be deleted, to be put back in
+  // |segments_to_be_removed_|. Shared with the pending deletions, which may
+  // complete after this representation is destroyed.
+  struct FailedDeletions {
+    base::Lock lock;
+    std::list<std::string> segment_names;
+  };
+  std::shared_ptr<FailedDeletions> failed_deletions_;
 
   const uint32_t id_;
   std::string mime_type_;
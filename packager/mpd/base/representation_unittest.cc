@@ -12,14 +12,17 @@
 #include <inttypes.h>
 
 #include "packager/base/strings/stringprintf.h"
+#include "packager/base/synchronization/lock.h"
 #include "packager/file/file.h"
 #include "packager/file/file_closer.h"
+#include "packager/file/io_service.h"
 #include "packager/mpd/base/mpd_options.h"
 #include "packager/mpd/test/mpd_builder_test_helper.h"
 #include "packager/mpd/test/xml_compare.h"
 
 using ::testing::Bool;
 using ::testing::Not;
+using ::testing::UnorderedElementsAre;
 using ::testing::Values;
 using ::testing::WithParamInterface;
 
@@ -1281,6 +1284,8 @@ class RepresentationDeleteSegmentsTest : public SegmentTimelineTestBase {
   }
 
   bool SegmentDeleted(const std::string& segment_name) {
+    // Segments are deleted asynchronously.
+    IoService::GetInstance()->Flush();
     std::unique_ptr<File, FileCloser> file_closer(
         File::Open(segment_name.c_str(), "r"));
     return file_closer.get() == nullptr;
@@ -1339,4 +1344,49 @@ TEST_F(RepresentationDeleteSegmentsTest, ManyRepeatingSegments) {
       kStringPrintTemplate, last_available_segment_index - 1)));
 }
 
+TEST_F(RepresentationDeleteSegmentsTest, RetriesFailedDeletions) {
+  // The segments are deleted through a callback, which fails the first
+  // deletion.
+  base::Lock lock;
+  bool fail_deletion = true;
+  std::vector<std::string> deleted_segments;
+  BufferCallbackParams callback_params;
+  callback_params.write_func = [&lock, &fail_deletion, &deleted_segments](
+                                   const std::string& name, const void* buffer,
+                                   uint64_t size) -> int64_t {
+    // A deletion is a write without a buffer.
+    EXPECT_FALSE(buffer);
+    base::AutoLock auto_lock(lock);
+    if (fail_deletion) {
+      fail_deletion = false;
+      return 0;
+    }
+    deleted_segments.push_back(name);
+    return 1;
+  };
+  MediaInfo media_info = ConvertToMediaInfo(GetDefaultMediaInfo());
+  media_info.set_segment_template(
+      File::MakeCallbackFileName(callback_params, "$Number$.mp4"));
+  media_info.set_segment_template_url(kSegmentTemplateUrl);
+  representation_ =
+      CreateRepresentation(media_info, kAnyRepresentationId, NoListener());
+  ASSERT_TRUE(representation_->Init());
+  IoOperationGroup io_operations(IoService::GetInstance());
+  mpd_options_.io_operations = &io_operations;
+
+  // The first segment fails to be deleted.
+  for (int i = 0; i <= kMaxNumSegmentsAvailable; ++i) {
+    AddSegments(kInitialStartTime + i * kDuration, kDuration, kSize, kNoRepeat);
+  }
+  io_operations.Flush();
+  EXPECT_TRUE(deleted_segments.empty());
+
+  // It is deleted again with the next segment.
+  AddSegments(kInitialStartTime + (kMaxNumSegmentsAvailable + 1) * kDuration,
+              kDuration, kSize, kNoRepeat);
+  io_operations.Flush();
+  mpd_options_.io_operations = nullptr;
+  EXPECT_THAT(deleted_segments, UnorderedElementsAre("1.mp4", "2.mp4"));
+}
+
 }  // namespace shaka
@@ -8,6 +8,7 @@
 
 #include "packager/base/logging.h"
 #include "packager/base/stl_util.h"
+#include "packager/file/file.h"
 #include "packager/mpd/base/adaptation_set.h"
 #include "packager/mpd/base/mpd_builder.h"
 #include "packager/mpd/base/mpd_notifier_util.h"
@@ -25,6 +26,8 @@ SimpleMpdNotifier::SimpleMpdNotifier(const MpdOptions& mpd_options)
           mpd_options.mpd_params.generate_dash_if_iop_compliant_mpd) {
   for (const std::string& base_url : mpd_options.mpd_params.base_urls)
     mpd_builder_->AddBaseUrl(base_url);
+  manifest_writer_.reset(
+      new ManifestWriter(std::bind(&SimpleMpdNotifier::WriteMpd, this)));
 }
 
 SimpleMpdNotifier::~SimpleMpdNotifier() {}
@@ -182,8 +185,33 @@ bool SimpleMpdNotifier::NotifyMediaInfoUpdate(uint32_t container_id,
 }
 
 bool SimpleMpdNotifier::Flush() {
-  base::AutoLock auto_lock(lock_);
-  return WriteMpdToFile(output_path_, mpd_builder_.get());
+  return manifest_writer_->Flush();
+}
+
+bool SimpleMpdNotifier::FlushAsync() {
+  manifest_writer_->ScheduleWrite();
+  return true;
+}
+
+bool SimpleMpdNotifier::WriteMpd() {
+  CHECK(!output_path_.empty());
+
+  // Serialize the MPD with |lock_| held, but write it without it, so the muxer
+  // threads are not blocked on file I/O.
+  std::string mpd;
+  {
+    base::AutoLock auto_lock(lock_);
+    if (!mpd_builder_->ToString(&mpd)) {
+      LOG(ERROR) << "Failed to write MPD to string.";
+      return false;
+    }
+  }
+
+  if (!File::WriteFileAtomically(output_path_.c_str(), mpd)) {
+    LOG(ERROR) << "Failed to write mpd to: " << output_path_;
+    return false;
+  }
+  return true;
 }
 
 }  // namespace shaka
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "packager/base/synchronization/lock.h"
+#include "packager/mpd/base/manifest_writer.h"
 #include "packager/mpd/base/mpd_notifier.h"
 #include "packager/mpd/base/mpd_notifier_util.h"
 
@@ -31,7 +32,8 @@ class SimpleMpdNotifier : public MpdNotifier {
   explicit SimpleMpdNotifier(const MpdOptions& mpd_options);
   ~SimpleMpdNotifier() override;
 
-  /// None of the methods write out the MPD file until Flush() is called.
+  /// None of the methods write out the MPD file until Flush() or FlushAsync()
+  /// is called.
   /// @name MpdNotifier implemetation overrides.
   /// @{
   bool Init() override;
@@ -50,6 +52,7 @@ class SimpleMpdNotifier : public MpdNotifier {
   bool NotifyMediaInfoUpdate(uint32_t container_id,
                              const MediaInfo& media_info) override;
   bool Flush() override;
+  bool FlushAsync() override;
   /// @}
 
  private:
@@ -58,6 +61,10 @@ class SimpleMpdNotifier : public MpdNotifier {
 
   friend class SimpleMpdNotifierTest;
 
+  // Serializes the MPD and writes it to |output_path_|. Called by
+  // |manifest_writer_|.
+  bool WriteMpd();
+
   // Testing only method. Returns a pointer to MpdBuilder.
   MpdBuilder* MpdBuilderForTesting() const { return mpd_builder_.get(); }
 
@@ -77,6 +84,10 @@ class SimpleMpdNotifier : public MpdNotifier {
   std::map<uint32_t, Representation*> representation_map_;
   // Maps Representation ID to AdaptationSet. This is for updating the PSSH.
   std::map<uint32_t, AdaptationSet*> representation_id_to_adaptation_set_;
+
+  // Declared last so it is destroyed, and the pending write completed, before
+  // the MPD builder.
+  std::unique_ptr<ManifestWriter> manifest_writer_;
 };
 
 }  // namespace shaka
@@ -7,6 +7,7 @@
 #include "packager/mpd/base/xml/xml_node.h"
 
 #include <gflags/gflags.h>
+#include <libxml/parserInternals.h>
 
 #include <limits>
 #include <set>
@@ -73,6 +74,25 @@ bool IsTimelineConstantDuration(const std::list<SegmentInfo>& segment_infos,
   return expected_last_segment_start_time == last_segment.start_time;
 }
 
+bool IsSameSegmentInfo(const SegmentInfo& segment_info1,
+                       const SegmentInfo& segment_info2) {
+  return segment_info1.start_time == segment_info2.start_time &&
+         segment_info1.duration == segment_info2.duration &&
+         segment_info1.repeat == segment_info2.repeat;
+}
+
+// Serializes the <S> element populated by PopulateSegmentTimeline().
+std::string SerializeSegmentInfo(const SegmentInfo& segment_info) {
+  std::string s_element = "<S t=\"" +
+                          base::Uint64ToString(segment_info.start_time) +
+                          "\" d=\"" +
+                          base::Uint64ToString(segment_info.duration) + "\"";
+  if (segment_info.repeat > 0)
+    s_element += " r=\"" + base::Uint64ToString(segment_info.repeat) + "\"";
+  s_element += "/>\n";
+  return s_element;
+}
+
 bool PopulateSegmentTimeline(const std::list<SegmentInfo>& segment_infos,
                              XmlNode* segment_timeline) {
   for (const SegmentInfo& segment_info : segment_infos) {
@@ -202,6 +222,17 @@ void XmlNode::SetContent(const std::string& content) {
   xmlNodeSetContent(node_.get(), BAD_CAST content.c_str());
 }
 
+void XmlNode::AddSerializedChildren(const std::string& serialized_children) {
+  DCHECK(node_);
+  if (serialized_children.empty())
+    return;
+  xmlNodePtr text = xmlNewTextLen(BAD_CAST serialized_children.data(),
+                                  serialized_children.size());
+  // A text node which is not escaped on output.
+  text->name = xmlStringTextNoenc;
+  CHECK(xmlAddChild(node_.get(), text));
+}
+
 std::set<std::string> XmlNode::ExtractReferencedNamespaces() {
   std::set<std::string> namespaces;
   TraverseNodesAndCollectNamespaces(node_.get(), &namespaces);
@@ -224,6 +255,54 @@ xmlNodePtr XmlNode::GetRawPtr() {
   return node_.get();
 }
 
+SegmentTimelineCache::SegmentTimelineCache() {}
+SegmentTimelineCache::~SegmentTimelineCache() {}
+
+const std::string& SegmentTimelineCache::Update(
+    const std::list<SegmentInfo>& segment_infos) {
+  // Segments are added or updated at the end of the timeline, and removed or
+  // updated at its start when the window slides, so the elements in between
+  // are reused.
+  auto segment_info = segment_infos.begin();
+  size_t removed_size = 0;
+  while (!entries_.empty() &&
+         (segment_info == segment_infos.end() ||
+          entries_.front().segment_info.start_time <
+              segment_info->start_time)) {
+    removed_size += entries_.front().size;
+    entries_.pop_front();
+  }
+  std::string prepended_elements;
+  std::deque<Entry> prepended_entries;
+  for (; !entries_.empty() && segment_info != segment_infos.end() &&
+         segment_info->start_time < entries_.front().segment_info.start_time;
+       ++segment_info) {
+    const std::string s_element = SerializeSegmentInfo(*segment_info);
+    prepended_elements += s_element;
+    prepended_entries.push_back({*segment_info, s_element.size()});
+  }
+  serialized_elements_.replace(0, removed_size, prepended_elements);
+  entries_.insert(entries_.begin(), prepended_entries.begin(),
+                  prepended_entries.end());
+
+  size_t reused_size = prepended_elements.size();
+  auto entry = entries_.begin() + prepended_entries.size();
+  for (; entry != entries_.end() && segment_info != segment_infos.end() &&
+         IsSameSegmentInfo(entry->segment_info, *segment_info);
+       ++entry, ++segment_info) {
+    reused_size += entry->size;
+  }
+  entries_.erase(entry, entries_.end());
+  serialized_elements_.resize(reused_size);
+
+  for (; segment_info != segment_infos.end(); ++segment_info) {
+    const std::string s_element = SerializeSegmentInfo(*segment_info);
+    serialized_elements_ += s_element;
+    entries_.push_back({*segment_info, s_element.size()});
+  }
+  return serialized_elements_;
+}
+
 RepresentationBaseXmlNode::RepresentationBaseXmlNode(const char* name)
     : XmlNode(name) {}
 RepresentationBaseXmlNode::~RepresentationBaseXmlNode() {}
@@ -407,7 +486,8 @@ bool RepresentationXmlNode::AddVODOnlyInfo(const MediaInfo& media_info) {
 bool RepresentationXmlNode::AddLiveOnlyInfo(
     const MediaInfo& media_info,
     const std::list<SegmentInfo>& segment_infos,
-    uint32_t start_number) {
+    uint32_t start_number,
+    SegmentTimelineCache* segment_timeline_cache) {
   XmlNode segment_template("SegmentTemplate");
   if (media_info.has_reference_time_scale()) {
     segment_template.SetIntegerAttribute("timescale",
@@ -447,10 +527,14 @@ bool RepresentationXmlNode::AddLiveOnlyInfo(
       }
     } else {
       XmlNode segment_timeline("SegmentTimeline");
-      if (!PopulateSegmentTimeline(segment_infos, &segment_timeline) ||
-          !segment_template.AddChild(segment_timeline.PassScopedPtr())) {
+      if (segment_timeline_cache) {
+        segment_timeline.AddSerializedChildren(
+            segment_timeline_cache->Update(segment_infos));
+      } else if (!PopulateSegmentTimeline(segment_infos, &segment_timeline)) {
         return false;
       }
+      if (!segment_template.AddChild(segment_timeline.PassScopedPtr()))
+        return false;
     }
   }
   return AddChild(segment_template.PassScopedPtr());
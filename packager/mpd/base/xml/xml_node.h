@@ -13,18 +13,18 @@
 #include <libxml/tree.h>
 #include <stdint.h>
 
+#include <deque>
 #include <list>
 #include <set>
+#include <string>
 
 #include "packager/base/macros.h"
 #include "packager/mpd/base/content_protection_element.h"
 #include "packager/mpd/base/media_info.pb.h"
+#include "packager/mpd/base/segment_info.h"
 #include "packager/mpd/base/xml/scoped_xml_ptr.h"
 
 namespace shaka {
-
-struct SegmentInfo;
-
 namespace xml {
 
 /// These classes are wrapper classes for XML elements for generating MPD.
@@ -74,6 +74,13 @@ class XmlNode {
   ///        be added to the element.
   void SetContent(const std::string& content);
 
+  /// Add child elements which are already serialized. They are output as is
+  /// by xml::SerializeDocument() and xml::SerializeNode(), which must be used
+  /// to serialize this element.
+  /// @param serialized_children contains the serialized child elements, one
+  ///        per line, without indentation.
+  void AddSerializedChildren(const std::string& serialized_children);
+
   /// @return namespaces used in the node and its descendents.
   std::set<std::string> ExtractReferencedNamespaces();
 
@@ -95,6 +102,32 @@ class XmlNode {
   DISALLOW_COPY_AND_ASSIGN(XmlNode);
 };
 
+/// Keeps the serialized <S> elements of a SegmentTimeline across MPD updates,
+/// so that only the segments added or changed since the previous update are
+/// serialized again.
+class SegmentTimelineCache {
+ public:
+  SegmentTimelineCache();
+  ~SegmentTimelineCache();
+
+  /// Update the cached <S> elements to match @a segment_infos.
+  /// @param segment_infos is a list of SegmentInfos sorted by start time.
+  /// @return The serialized <S> elements, one per line.
+  const std::string& Update(const std::list<SegmentInfo>& segment_infos);
+
+ private:
+  struct Entry {
+    SegmentInfo segment_info;
+    // Size of the serialized element in |serialized_elements_|.
+    size_t size;
+  };
+
+  std::deque<Entry> entries_;
+  std::string serialized_elements_;
+
+  DISALLOW_COPY_AND_ASSIGN(SegmentTimelineCache);
+};
+
 /// This corresponds to RepresentationBaseType in MPD. RepresentationBaseType is
 /// not a concrete element type so this should not get instantiated on its own.
 /// AdaptationSet and Representation are subtypes of this.
@@ -184,9 +217,13 @@ class RepresentationXmlNode : public RepresentationBaseXmlNode {
 
   /// @param segment_infos is a set of SegmentInfos. This method assumes that
   ///        SegmentInfos are sorted by its start time.
+  /// @param segment_timeline_cache, if not NULL, is used to add the
+  ///        SegmentTimeline entries as serialized children, reusing the ones
+  ///        serialized by the previous calls.
   bool AddLiveOnlyInfo(const MediaInfo& media_info,
                        const std::list<SegmentInfo>& segment_infos,
-                       uint32_t start_number);
+                       uint32_t start_number,
+                       SegmentTimelineCache* segment_timeline_cache);
 
  private:
   // Add AudioChannelConfiguration element. Note that it is a required element
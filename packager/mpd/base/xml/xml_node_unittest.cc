@@ -376,8 +376,8 @@ TEST_F(LiveSegmentTimelineTest, OneSegmentInfo) {
       {kStartTime, kDuration, kRepeat},
   };
   RepresentationXmlNode representation;
-  ASSERT_TRUE(
-      representation.AddLiveOnlyInfo(media_info_, segment_infos, kStartNumber));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber, nullptr));
 
   EXPECT_THAT(
       representation.GetRawPtr(),
@@ -397,8 +397,8 @@ TEST_F(LiveSegmentTimelineTest, OneSegmentInfoNonZeroStartTime) {
       {kNonZeroStartTime, kDuration, kRepeat},
   };
   RepresentationXmlNode representation;
-  ASSERT_TRUE(
-      representation.AddLiveOnlyInfo(media_info_, segment_infos, kStartNumber));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber, nullptr));
 
   EXPECT_THAT(representation.GetRawPtr(),
               XmlNodeEqual(
@@ -421,8 +421,8 @@ TEST_F(LiveSegmentTimelineTest, OneSegmentInfoMatchingStartTimeAndNumber) {
       {kNonZeroStartTime, kDuration, kRepeat},
   };
   RepresentationXmlNode representation;
-  ASSERT_TRUE(
-      representation.AddLiveOnlyInfo(media_info_, segment_infos, kStartNumber));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber, nullptr));
 
   EXPECT_THAT(
       representation.GetRawPtr(),
@@ -448,8 +448,8 @@ TEST_F(LiveSegmentTimelineTest, AllSegmentsSameDurationExpectLastOne) {
       {kStartTime2, kDuration2, kRepeat2},
   };
   RepresentationXmlNode representation;
-  ASSERT_TRUE(
-      representation.AddLiveOnlyInfo(media_info_, segment_infos, kStartNumber));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber, nullptr));
 
   EXPECT_THAT(
       representation.GetRawPtr(),
@@ -475,8 +475,8 @@ TEST_F(LiveSegmentTimelineTest, SecondSegmentInfoNonZeroRepeat) {
       {kStartTime2, kDuration2, kRepeat2},
   };
   RepresentationXmlNode representation;
-  ASSERT_TRUE(
-      representation.AddLiveOnlyInfo(media_info_, segment_infos, kStartNumber));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber, nullptr));
 
   EXPECT_THAT(representation.GetRawPtr(),
               XmlNodeEqual(
@@ -507,8 +507,8 @@ TEST_F(LiveSegmentTimelineTest, TwoSegmentInfoWithGap) {
       {kStartTime2, kDuration2, kRepeat2},
   };
   RepresentationXmlNode representation;
-  ASSERT_TRUE(
-      representation.AddLiveOnlyInfo(media_info_, segment_infos, kStartNumber));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber, nullptr));
 
   EXPECT_THAT(representation.GetRawPtr(),
               XmlNodeEqual(
@@ -534,8 +534,8 @@ TEST_F(LiveSegmentTimelineTest, LastSegmentNumberSupplementalProperty) {
   RepresentationXmlNode representation;                                         
   FLAGS_dash_add_last_segment_number_when_needed = true;                       
                                                                                 
-  ASSERT_TRUE(                                                                  
-      representation.AddLiveOnlyInfo(media_info_, segment_infos, kStartNumber));
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber, nullptr));
                                                                                 
   EXPECT_THAT(                                                                  
       representation.GetRawPtr(),                                               
@@ -548,5 +548,64 @@ TEST_F(LiveSegmentTimelineTest, LastSegmentNumberSupplementalProperty) {
   FLAGS_dash_add_last_segment_number_when_needed = false;                                                                                                      
 }                      
 
+TEST_F(LiveSegmentTimelineTest, SegmentTimelineCache) {
+  const uint32_t kStartNumber = 1;
+  std::list<SegmentInfo> segment_infos = {
+      {0, 100, 9},
+      {1000, 200, 1},
+  };
+  SegmentTimelineCache segment_timeline_cache;
+  RepresentationXmlNode representation;
+  ASSERT_TRUE(representation.AddLiveOnlyInfo(media_info_, segment_infos,
+                                             kStartNumber,
+                                             &segment_timeline_cache));
+
+  EXPECT_THAT(representation.GetRawPtr(),
+              XmlNodeEqual(
+                  "<Representation>"
+                  "  <SegmentTemplate media=\"$Number$.m4s\" startNumber=\"1\">"
+                  "    <SegmentTimeline>"
+                  "      <S t=\"0\" d=\"100\" r=\"9\"/>"
+                  "      <S t=\"1000\" d=\"200\" r=\"1\"/>"
+                  "    </SegmentTimeline>"
+                  "  </SegmentTemplate>"
+                  "</Representation>"));
+}
+
+TEST(SegmentTimelineCacheTest, Update) {
+  SegmentTimelineCache segment_timeline_cache;
+  std::list<SegmentInfo> segment_infos = {{0, 100, 0}};
+  EXPECT_EQ("<S t=\"0\" d=\"100\"/>\n",
+            segment_timeline_cache.Update(segment_infos));
+
+  // Segments added at the end.
+  segment_infos.back().repeat = 1;
+  segment_infos.push_back({200, 50, 0});
+  segment_infos.push_back({250, 100, 0});
+  EXPECT_EQ(
+      "<S t=\"0\" d=\"100\" r=\"1\"/>\n"
+      "<S t=\"200\" d=\"50\"/>\n"
+      "<S t=\"250\" d=\"100\"/>\n",
+      segment_timeline_cache.Update(segment_infos));
+
+  // Segments removed at the start.
+  segment_infos.front() = {100, 100, 0};
+  segment_infos.back().repeat = 2;
+  EXPECT_EQ(
+      "<S t=\"100\" d=\"100\"/>\n"
+      "<S t=\"200\" d=\"50\"/>\n"
+      "<S t=\"250\" d=\"100\" r=\"2\"/>\n",
+      segment_timeline_cache.Update(segment_infos));
+
+  segment_infos.pop_front();
+  EXPECT_EQ(
+      "<S t=\"200\" d=\"50\"/>\n"
+      "<S t=\"250\" d=\"100\" r=\"2\"/>\n",
+      segment_timeline_cache.Update(segment_infos));
+
+  segment_infos.clear();
+  EXPECT_EQ("", segment_timeline_cache.Update(segment_infos));
+}
+
 }  // namespace xml
 }  // namespace shaka
@@ -0,0 +1,242 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/mpd/base/xml/xml_serializer.h"
+
+#include <libxml/parserInternals.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "packager/base/logging.h"
+
+namespace shaka {
+namespace xml {
+
+namespace {
+
+// libxml2 indents with two spaces per level, up to 30 levels.
+const int kIndentSize = 2;
+const int kMaxIndentLevel = 30;
+
+void AppendIndent(int level, std::string* output) {
+  output->append(kIndentSize * std::min(level, kMaxIndentLevel), ' ');
+}
+
+void AppendString(const xmlChar* str, std::string* output) {
+  if (str)
+    output->append(reinterpret_cast<const char*>(str));
+}
+
+// Escapes the same characters as libxml2 does in attribute values.
+void AppendEscapedAttributeValue(const xmlChar* value, std::string* output) {
+  for (const xmlChar* cur = value; cur && *cur; ++cur) {
+    switch (*cur) {
+      case '\n':
+        output->append("&#10;");
+        break;
+      case '\r':
+        output->append("&#13;");
+        break;
+      case '\t':
+        output->append("&#9;");
+        break;
+      case '"':
+        output->append("&quot;");
+        break;
+      case '<':
+        output->append("&lt;");
+        break;
+      case '>':
+        output->append("&gt;");
+        break;
+      case '&':
+        output->append("&amp;");
+        break;
+      default:
+        output->push_back(static_cast<char>(*cur));
+        break;
+    }
+  }
+}
+
+// Escapes the same characters as libxml2 does in text content.
+void AppendEscapedText(const xmlChar* text, std::string* output) {
+  for (const xmlChar* cur = text; cur && *cur; ++cur) {
+    switch (*cur) {
+      case '<':
+        output->append("&lt;");
+        break;
+      case '>':
+        output->append("&gt;");
+        break;
+      case '&':
+        output->append("&amp;");
+        break;
+      case '\r':
+        output->append("&#13;");
+        break;
+      default:
+        output->push_back(static_cast<char>(*cur));
+        break;
+    }
+  }
+}
+
+void AppendAttributes(const xmlAttr* attribute, std::string* output) {
+  for (; attribute; attribute = attribute->next) {
+    output->push_back(' ');
+    AppendString(attribute->name, output);
+    output->append("=\"");
+    for (const xmlNode* child = attribute->children; child;
+         child = child->next) {
+      if (child->type == XML_TEXT_NODE) {
+        AppendEscapedAttributeValue(child->content, output);
+      } else if (child->type == XML_ENTITY_REF_NODE) {
+        output->push_back('&');
+        AppendString(child->name, output);
+        output->push_back(';');
+      }
+    }
+    output->push_back('"');
+  }
+}
+
+bool IsSerializedChildren(const xmlNode* node) {
+  return node->type == XML_TEXT_NODE && node->name == xmlStringTextNoenc;
+}
+
+// Like libxml2, elements with text children are not formatted.
+bool HasTextChildren(const xmlNode* node) {
+  for (const xmlNode* child = node->children; child; child = child->next) {
+    if (child->type == XML_TEXT_NODE ||
+        child->type == XML_CDATA_SECTION_NODE ||
+        child->type == XML_ENTITY_REF_NODE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void AppendSerializedChildren(const xmlChar* serialized_children,
+                              int level,
+                              std::string* output) {
+  const char* line = reinterpret_cast<const char*>(serialized_children);
+  while (*line) {
+    const char* line_end = strchr(line, '\n');
+    const size_t line_size = line_end ? line_end - line : strlen(line);
+    AppendIndent(level, output);
+    output->append(line, line_size);
+    output->push_back('\n');
+    line += line_end ? line_size + 1 : line_size;
+  }
+}
+
+void AppendNode(const xmlNode* node,
+                int level,
+                bool format,
+                std::string* output);
+
+void AppendElement(const xmlNode* element,
+                   int level,
+                   bool format,
+                   std::string* output) {
+  output->push_back('<');
+  AppendString(element->name, output);
+  AppendAttributes(element->properties, output);
+  if (!element->children) {
+    output->append("/>");
+    return;
+  }
+  output->push_back('>');
+
+  if (format && element->children == element->last &&
+      IsSerializedChildren(element->children)) {
+    output->push_back('\n');
+    AppendSerializedChildren(element->children->content, level + 1, output);
+    AppendIndent(level, output);
+  } else {
+    const bool format_children = format && !HasTextChildren(element);
+    if (format_children)
+      output->push_back('\n');
+    for (const xmlNode* child = element->children; child;
+         child = child->next) {
+      if (format_children && (child->type == XML_ELEMENT_NODE ||
+                              child->type == XML_COMMENT_NODE)) {
+        AppendIndent(level + 1, output);
+      }
+      AppendNode(child, level + 1, format_children, output);
+      if (format_children)
+        output->push_back('\n');
+    }
+    if (format_children)
+      AppendIndent(level, output);
+  }
+
+  output->append("</");
+  AppendString(element->name, output);
+  output->push_back('>');
+}
+
+void AppendNode(const xmlNode* node,
+                int level,
+                bool format,
+                std::string* output) {
+  switch (node->type) {
+    case XML_ELEMENT_NODE:
+      AppendElement(node, level, format, output);
+      break;
+    case XML_TEXT_NODE:
+      if (node->name == xmlStringTextNoenc)
+        AppendString(node->content, output);
+      else
+        AppendEscapedText(node->content, output);
+      break;
+    case XML_COMMENT_NODE:
+      if (node->content) {
+        output->append("<!--");
+        AppendString(node->content, output);
+        output->append("-->");
+      }
+      break;
+    case XML_ENTITY_REF_NODE:
+      output->push_back('&');
+      AppendString(node->name, output);
+      output->push_back(';');
+      break;
+    default:
+      NOTIMPLEMENTED() << "Unsupported XML node type " << node->type;
+      break;
+  }
+}
+
+}  // namespace
+
+void SerializeDocument(xmlDocPtr doc, std::string* output) {
+  DCHECK(doc);
+  DCHECK(output);
+  output->assign("<?xml version=\"");
+  if (doc->version)
+    AppendString(doc->version, output);
+  else
+    output->append("1.0");
+  output->append("\" encoding=\"UTF-8\"?>\n");
+  for (const xmlNode* child = doc->children; child; child = child->next) {
+    AppendNode(child, 0, true, output);
+    output->push_back('\n');
+  }
+}
+
+void SerializeNode(xmlNodePtr node, std::string* output) {
+  DCHECK(node);
+  DCHECK(output);
+  output->clear();
+  AppendNode(node, 0, true, output);
+  output->push_back('\n');
+}
+
+}  // namespace xml
+}  // namespace shaka
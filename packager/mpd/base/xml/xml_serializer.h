@@ -0,0 +1,37 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// Serializes XML trees directly into strings. The output is the same as
+// formatted output of libxml2 with UTF-8 encoding, i.e.
+// xmlDocDumpFormatMemoryEnc(doc, ..., "UTF-8", 1), without going through
+// libxml2 output buffers and encoders. Serialized children added with
+// XmlNode::AddSerializedChildren() are output as formatted child elements.
+
+#ifndef MPD_BASE_XML_XML_SERIALIZER_H_
+#define MPD_BASE_XML_XML_SERIALIZER_H_
+
+#include <libxml/tree.h>
+
+#include <string>
+
+namespace shaka {
+namespace xml {
+
+/// Serialize a document, including the XML declaration.
+/// @param doc is the document to serialize.
+/// @param output is the serialized document. It is overwritten.
+void SerializeDocument(xmlDocPtr doc, std::string* output);
+
+/// Serialize a node and its descendants as the root element of a document,
+/// without the XML declaration.
+/// @param node is the node to serialize.
+/// @param output is the serialized node. It is overwritten.
+void SerializeNode(xmlNodePtr node, std::string* output);
+
+}  // namespace xml
+}  // namespace shaka
+
+#endif  // MPD_BASE_XML_XML_SERIALIZER_H_
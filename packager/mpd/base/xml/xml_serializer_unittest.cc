@@ -0,0 +1,213 @@
+// Copyright 2018 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "packager/mpd/base/xml/xml_serializer.h"
+
+#include <gtest/gtest.h>
+
+#include "packager/mpd/base/xml/xml_node.h"
+
+namespace shaka {
+namespace xml {
+
+namespace {
+
+std::string DumpWithLibXml(xmlDocPtr doc) {
+  static const int kNiceFormat = 1;
+  int doc_str_size = 0;
+  xmlChar* doc_str = nullptr;
+  xmlDocDumpFormatMemoryEnc(doc, &doc_str, &doc_str_size, "UTF-8",
+                            kNiceFormat);
+  std::string output(doc_str, doc_str + doc_str_size);
+  xmlFree(doc_str);
+  return output;
+}
+
+// Like xmlDocDumpFormatMemoryEnc(), SerializeNode() ends the output with a new
+// line, which xmlNodeDump() does not.
+std::string DumpNodeWithLibXml(xmlNodePtr node) {
+  static const int kNiceFormat = 1;
+  xmlBufferPtr buffer = xmlBufferCreate();
+  xmlNodeDump(buffer, node->doc, node, 0, kNiceFormat);
+  std::string output(reinterpret_cast<const char*>(xmlBufferContent(buffer)),
+                     xmlBufferLength(buffer));
+  xmlBufferFree(buffer);
+  return output + "\n";
+}
+
+std::string Serialize(xmlNodePtr node) {
+  std::string output;
+  SerializeNode(node, &output);
+  return output;
+}
+
+scoped_xml_ptr<xmlDoc> CreateDocument(XmlNode* root) {
+  scoped_xml_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST "1.0"));
+  scoped_xml_ptr<xmlNode> comment(
+      xmlNewDocComment(doc.get(), BAD_CAST "Generated with a test"));
+  xmlDocSetRootElement(doc.get(), comment.get());
+  xmlAddSibling(comment.release(), root->Release());
+  return doc;
+}
+
+}  // namespace
+
+TEST(XmlSerializerTest, SameAsLibXml) {
+  XmlNode mpd("MPD");
+  mpd.SetStringAttribute("xmlns", "urn:mpeg:dash:schema:mpd:2011");
+  mpd.SetStringAttribute("escaped", "<\"a\" & 'b'>\t\r\n");
+  mpd.SetStringAttribute("utf8", "\xE4\xBD\xA0\xE5\xA5\xBD");
+
+  XmlNode base_url("BaseURL");
+  base_url.SetContent("http://example.com/a?b=1&amp;c=<2>\r\n\xC3\xA9");
+  ASSERT_TRUE(mpd.AddChild(base_url.PassScopedPtr()));
+
+  XmlNode period("Period");
+  period.SetId(0);
+  XmlNode adaptation_set("AdaptationSet");
+  XmlNode empty_element("Role");
+  empty_element.SetContent("");
+  ASSERT_TRUE(adaptation_set.AddChild(empty_element.PassScopedPtr()));
+  XmlNode representation("Representation");
+  representation.SetIntegerAttribute("bandwidth", 123456);
+  representation.SetFloatingPointAttribute("frameRate", 29.97);
+  ASSERT_TRUE(adaptation_set.AddChild(representation.PassScopedPtr()));
+  ASSERT_TRUE(period.AddChild(adaptation_set.PassScopedPtr()));
+  ASSERT_TRUE(mpd.AddChild(period.PassScopedPtr()));
+
+  // Mixed content is not formatted.
+  XmlNode content_protection("ContentProtection");
+  ASSERT_TRUE(content_protection.AddChild(
+      scoped_xml_ptr<xmlNode>(xmlNewText(BAD_CAST "text"))));
+  XmlNode pssh("cenc:pssh");
+  XmlNode nested("Nested");
+  ASSERT_TRUE(pssh.AddChild(nested.PassScopedPtr()));
+  ASSERT_TRUE(content_protection.AddChild(pssh.PassScopedPtr()));
+  ASSERT_TRUE(mpd.AddChild(content_protection.PassScopedPtr()));
+
+  scoped_xml_ptr<xmlDoc> doc = CreateDocument(&mpd);
+  std::string output;
+  SerializeDocument(doc.get(), &output);
+  EXPECT_EQ(DumpWithLibXml(doc.get()), output);
+}
+
+TEST(XmlSerializerTest, SerializedChildren) {
+  XmlNode period("Period");
+  XmlNode segment_timeline("SegmentTimeline");
+  segment_timeline.AddSerializedChildren("<S t=\"0\" d=\"10\"/>\n"
+                                         "<S t=\"10\" d=\"20\" r=\"2\"/>\n");
+  ASSERT_TRUE(period.AddChild(segment_timeline.PassScopedPtr()));
+  scoped_xml_ptr<xmlDoc> doc = CreateDocument(&period);
+  std::string output;
+  SerializeDocument(doc.get(), &output);
+
+  XmlNode expected_period("Period");
+  XmlNode expected_segment_timeline("SegmentTimeline");
+  XmlNode s_element1("S");
+  s_element1.SetIntegerAttribute("t", 0);
+  s_element1.SetIntegerAttribute("d", 10);
+  ASSERT_TRUE(expected_segment_timeline.AddChild(s_element1.PassScopedPtr()));
+  XmlNode s_element2("S");
+  s_element2.SetIntegerAttribute("t", 10);
+  s_element2.SetIntegerAttribute("d", 20);
+  s_element2.SetIntegerAttribute("r", 2);
+  ASSERT_TRUE(expected_segment_timeline.AddChild(s_element2.PassScopedPtr()));
+  ASSERT_TRUE(
+      expected_period.AddChild(expected_segment_timeline.PassScopedPtr()));
+  scoped_xml_ptr<xmlDoc> expected_doc = CreateDocument(&expected_period);
+  EXPECT_EQ(DumpWithLibXml(expected_doc.get()), output);
+}
+
+TEST(XmlSerializerTest, SerializeNodeSameAsLibXml) {
+  XmlNode representation("Representation");
+  representation.SetStringAttribute("id", "<\"1\" & '2'>\t\r\n");
+  representation.SetIntegerAttribute("bandwidth", 123456);
+
+  XmlNode base_url("BaseURL");
+  base_url.SetContent("http://example.com/a?b=1&amp;c=<2>\r\n");
+  ASSERT_TRUE(representation.AddChild(base_url.PassScopedPtr()));
+  XmlNode empty_element("Role");
+  ASSERT_TRUE(representation.AddChild(empty_element.PassScopedPtr()));
+  ASSERT_TRUE(representation.AddChild(
+      scoped_xml_ptr<xmlNode>(xmlNewComment(BAD_CAST "comment"))));
+
+  XmlNode segment_template("SegmentTemplate");
+  segment_template.SetStringAttribute("media", "$Number$.m4s");
+  XmlNode segment_timeline("SegmentTimeline");
+  XmlNode s_element("S");
+  s_element.SetIntegerAttribute("t", 0);
+  ASSERT_TRUE(segment_timeline.AddChild(s_element.PassScopedPtr()));
+  ASSERT_TRUE(segment_template.AddChild(segment_timeline.PassScopedPtr()));
+  ASSERT_TRUE(representation.AddChild(segment_template.PassScopedPtr()));
+
+  // Mixed content is not formatted.
+  XmlNode content_protection("ContentProtection");
+  ASSERT_TRUE(content_protection.AddChild(
+      scoped_xml_ptr<xmlNode>(xmlNewText(BAD_CAST "text"))));
+  XmlNode nested("Nested");
+  ASSERT_TRUE(content_protection.AddChild(nested.PassScopedPtr()));
+  ASSERT_TRUE(representation.AddChild(content_protection.PassScopedPtr()));
+
+  EXPECT_EQ(DumpNodeWithLibXml(representation.GetRawPtr()),
+            Serialize(representation.GetRawPtr()));
+  // Nodes which are not the root element are serialized the same way, without
+  // the indentation of their level.
+  for (xmlNodePtr child = xmlFirstElementChild(representation.GetRawPtr());
+       child; child = xmlNextElementSibling(child)) {
+    EXPECT_EQ(DumpNodeWithLibXml(child), Serialize(child));
+  }
+}
+
+TEST(XmlSerializerTest, SerializedChildrenSameAsLibXmlElements) {
+  XmlNode representation("Representation");
+  XmlNode segment_template("SegmentTemplate");
+  XmlNode segment_timeline("SegmentTimeline");
+  segment_timeline.AddSerializedChildren("<S t=\"0\" d=\"10\"/>\n"
+                                         "<S t=\"10\" d=\"20\" r=\"2\"/>\n");
+  ASSERT_TRUE(segment_template.AddChild(segment_timeline.PassScopedPtr()));
+  ASSERT_TRUE(representation.AddChild(segment_template.PassScopedPtr()));
+
+  XmlNode expected_representation("Representation");
+  XmlNode expected_segment_template("SegmentTemplate");
+  XmlNode expected_segment_timeline("SegmentTimeline");
+  XmlNode s_element1("S");
+  s_element1.SetIntegerAttribute("t", 0);
+  s_element1.SetIntegerAttribute("d", 10);
+  ASSERT_TRUE(expected_segment_timeline.AddChild(s_element1.PassScopedPtr()));
+  XmlNode s_element2("S");
+  s_element2.SetIntegerAttribute("t", 10);
+  s_element2.SetIntegerAttribute("d", 20);
+  s_element2.SetIntegerAttribute("r", 2);
+  ASSERT_TRUE(expected_segment_timeline.AddChild(s_element2.PassScopedPtr()));
+  ASSERT_TRUE(expected_segment_template.AddChild(
+      expected_segment_timeline.PassScopedPtr()));
+  ASSERT_TRUE(expected_representation.AddChild(
+      expected_segment_template.PassScopedPtr()));
+
+  EXPECT_EQ(DumpNodeWithLibXml(expected_representation.GetRawPtr()),
+            Serialize(representation.GetRawPtr()));
+}
+
+TEST(XmlSerializerTest, SerializeNode) {
+  XmlNode segment_template("SegmentTemplate");
+  segment_template.SetStringAttribute("media", "$Number$.m4s");
+  XmlNode segment_timeline("SegmentTimeline");
+  segment_timeline.AddSerializedChildren("<S t=\"0\" d=\"10\"/>\n");
+  ASSERT_TRUE(segment_template.AddChild(segment_timeline.PassScopedPtr()));
+
+  std::string output;
+  SerializeNode(segment_template.GetRawPtr(), &output);
+  EXPECT_EQ(
+      "<SegmentTemplate media=\"$Number$.m4s\">\n"
+      "  <SegmentTimeline>\n"
+      "    <S t=\"0\" d=\"10\"/>\n"
+      "  </SegmentTimeline>\n"
+      "</SegmentTemplate>\n",
+      output);
+}
+
+}  // namespace xml
+}  // namespace shaka
@@ -31,9 +31,12 @@
       'sources': [
         'base/bandwidth_estimator.cc',
         'base/bandwidth_estimator.h',
+        'base/manifest_writer.cc',
+        'base/manifest_writer.h',
       ],
       'dependencies': [
         '../base/base.gyp:base',
+        '../third_party/gflags/gflags.gyp:gflags',
       ],
     },
     {
@@ -62,6 +65,8 @@
         'base/xml/scoped_xml_ptr.h',
         'base/xml/xml_node.cc',
         'base/xml/xml_node.h',
+        'base/xml/xml_serializer.cc',
+        'base/xml/xml_serializer.h',
         'public/mpd_params.h',
       ],
       'dependencies': [
@@ -99,12 +104,14 @@
       'sources': [
         'base/adaptation_set_unittest.cc',
         'base/bandwidth_estimator_unittest.cc',
+        'base/manifest_writer_unittest.cc',
         'base/mpd_builder_unittest.cc',
         'base/mpd_utils_unittest.cc',
         'base/period_unittest.cc',
         'base/representation_unittest.cc',
         'base/simple_mpd_notifier_unittest.cc',
         'base/xml/xml_node_unittest.cc',
+        'base/xml/xml_serializer_unittest.cc',
         'test/mpd_builder_test_helper.cc',
         'test/mpd_builder_test_helper.h',
         'test/xml_compare.cc',
@@ -1,6 +1,7 @@
 #include "packager/mpd/test/xml_compare.h"
 
 #include <libxml/parser.h>
+#include <libxml/parserInternals.h>
 #include <libxml/tree.h>
 
 #include <algorithm>
@@ -19,6 +20,41 @@ xml::scoped_xml_ptr<xmlDoc> GetDocFromString(const std::string& xml_str) {
       xmlReadMemory(xml_str.data(), xml_str.size(), NULL, NULL, 0));
 }
 
+// Parse the serialized children added with XmlNode::AddSerializedChildren(),
+// i.e. the text nodes which are not escaped on output, into elements.
+void ExpandSerializedChildren(xmlNodePtr node) {
+  xmlNodePtr child = node->children;
+  while (child) {
+    xmlNodePtr next = child->next;
+    if (child->type == XML_TEXT_NODE && child->name == xmlStringTextNoenc) {
+      const std::string serialized_children =
+          reinterpret_cast<const char*>(child->content);
+      xml::scoped_xml_ptr<xmlDoc> children_doc(
+          GetDocFromString("<root>" + serialized_children + "</root>"));
+      CHECK(children_doc) << "Invalid serialized children.";
+      for (xmlNodePtr element =
+               xmlFirstElementChild(xmlDocGetRootElement(children_doc.get()));
+           element; element = xmlNextElementSibling(element)) {
+        xmlAddPrevSibling(child, xmlDocCopyNode(element, node->doc, 1));
+      }
+      xmlUnlinkNode(child);
+      xmlFreeNode(child);
+    } else if (child->type == XML_ELEMENT_NODE) {
+      ExpandSerializedChildren(child);
+    }
+    child = next;
+  }
+}
+
+// Create an xmlDoc from xmlNodePtr, with the serialized children expanded. The
+// node is copied so ownership does not transfer.
+xml::scoped_xml_ptr<xmlDoc> GetDocFromNode(xmlNodePtr xml_node) {
+  xml::scoped_xml_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST ""));
+  xmlDocSetRootElement(doc.get(), xmlCopyNode(xml_node, true));
+  ExpandSerializedChildren(xmlDocGetRootElement(doc.get()));
+  return doc;
+}
+
 // Make a map from attributes of the node.
 std::map<std::string, std::string> GetMapOfAttributes(xmlNodePtr node) {
   DVLOG(2) << "Getting attributes for node "
@@ -175,14 +211,12 @@ bool XmlEqual(const std::string& xml1, xmlNodePtr xml2) {
   xmlNodePtr xml1_root_element = xmlDocGetRootElement(xml1_doc.get());
   if (!xml1_root_element)
     return false;
-  return CompareNodes(xml1_root_element, xml2);
+  xml::scoped_xml_ptr<xmlDoc> xml2_doc(GetDocFromNode(xml2));
+  return CompareNodes(xml1_root_element, xmlDocGetRootElement(xml2_doc.get()));
 }
 
 std::string XmlNodeToString(xmlNodePtr xml_node) {
-  // Create an xmlDoc from xmlNodePtr. The node is copied so ownership does not
-  // transfer.
-  xml::scoped_xml_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST ""));
-  xmlDocSetRootElement(doc.get(), xmlCopyNode(xml_node, true));
+  xml::scoped_xml_ptr<xmlDoc> doc(GetDocFromNode(xml_node));
 
   // Format the xmlDoc to string.
   static const int kNiceFormat = 1;
@@ -13,6 +13,7 @@
 #include "packager/app/muxer_factory.h"
 #include "packager/app/packager_util.h"
 #include "packager/app/stream_descriptor.h"
+#include "packager/app/vod_range_planner.h"
 #include "packager/base/at_exit.h"
 #include "packager/base/files/file_path.h"
 #include "packager/base/logging.h"
@@ -20,11 +21,15 @@
 #include "packager/base/path_service.h"
 #include "packager/base/strings/string_util.h"
 #include "packager/base/strings/stringprintf.h"
+#include "packager/base/sys_info.h"
 #include "packager/base/threading/simple_thread.h"
 #include "packager/base/time/clock.h"
 #include "packager/file/file.h"
+#include "packager/file/io_service.h"
 #include "packager/hls/base/hls_notifier.h"
 #include "packager/hls/base/simple_hls_notifier.h"
+#include "packager/media/base/aes_cryptor.h"
+#include "packager/media/base/async_boundary.h"
 #include "packager/media/base/container_names.h"
 #include "packager/media/base/fourccs.h"
 #include "packager/media/base/key_source.h"
@@ -32,6 +37,7 @@
 #include "packager/media/base/muxer.h"
 #include "packager/media/base/muxer_options.h"
 #include "packager/media/base/muxer_util.h"
+#include "packager/media/base/range_merger.h"
 #include "packager/media/chunking/chunking_handler.h"
 #include "packager/media/chunking/cue_alignment_handler.h"
 #include "packager/media/chunking/text_chunker.h"
@@ -436,7 +442,23 @@ Status CreateDemuxer(const StreamDescriptor& stream,
   return Status::OK;
 }
 
-std::shared_ptr<MediaHandler> CreateEncryptionHandler(
+FourCC GetProtectionScheme(const PackagingParams& packaging_params,
+                           const StreamDescriptor& stream) {
+  // Use Sample AES in MPEG2TS.
+  // TODO(kqyang): Consider adding a new flag to enable Sample AES as we
+  // will support CENC in TS in the future.
+  if (GetOutputFormat(stream) == CONTAINER_MPEG2TS ||
+      GetOutputFormat(stream) == CONTAINER_AAC ||
+      GetOutputFormat(stream) == CONTAINER_AC3 ||
+      GetOutputFormat(stream) == CONTAINER_EAC3) {
+    VLOG(1) << "Use Apple Sample AES encryption for MPEG2TS or Packed Audio.";
+    return kAppleSampleAesProtectionScheme;
+  }
+  return static_cast<FourCC>(
+      packaging_params.encryption_params.protection_scheme);
+}
+
+std::shared_ptr<EncryptionHandler> CreateEncryptionHandler(
     const PackagingParams& packaging_params,
     const StreamDescriptor& stream,
     KeySource* key_source) {
@@ -450,17 +472,8 @@ std::shared_ptr<MediaHandler> CreateEncryptionHandler(
 
   // Make a copy so that we can modify it for this specific stream.
   EncryptionParams encryption_params = packaging_params.encryption_params;
-
-  // Use Sample AES in MPEG2TS.
-  // TODO(kqyang): Consider adding a new flag to enable Sample AES as we
-  // will support CENC in TS in the future.
-  if (GetOutputFormat(stream) == CONTAINER_MPEG2TS ||
-      GetOutputFormat(stream) == CONTAINER_AAC ||
-      GetOutputFormat(stream) == CONTAINER_AC3 ||
-      GetOutputFormat(stream) == CONTAINER_EAC3) {
-    VLOG(1) << "Use Apple Sample AES encryption for MPEG2TS or Packed Audio.";
-    encryption_params.protection_scheme = kAppleSampleAesProtectionScheme;
-  }
+  encryption_params.protection_scheme =
+      GetProtectionScheme(packaging_params, stream);
 
   if (!stream.drm_label.empty()) {
     const std::string& drm_label = stream.drm_label;
@@ -667,6 +680,127 @@ Status CreateTextJobs(
   return Status::OK;
 }
 
+// Returns true if the per-sample ivs of |stream| can be advanced to the start
+// of a range without encrypting the preceding samples, see
+// EncryptionHandler::set_range_start().
+bool CanEncryptInRanges(const PackagingParams& packaging_params,
+                        const StreamDescriptor& stream) {
+  const EncryptionParams& encryption_params =
+      packaging_params.encryption_params;
+  if (encryption_params.crypto_period_duration_in_seconds !=
+      EncryptionParams::kNoKeyRotation) {
+    return false;
+  }
+  const FourCC protection_scheme =
+      GetProtectionScheme(packaging_params, stream);
+  if (protection_scheme == FOURCC_cbc1)
+    return false;
+  // The other schemes use constant ivs.
+  if (protection_scheme != FOURCC_cenc && protection_scheme != FOURCC_cens)
+    return true;
+  // Random 'cenc' and 'cens' ivs are 8-byte, but the size of the ivs coming
+  // with the keys is only known beforehand for raw keys.
+  if (encryption_params.key_provider != KeyProvider::kRawKey)
+    return false;
+  auto is_8_byte_or_random_iv = [](const std::vector<uint8_t>& iv) {
+    return iv.empty() || iv.size() == 8;
+  };
+  if (!is_8_byte_or_random_iv(encryption_params.raw_key.iv))
+    return false;
+  for (const auto& pair : encryption_params.raw_key.key_map) {
+    if (!is_8_byte_or_random_iv(pair.second.iv))
+      return false;
+  }
+  return true;
+}
+
+// Plans the ranges of the streams of |input| if it is to be packaged in
+// parallel ranges, see PackagingParams::vod_range_duration_in_seconds.
+// Returns false if |input| is to be packaged serially.
+bool PlanInputRanges(
+    const std::string& input,
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>& streams,
+    const PackagingParams& packaging_params,
+    KeySource* encryption_key_source,
+    SyncPointQueue* sync_points,
+    std::map<std::string, StreamRanges>* stream_ranges) {
+  if (packaging_params.vod_range_duration_in_seconds <= 0)
+    return false;
+  if (sync_points) {
+    LOG(WARNING) << "Ranges are not supported with ad cues. Packaging "
+                 << input << " serially.";
+    return false;
+  }
+
+  std::vector<std::string> stream_selectors;
+  for (const StreamDescriptor& stream : streams) {
+    if (stream.input != input ||
+        (stream.output.empty() && stream.segment_template.empty())) {
+      continue;
+    }
+    if (encryption_key_source && !stream.skip_encryption &&
+        !CanEncryptInRanges(packaging_params, stream)) {
+      LOG(WARNING) << "Ranges are not supported with key rotation, 'cbc1' or "
+                      "16-byte 'cenc' / 'cens' ivs. Packaging "
+                   << input << " serially.";
+      return false;
+    }
+    if (std::find(stream_selectors.begin(), stream_selectors.end(),
+                  stream.stream_selector) == stream_selectors.end()) {
+      stream_selectors.push_back(stream.stream_selector);
+    }
+  }
+
+  if (!PlanVodRanges(input, stream_selectors, packaging_params.chunking_params,
+                     packaging_params.encryption_params.clear_lead_in_seconds,
+                     packaging_params.vod_range_duration_in_seconds,
+                     stream_ranges)) {
+    LOG(WARNING) << "Cannot split " << input
+                 << " into ranges. Packaging it serially.";
+    return false;
+  }
+  return true;
+}
+
+// Chunks and encrypts each range of a stream, demuxed by the demuxer of the
+// range, and merges the ranges in order into |replicator|.
+Status CreateRangeHandlers(
+    const StreamDescriptor& stream,
+    const StreamRanges& stream_ranges,
+    const std::vector<std::shared_ptr<Demuxer>>& range_demuxers,
+    const PackagingParams& packaging_params,
+    KeySource* encryption_key_source,
+    std::shared_ptr<MediaHandler> replicator) {
+  DCHECK_EQ(stream_ranges.ranges.size(), range_demuxers.size());
+
+  // The ranges are encrypted with the same random iv if the key does not come
+  // with one.
+  std::vector<uint8_t> iv;
+  if (encryption_key_source && !stream.skip_encryption &&
+      !AesCryptor::GenerateRandomIv(
+          GetProtectionScheme(packaging_params, stream), &iv)) {
+    return Status(error::ENCRYPTION_FAILURE, "Failed to generate random iv.");
+  }
+
+  auto merger = std::make_shared<RangeMerger>();
+  for (size_t i = 0; i < range_demuxers.size(); ++i) {
+    auto chunker =
+        std::make_shared<ChunkingHandler>(packaging_params.chunking_params);
+    auto encryptor = CreateEncryptionHandler(packaging_params, stream,
+                                             encryption_key_source);
+    if (encryptor) {
+      EncryptionRangeStart range_start =
+          stream_ranges.ranges[i].encryption_range_start;
+      range_start.iv = iv;
+      encryptor->set_range_start(range_start);
+    }
+    RETURN_IF_ERROR(MediaHandler::Chain({chunker, encryptor, merger}));
+    RETURN_IF_ERROR(
+        range_demuxers[i]->SetHandler(stream.stream_selector, chunker));
+  }
+  return MediaHandler::Chain({merger, std::move(replicator)});
+}
+
 Status CreateAudioVideoJobs(
     const std::vector<std::reference_wrapper<const StreamDescriptor>>& streams,
     const PackagingParams& packaging_params,
@@ -683,6 +817,10 @@ Status CreateAudioVideoJobs(
   // order.
   std::map<std::string, std::shared_ptr<Demuxer>> sources;
   std::map<std::string, std::shared_ptr<MediaHandler>> cue_aligners;
+  // The inputs packaged in parallel ranges have a demuxer per range, the first
+  // one being their source, and the ranges of their streams.
+  std::map<std::string, std::vector<std::shared_ptr<Demuxer>>> range_demuxers;
+  std::map<std::string, std::map<std::string, StreamRanges>> input_ranges;
 
   for (const StreamDescriptor& stream : streams) {
     bool seen_input_before = sources.find(stream.input) != sources.end();
@@ -695,10 +833,47 @@ Status CreateAudioVideoJobs(
     cue_aligners[stream.input] =
         sync_points ? std::make_shared<CueAlignmentHandler>(sync_points)
                     : nullptr;
+
+    std::map<std::string, StreamRanges> stream_ranges;
+    if (!PlanInputRanges(stream.input, streams, packaging_params,
+                         encryption_key_source, sync_points, &stream_ranges)) {
+      continue;
+    }
+    const size_t num_ranges = stream_ranges.begin()->second.ranges.size();
+    std::vector<std::shared_ptr<Demuxer>>& demuxers =
+        range_demuxers[stream.input];
+    demuxers.push_back(sources[stream.input]);
+    while (demuxers.size() < num_ranges) {
+      std::shared_ptr<Demuxer> demuxer;
+      RETURN_IF_ERROR(CreateDemuxer(stream, packaging_params, &demuxer));
+      // The stream info of the input is dumped once.
+      demuxer->set_dump_stream_info(false);
+      demuxers.push_back(std::move(demuxer));
+    }
+    for (const auto& pair : stream_ranges) {
+      const StreamRanges& ranges = pair.second;
+      for (size_t i = 0; i < num_ranges; ++i) {
+        demuxers[i]->SetDtsRange(ranges.track_id, ranges.ranges[i].start_dts,
+                                 ranges.ranges[i].end_dts);
+      }
+    }
+    input_ranges[stream.input] = std::move(stream_ranges);
   }
 
   for (auto& source : sources) {
-    job_manager->Add("RemuxJob", source.second);
+    auto demuxers = range_demuxers.find(source.first);
+    if (demuxers == range_demuxers.end()) {
+      job_manager->Add("RemuxJob", source.second);
+      continue;
+    }
+    // The ranges are run in order, with as many ranges in flight as there are
+    // processors, to bound the memory held by the ranges waiting for the
+    // preceding ones.
+    job_manager->AddRanges(
+        "RemuxJob",
+        std::vector<std::shared_ptr<OriginHandler>>(demuxers->second.begin(),
+                                                    demuxers->second.end()),
+        base::SysInfo::NumberOfProcessors());
   }
 
   // Replicators are shared among all streams with the same input and stream
@@ -734,20 +909,30 @@ Status CreateAudioVideoJobs(
       }
 
       replicator = std::make_shared<Replicator>();
-      auto chunker =
-          std::make_shared<ChunkingHandler>(packaging_params.chunking_params);
-      auto encryptor = CreateEncryptionHandler(packaging_params, stream,
-                                               encryption_key_source);
-
-      // TODO(vaage) : Create a nicer way to connect handlers to demuxers.
-      if (sync_points) {
-        RETURN_IF_ERROR(
-            MediaHandler::Chain({cue_aligner, chunker, encryptor, replicator}));
-        RETURN_IF_ERROR(
-            demuxer->SetHandler(stream.stream_selector, cue_aligner));
+      auto ranges = input_ranges.find(stream.input);
+      if (ranges != input_ranges.end()) {
+        RETURN_IF_ERROR(CreateRangeHandlers(
+            stream, ranges->second[stream.stream_selector],
+            range_demuxers[stream.input], packaging_params,
+            encryption_key_source, replicator));
       } else {
-        RETURN_IF_ERROR(MediaHandler::Chain({chunker, encryptor, replicator}));
-        RETURN_IF_ERROR(demuxer->SetHandler(stream.stream_selector, chunker));
+        auto chunker =
+            std::make_shared<ChunkingHandler>(packaging_params.chunking_params);
+        auto encryptor = CreateEncryptionHandler(packaging_params, stream,
+                                                 encryption_key_source);
+
+        // TODO(vaage) : Create a nicer way to connect handlers to demuxers.
+        if (sync_points) {
+          RETURN_IF_ERROR(MediaHandler::Chain(
+              {cue_aligner, chunker, encryptor, replicator}));
+          RETURN_IF_ERROR(
+              demuxer->SetHandler(stream.stream_selector, cue_aligner));
+        } else {
+          RETURN_IF_ERROR(
+              MediaHandler::Chain({chunker, encryptor, replicator}));
+          RETURN_IF_ERROR(
+              demuxer->SetHandler(stream.stream_selector, chunker));
+        }
       }
     }
 
@@ -770,7 +955,17 @@ Status CreateAudioVideoJobs(
             ? std::make_shared<TrickPlayHandler>(stream.trick_play_factor)
             : nullptr;
 
-    RETURN_IF_ERROR(MediaHandler::Chain({replicator, trick_play, muxer}));
+    // Optionally run each output of the replicator on its own thread, so the
+    // outputs sharing an input are muxed in parallel with each other and with
+    // the demuxing, chunking and encryption of the input.
+    std::shared_ptr<MediaHandler> async_boundary =
+        packaging_params.pipeline_queue_size > 0
+            ? std::make_shared<AsyncBoundary>(
+                  packaging_params.pipeline_queue_size)
+            : nullptr;
+
+    RETURN_IF_ERROR(MediaHandler::Chain(
+        {replicator, async_boundary, trick_play, muxer}));
   }
 
   return Status::OK;
@@ -859,6 +1054,10 @@ Status CreateAllJobs(const std::vector<StreamDescriptor>& stream_descriptors,
 struct Packager::PackagerInternal {
   media::FakeClock fake_clock;
   std::unique_ptr<KeySource> encryption_key_source;
+  // The asynchronous file operations of this instance, e.g. the deletion of
+  // the segments outside of the live window. Declared before the notifiers,
+  // which submit them, so that it is destroyed after them.
+  std::unique_ptr<IoOperationGroup> io_operations;
   std::unique_ptr<MpdNotifier> mpd_notifier;
   std::unique_ptr<hls::HlsNotifier> hls_notifier;
   BufferCallbackParams buffer_callback_params;
@@ -887,6 +1086,8 @@ Status Packager::Initialize(
   }
 
   std::unique_ptr<PackagerInternal> internal(new PackagerInternal);
+  internal->io_operations.reset(
+      new IoOperationGroup(IoService::GetInstance()));
 
   // Create encryption key source if needed.
   if (packaging_params.encryption_params.key_provider != KeyProvider::kNone) {
@@ -933,8 +1134,9 @@ Status Packager::Initialize(
   if (!mpd_params.mpd_output.empty()) {
     const bool on_demand_dash_profile =
         stream_descriptors.begin()->segment_template.empty();
-    const MpdOptions mpd_options =
+    MpdOptions mpd_options =
         media::GetMpdOptions(on_demand_dash_profile, mpd_params);
+    mpd_options.io_operations = internal->io_operations.get();
     internal->mpd_notifier.reset(new SimpleMpdNotifier(mpd_options));
     if (!internal->mpd_notifier->Init()) {
       LOG(ERROR) << "MpdNotifier failed to initialize.";
@@ -944,7 +1146,10 @@ Status Packager::Initialize(
   }
 
   if (!hls_params.master_playlist_output.empty()) {
-    internal->hls_notifier.reset(new hls::SimpleHlsNotifier(hls_params));
+    std::unique_ptr<hls::SimpleHlsNotifier> hls_notifier(
+        new hls::SimpleHlsNotifier(hls_params));
+    hls_notifier->set_io_operations(internal->io_operations.get());
+    internal->hls_notifier = std::move(hls_notifier);
   }
 
   std::unique_ptr<SyncPointQueue> sync_points;
@@ -952,7 +1157,8 @@ Status Packager::Initialize(
     sync_points.reset(
         new SyncPointQueue(packaging_params.ad_cue_generator_params));
   }
-  internal->job_manager.reset(new JobManager(std::move(sync_points)));
+  internal->job_manager.reset(new JobManager(
+      std::move(sync_points), packaging_params.max_parallel_jobs));
 
   std::vector<StreamDescriptor> streams_for_jobs;
 
@@ -1018,6 +1224,15 @@ Status Packager::Run() {
     if (!internal_->mpd_notifier->Flush())
       return Status(error::INVALID_ARGUMENT, "Failed to flush Mpd.");
   }
+
+  // Waits for the asynchronous file operations of this instance, e.g. the
+  // deletion of the segments outside of the live window.
+  internal_->io_operations->Flush();
+  const IoService::Stats io_stats = IoService::GetInstance()->GetStats();
+  VLOG(1) << "Asynchronous file operations of the process: "
+          << io_stats.num_submitted << " submitted, " << io_stats.num_failed
+          << " failed, latency " << io_stats.max_latency_in_seconds
+          << " seconds at most.";
   return Status::OK;
 }
 
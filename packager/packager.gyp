@@ -22,6 +22,8 @@
         'app/libcrypto_threading.h',
         'app/packager_util.cc',
         'app/packager_util.h',
+        'app/vod_range_planner.cc',
+        'app/vod_range_planner.h',
         'packager.cc',
         'packager.h',
       ],
@@ -125,6 +127,25 @@
         'tools/license_notice.gyp:license_notice',
       ],
     },
+    {
+      'target_name': 'job_manager_unittest',
+      'type': '<(gtest_target_type)',
+      'sources': [
+        # Built in rather than linked from libpackager, which does not export
+        # JobManager when it is a shared library.
+        'app/job_manager.cc',
+        'app/job_manager.h',
+        'app/job_manager_unittest.cc',
+      ],
+      'dependencies': [
+        'media/base/media_base.gyp:media_base',
+        'media/chunking/chunking.gyp:chunking',
+        'media/origin/origin.gyp:origin',
+        'testing/gmock.gyp:gmock',
+        'testing/gtest.gyp:gtest',
+        'testing/gtest.gyp:gtest_main',
+      ],
+    },
     {
       'target_name': 'packager_test',
       'type': '<(gtest_target_type)',
@@ -217,6 +238,7 @@
         'media/formats/webvtt/webvtt.gyp:webvtt_unittest',
         'media/formats/wvm/wvm.gyp:wvm_unittest',
         'media/trick_play/trick_play.gyp:trick_play_unittest',
+        'job_manager_unittest',
         'mpd/mpd.gyp:mpd_unittest',
         'packager_test',
         'status_unittest',
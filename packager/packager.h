@@ -46,6 +46,25 @@ struct PackagingParams {
   uint32_t transport_stream_timestamp_offset_ms = 0;
   /// Chunking (segmentation) related parameters.
   ChunkingParams chunking_params;
+  /// If positive, each audio or video output is muxed on its own thread, with
+  /// at most this number of stream data queued between the thread and the
+  /// demuxing, chunking and encryption of its input. 0 runs all the outputs
+  /// of an input on the same thread as the input.
+  uint32_t pipeline_queue_size = 0;
+  /// If positive, the audio and video streams of local non-fragmented MP4
+  /// inputs are split into ranges of about this duration in seconds, at
+  /// segment boundaries, which are demuxed, chunked and encrypted in parallel
+  /// and merged in order before muxing. The output is the same as without
+  /// ranges. At most as many ranges of an input as there are processors are
+  /// run at a time, and the data of those waiting for the preceding ranges to
+  /// complete is held in memory. 0 disables ranges.
+  double vod_range_duration_in_seconds = 0;
+  /// Maximum number of jobs, i.e. inputs or input ranges being packaged, to
+  /// run in parallel. The other jobs wait until a running job completes. 0
+  /// runs every job in parallel. Live inputs never complete, so this should
+  /// not be less than the number of live inputs. Ignored if ad cues are
+  /// specified, as the jobs then wait for each other to align the cue points.
+  uint32_t max_parallel_jobs = 0;
 
   /// Out of band cuepoint parameters.
   AdCueGeneratorParams ad_cue_generator_params;